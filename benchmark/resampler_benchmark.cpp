@@ -0,0 +1,87 @@
+/**
+ ******************************************************************************
+ * @file    resampler_benchmark.cpp
+ * @brief   Throughput benchmark of the polyphase resampler.
+ ******************************************************************************
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <utility>
+#include <vector>
+
+#include "resampler.h"
+
+/** @brief Seconds of input converted per run. */
+static const size_t INPUT_SECONDS = 30;
+
+/** @brief Runs per configuration. The fastest one is reported. */
+static const int NUM_RUNS = 3;
+
+/** @brief Name of a quality preset. */
+static const char* getQualityName(ResampleQuality quality) {
+  switch (quality) {
+    case ResampleQuality::Fast:
+      return "fast";
+    case ResampleQuality::Best:
+      return "best";
+    case ResampleQuality::Balanced:
+    default:
+      return "balanced";
+  }
+}
+
+/**
+ * @brief Convert one signal and report the fastest run.
+ *
+ * @param[in] inRate Sample rate of the input.
+ * @param[in] outRate Sample rate of the output.
+ * @param[in] quality Filter preset.
+ */
+static void runBenchmark(uint32_t inRate, uint32_t outRate,
+                         ResampleQuality quality) {
+  std::vector<double> in(INPUT_SECONDS * inRate);
+  for (size_t i = 0; i < in.size(); i++) {
+    in[i] = 0.5 * std::sin(0.0123 * static_cast<double>(i)) +
+            0.25 * std::sin(0.731 * static_cast<double>(i));
+  }
+
+  const Resampler resampler(inRate, outRate, quality);
+  std::vector<double> out(resampler.getOutputSize(in.size()));
+
+  double best_ms = 0.0;
+  for (int run = 0; run < NUM_RUNS; run++) {
+    auto start = std::chrono::steady_clock::now();
+    resampler.process(in.data(), 0, in.size(), 0, out.size(), out.data());
+    const double run_ms = std::chrono::duration<double, std::milli>(
+                              std::chrono::steady_clock::now() - start)
+                              .count();
+    best_ms = run == 0 ? run_ms : std::min(best_ms, run_ms);
+  }
+
+  // Output samples per second, and how much faster than real time.
+  const double rate = static_cast<double>(out.size()) / (best_ms / 1000.0);
+  std::printf("%6u -> %6u  %-8s  %4zu taps  %8.2f ms  %8.2f MS/s  %7.1fx\n",
+              inRate, outRate, getQualityName(quality),
+              resampler.getNumTaps(), best_ms, rate / 1e6,
+              INPUT_SECONDS * 1000.0 / best_ms);
+}
+
+int main() {
+  const std::pair<uint32_t, uint32_t> ratePairs[] = {
+      {44100, 48000}, {48000, 44100}, {48000, 22050}, {44100, 22050}};
+
+  std::printf("Converting %zu s of mono audio, best of %d runs.\n\n",
+              INPUT_SECONDS, NUM_RUNS);
+  for (auto [inRate, outRate] : ratePairs) {
+    for (ResampleQuality quality : {ResampleQuality::Fast,
+                                    ResampleQuality::Balanced,
+                                    ResampleQuality::Best}) {
+      runBenchmark(inRate, outRate, quality);
+    }
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,47 @@
+/**
+ ******************************************************************************
+ * @file    audioStream.cpp
+ * @brief   Audio input stream selection.
+ ******************************************************************************
+ */
+
+#include "audioStream.h"
+
+#include <cstring>
+#include <fstream>
+
+#include "logging.h"
+#include "mp3Stream.h"
+#include "wav_decoding.h"
+
+std::unique_ptr<AudioStream> openAudioStream(const std::string& filepath) {
+  std::ifstream file(filepath, std::ios::binary);
+  if (!file.is_open()) {
+    LOG_ERROR("Could not open file " << filepath.c_str());
+    return nullptr;
+  }
+
+  // RIFF, RF64 or BW64 container with a WAVE form type.
+  char header[12]{};
+  file.read(header, sizeof(header));
+  const bool isWav = file.gcount() == sizeof(header) &&
+                     (std::memcmp(header, "RIFF", 4) == 0 ||
+                      std::memcmp(header, "RF64", 4) == 0 ||
+                      std::memcmp(header, "BW64", 4) == 0) &&
+                     std::memcmp(header + 8, "WAVE", 4) == 0;
+  file.close();
+
+  if (isWav) {
+    auto stream = std::make_unique<WAVFileDecoder>();
+    if (!stream->open(filepath)) {
+      return nullptr;
+    }
+    return stream;
+  }
+
+  auto stream = std::make_unique<MP3Stream>();
+  if (!stream->open(filepath)) {
+    return nullptr;
+  }
+  return stream;
+}
@@ -0,0 +1,96 @@
+/**
+ ******************************************************************************
+ * @file    audioStream.h
+ * @brief   Audio input stream interface header.
+ ******************************************************************************
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+#include "channel.h"
+#include "threadPool.h"
+
+/**
+ * @brief Source of the input signal of the pipeline. Implemented by each input
+ * file format.
+ */
+class AudioStream {
+ public:
+  virtual ~AudioStream() = default;
+
+  /**
+   * @brief Read the next samples, down mixed to mono and normalized to
+   * [-1, 1]. Stereo samples are the average of both channels.
+   *
+   * @param[out] out Destination of the samples.
+   * @param[in] count The number of samples to read.
+   * @return size_t The number of samples written. Less than count only at the
+   * end of the stream.
+   */
+  virtual size_t readMono(double* out, size_t count) = 0;
+
+  /**
+   * @brief Read the whole track like readMono, using the thread pool. The
+   * stream must not have been read from yet.
+   *
+   * @param[out] out Destination of getNumSamples() samples.
+   * @param[in] pool Pool to work on.
+   * @return size_t The number of samples written.
+   */
+  virtual size_t readAllMonoParallel(double* out, ThreadPool& pool) = 0;
+
+  /**
+   * @brief Whether readAllMonoParallel spreads the work over the pool. When it
+   * does not, reading the whole track up front is no faster than readMono.
+   */
+  virtual bool hasParallelRead() const = 0;
+
+  /**
+   * @brief Read the next samples of both channels, normalized to [-1, 1].
+   * Mono tracks give the same samples in both. Shares the read position of
+   * readMono.
+   *
+   * @param[out] left Destination of the left channel samples.
+   * @param[out] right Destination of the right channel samples.
+   * @param[in] count The number of samples per channel to read.
+   * @return size_t The number of samples per channel written. Less than count
+   * only at the end of the stream.
+   */
+  virtual size_t readStereo(double* left, double* right, size_t count) = 0;
+
+  /**
+   * @brief Move the read position of readMono and readStereo. Reading then
+   * resumes from that sample without decoding the ones before it.
+   *
+   * @param[in] sample Index of the next sample per channel to read.
+   * @return true if the position is within the track.
+   */
+  virtual bool seek(size_t sample) = 0;
+
+  /** @brief The number of samples per channel of the track. */
+  virtual size_t getNumSamples() const = 0;
+
+  /** @brief Channel classification. */
+  virtual Channel getChannel() const = 0;
+
+  /** @brief Sample rate of the track. */
+  virtual int getSampleRate() const = 0;
+
+  /** @brief Time spent decoding so far. */
+  virtual double getDecodeMs() const = 0;
+};
+
+/**
+ * @brief Open an audio file. The format is taken from the file header rather
+ * than the extension: RIFF/WAVE files are read as WAV and anything else as
+ * MP3.
+ *
+ * @param[in] filepath Path to the audio file.
+ * @return std::unique_ptr<AudioStream> The opened stream, or nullptr if the
+ * file could not be opened.
+ */
+std::unique_ptr<AudioStream> openAudioStream(const std::string& filepath);
@@ -0,0 +1,159 @@
+/**
+ ******************************************************************************
+ * @file    mappedFile.cpp
+ * @brief   Read only memory mapped input file.
+ ******************************************************************************
+ */
+
+#include "mappedFile.h"
+
+#include <fstream>
+#include <limits>
+
+#include "logging.h"
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#elif defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile() { close(); }
+
+bool MappedFile::open(const std::string& filepath) {
+  close();
+
+#if defined(_WIN32)
+  HANDLE file = CreateFileA(filepath.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                            nullptr, OPEN_EXISTING,
+                            FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    LOG_ERROR("Could not open file " << filepath.c_str());
+    return false;
+  }
+
+  LARGE_INTEGER fileSize{};
+  if (!GetFileSizeEx(file, &fileSize) ||
+      static_cast<uint64_t>(fileSize.QuadPart) >
+          std::numeric_limits<size_t>::max()) {
+    CloseHandle(file);
+    return readFallback(filepath);
+  }
+  length = static_cast<size_t>(fileSize.QuadPart);
+
+  // Empty files cannot be mapped, but are valid.
+  if (length == 0) {
+    CloseHandle(file);
+    return true;
+  }
+
+  HANDLE mapping =
+      CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  CloseHandle(file);
+  if (mapping == nullptr) {
+    return readFallback(filepath);
+  }
+
+  ptr = static_cast<const uint8_t*>(
+      MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+  if (ptr == nullptr) {
+    CloseHandle(mapping);
+    return readFallback(filepath);
+  }
+  mappingHandle = mapping;
+  mapped = true;
+  return true;
+
+#elif defined(__unix__) || defined(__APPLE__)
+  int fd = ::open(filepath.c_str(), O_RDONLY);
+  if (fd < 0) {
+    LOG_ERROR("Could not open file " << filepath.c_str());
+    return false;
+  }
+
+  struct stat info {};
+  if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode) ||
+      static_cast<uint64_t>(info.st_size) >
+          std::numeric_limits<size_t>::max()) {
+    ::close(fd);
+    return readFallback(filepath);
+  }
+  length = static_cast<size_t>(info.st_size);
+
+  // Empty files cannot be mapped, but are valid.
+  if (length == 0) {
+    ::close(fd);
+    return true;
+  }
+
+  void* address = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (address == MAP_FAILED) {
+    length = 0;
+    return readFallback(filepath);
+  }
+
+  // Decoders walk the file front to back.
+  madvise(address, length, MADV_SEQUENTIAL);
+
+  ptr = static_cast<const uint8_t*>(address);
+  mapped = true;
+  return true;
+
+#else
+  return readFallback(filepath);
+#endif
+}
+
+void MappedFile::close() {
+  if (mapped) {
+#if defined(_WIN32)
+    UnmapViewOfFile(ptr);
+    CloseHandle(static_cast<HANDLE>(mappingHandle));
+#elif defined(__unix__) || defined(__APPLE__)
+    munmap(const_cast<uint8_t*>(ptr), length);
+#endif
+  }
+
+  ptr = nullptr;
+  length = 0;
+  mapped = false;
+  mappingHandle = nullptr;
+  std::vector<uint8_t>().swap(buffer);
+}
+
+bool MappedFile::readFallback(const std::string& filepath) {
+  std::ifstream file(filepath, std::ios::binary);
+  if (!file.is_open()) {
+    LOG_ERROR("Could not open file " << filepath.c_str());
+    return false;
+  }
+
+  // Read in blocks since the size of e.g. a pipe is not known up front.
+  const size_t blockSize = size_t{1} << 20;
+  size_t numRead = 0;
+  while (file) {
+    buffer.resize(numRead + blockSize);
+    file.read(reinterpret_cast<char*>(buffer.data() + numRead),
+              static_cast<std::streamsize>(blockSize));
+    numRead += static_cast<size_t>(file.gcount());
+  }
+
+  if (file.bad()) {
+    LOG_ERROR("Could not read file " << filepath.c_str());
+    std::vector<uint8_t>().swap(buffer);
+    return false;
+  }
+
+  buffer.resize(numRead);
+  buffer.shrink_to_fit();
+  ptr = buffer.data();
+  length = buffer.size();
+  return true;
+}
@@ -0,0 +1,77 @@
+/**
+ ******************************************************************************
+ * @file    mappedFile.h
+ * @brief   Read only memory mapped input file header.
+ ******************************************************************************
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Read only view of a whole input file.
+ *
+ * The file is memory mapped where the platform allows it, so decoders read
+ * pages straight from the page cache without copying the file. The kernel is
+ * told the file will be read sequentially so it reads ahead aggressively.
+ * Files that cannot be mapped, such as pipes, are read into memory instead.
+ * Sizes are 64 bit, so files larger than 2 GiB are supported on 64 bit
+ * builds.
+ */
+class MappedFile {
+ public:
+  /** @brief Construct a new MappedFile object. */
+  MappedFile() = default;
+
+  /** @brief Destroy the MappedFile object and unmap the file. */
+  ~MappedFile();
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  /**
+   * @brief Map a file.
+   *
+   * @param[in] filepath path to the file.
+   * @return true on success.
+   */
+  bool open(const std::string& filepath);
+
+  /** @brief Unmap the file. */
+  void close();
+
+  /** @brief First byte of the file. nullptr if nothing is open. */
+  inline const uint8_t* data() const { return ptr; }
+
+  /** @brief The number of bytes in the file. */
+  inline size_t size() const { return length; }
+
+  /** @brief True if the file is mapped rather than read into memory. */
+  inline bool isMapped() const { return mapped; }
+
+ private:
+  /**
+   * @brief Read the whole file into memory. Used where mapping is not
+   * possible.
+   */
+  bool readFallback(const std::string& filepath);
+
+  /** @brief First byte of the file. */
+  const uint8_t* ptr{nullptr};
+
+  /** @brief The number of bytes in the file. */
+  size_t length{0};
+
+  /** @brief True if ptr points at a mapping. */
+  bool mapped{false};
+
+  /** @brief Platform handle of the mapping. Unused on POSIX systems. */
+  void* mappingHandle{nullptr};
+
+  /** @brief File contents when the file could not be mapped. */
+  std::vector<uint8_t> buffer{};
+};
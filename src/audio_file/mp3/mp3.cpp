@@ -11,22 +11,27 @@
 
 #include <stdio.h>
 
-#include <algorithm>
-#include <fstream>
+#include <cstdlib>
 
 #include "logging.h"
+#include "mappedFile.h"
+#include "pcmKernels.h"
 
 MP3Data readMP3File(std::string filepath) {
-  std::vector<unsigned char> rawMp3Data = readRawMP3(filepath);
+  // Decode straight from the mapped file, without copying it first.
+  MappedFile file{};
+  if (!file.open(filepath)) {
+    return {};
+  }
 
   // Decode MP3 bnary to Pulse Code Modulation (PCM).
   // PCM allows to represent analog signals digitally.
   mp3dec_t dec;
-  mp3dec_file_info_t info;  // PCM will be stored here
+  mp3dec_file_info_t info{};  // PCM will be stored here
 
   mp3dec_init(&dec);
-  int statusCode = mp3dec_load_buf(&dec, rawMp3Data.data(), rawMp3Data.size(),
-                                   &info, nullptr, nullptr);
+  int statusCode = mp3dec_load_buf(&dec, file.data(), file.size(), &info,
+                                   nullptr, nullptr);
 
   if (statusCode != 0) {
     LOG_ERROR("Error in decoding MP3 binary data.");
@@ -47,36 +52,18 @@ MP3Data readMP3File(std::string filepath) {
     data = handleStereoChannel(info);
   }
 
+  std::free(info.buffer);
   return data;
 }
 
 std::vector<unsigned char> readRawMP3(std::string filepath) {
-  // Open the file in binary mode.
-  std::ifstream file(filepath, std::ios::binary);
-
-  if (!file) {
-    LOG_ERROR("Could not find file " << filepath.c_str());
-  } else if (!file.is_open()) {
-    LOG_ERROR("Could not open file " << filepath.c_str());
+  MappedFile file{};
+  if (!file.open(filepath)) {
+    return {};
   }
 
-  // Determine the file size.
-  file.seekg(0, file.end);
-  int fileSize = static_cast<int>(file.tellg());
-  file.seekg(0, file.beg);
-
-  // Store raw binary to a vector.
-  std::vector<char> signedRawMp3Data(fileSize);
-  std::vector<unsigned char> rawMp3Data(fileSize);
-
-  file.read(signedRawMp3Data.data(), fileSize);
-  file.close();
-
-  std::transform(signedRawMp3Data.begin(), signedRawMp3Data.end(),
-                 rawMp3Data.begin(),
-                 [](char c) { return static_cast<unsigned char>(c); });
-
-  return rawMp3Data;
+  // Sizes are 64 bit, so files over 2 GiB are read whole.
+  return std::vector<unsigned char>(file.data(), file.data() + file.size());
 }
 
 MP3Data handleMonoChannel(mp3dec_file_info_t& info) {
@@ -84,9 +71,8 @@ MP3Data handleMonoChannel(mp3dec_file_info_t& info) {
 
   // Normalize and store MP3 data into a vector.
   std::vector<double> normalizedPcm(info.samples);
-  for (size_t i = 0; i < info.samples; i++) {
-    normalizedPcm[i] = static_cast<double>(info.buffer[i]) / INT16_MAX;
-  }
+  double* out[] = {normalizedPcm.data()};
+  int16ToDouble(info.buffer, 1, info.samples, out);
 
   MP3Data data = {info.samples, Channel::Mono, info.hz, normalizedPcm, {}};
   return data;
@@ -99,13 +85,10 @@ MP3Data handleStereoChannel(mp3dec_file_info_t& info) {
   std::vector<double> normalizedLeftPcm(numSamples);
   std::vector<double> normalizedRightPcm(numSamples);
 
-  // Processing intertwining channel sample, normalizing, and store MP3 data
+  // Split the intertwined channel samples, normalize, and store MP3 data
   // into vector.
-  for (size_t i = 0; i < numSamples; i++) {
-    normalizedLeftPcm[i] = static_cast<double>(info.buffer[2 * i]) / INT16_MAX;
-    normalizedRightPcm[i] =
-        static_cast<double>(info.buffer[2 * i + 1]) / INT16_MAX;
-  }
+  double* out[] = {normalizedLeftPcm.data(), normalizedRightPcm.data()};
+  int16ToDouble(info.buffer, 2, numSamples, out);
 
   MP3Data data = {numSamples, Channel::Stereo, info.hz, normalizedLeftPcm,
                   normalizedRightPcm};
@@ -0,0 +1,339 @@
+/**
+ ******************************************************************************
+ * @file    mp3Stream.cpp
+ * @brief   Streaming MP3 decoder.
+ ******************************************************************************
+ */
+
+#include "mp3Stream.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+
+#include "logging.h"
+#include "pcmKernels.h"
+
+/** @brief Interleaved samples converted per decoder call. */
+static const size_t BLOCK_SAMPLES = 16 * MINIMP3_MAX_SAMPLES_PER_FRAME;
+
+/** @brief Smallest segment picked for parallel decoding, in frames. */
+static const size_t MIN_SEGMENT_FRAMES = 64;
+
+/** @brief Segments per thread when the segment size is picked. */
+static const size_t SEGMENTS_PER_THREAD = 4;
+
+/** @brief Most bytes a Layer III frame can take from earlier frames. */
+static const size_t MAX_RESERVOIR_BYTES = 511;
+
+/** @brief Samples per channel of a frame, from its header. */
+static size_t getFrameSamples(const uint8_t* header) {
+  const int layer = 4 - ((header[1] >> 1) & 3);
+  const bool isMpeg1 = (header[1] & 0x18) == 0x18;
+  if (layer == 1) {
+    return 384;
+  }
+  return (layer == 3 && !isMpeg1) ? 576 : 1152;
+}
+
+/**
+ * @brief Bytes of a Layer III frame after its header and side information.
+ * These hold main data, which later frames can reference through the bit
+ * reservoir.
+ */
+static size_t getMainDataBytes(const uint8_t* header, size_t frameBytes) {
+  const bool isMpeg1 = (header[1] & 0x18) == 0x18;
+  const bool isMono = (header[3] & 0xC0) == 0xC0;
+  size_t overhead = 4 + (isMpeg1 ? (isMono ? 17 : 32) : (isMono ? 9 : 17));
+
+  // CRC after the header.
+  if ((header[1] & 1) == 0) {
+    overhead += 2;
+  }
+  return frameBytes > overhead ? frameBytes - overhead : 0;
+}
+
+/** @brief minimp3 frame iteration callback collecting frame offsets. */
+static int collectFrameOffset(void* userData, const uint8_t* /*frame*/,
+                              int /*frameSize*/, int /*freeFormatBytes*/,
+                              size_t /*bufSize*/, uint64_t offset,
+                              mp3dec_frame_info_t* /*info*/) {
+  static_cast<std::vector<uint64_t>*>(userData)->push_back(offset);
+  return 0;
+}
+
+MP3Stream::~MP3Stream() { close(); }
+
+bool MP3Stream::open(const std::string& filepath) {
+  close();
+  auto start = std::chrono::steady_clock::now();
+
+  if (!file.open(filepath)) {
+    return false;
+  }
+
+  // Scans the frame headers once to build the seek index and sample count.
+  int statusCode =
+      mp3dec_ex_open_buf(&dec, file.data(), file.size(), MP3D_SEEK_TO_SAMPLE);
+  isOpen = true;
+  if (statusCode != 0 || dec.info.channels == 0) {
+    LOG_ERROR("Error in decoding MP3 binary data.");
+    close();
+    return false;
+  }
+
+  channel = static_cast<Channel>(dec.info.channels);
+  sampleRate_hz = dec.info.hz;
+  numSamples = static_cast<size_t>(dec.samples) / dec.info.channels;
+  block.resize(BLOCK_SAMPLES);
+
+  LOG_INFO("Decoded # samples: " << dec.samples);
+  LOG_INFO("Sample rate (Hz): " << sampleRate_hz);
+  LOG_INFO("Channels: " << dec.info.channels);
+
+  decode_ms = std::chrono::duration<double, std::milli>(
+                  std::chrono::steady_clock::now() - start)
+                  .count();
+  return true;
+}
+
+size_t MP3Stream::readMono(double* out, size_t count) {
+  if (!isOpen || atEnd) {
+    return 0;
+  }
+  auto start = std::chrono::steady_clock::now();
+
+  const size_t numChannels = static_cast<size_t>(channel);
+  const size_t blockFrames = block.size() / numChannels;
+  size_t written = 0;
+
+  while (written < count) {
+    const size_t wanted = std::min(count - written, blockFrames);
+    const size_t numRead =
+        mp3dec_ex_read(&dec, block.data(), wanted * numChannels) / numChannels;
+
+    int16ToMono(block.data(), numChannels, numRead, out + written);
+    written += numRead;
+    if (numRead < wanted) {
+      if (dec.last_error != 0) {
+        LOG_ERROR("Error in decoding MP3 binary data.");
+      }
+      break;
+    }
+  }
+
+  decode_ms += std::chrono::duration<double, std::milli>(
+                   std::chrono::steady_clock::now() - start)
+                   .count();
+  return written;
+}
+
+size_t MP3Stream::readStereo(double* left, double* right, size_t count) {
+  if (!isOpen || atEnd) {
+    return 0;
+  }
+  auto start = std::chrono::steady_clock::now();
+
+  const size_t numChannels = static_cast<size_t>(channel);
+  const size_t blockFrames = block.size() / numChannels;
+  size_t written = 0;
+
+  while (written < count) {
+    const size_t wanted = std::min(count - written, blockFrames);
+    const size_t numRead =
+        mp3dec_ex_read(&dec, block.data(), wanted * numChannels) / numChannels;
+
+    double* const out[] = {left + written, right + written};
+    int16ToDouble(block.data(), numChannels, numRead, out);
+    if (numChannels == 1) {
+      std::copy(left + written, left + written + numRead, right + written);
+    }
+    written += numRead;
+    if (numRead < wanted) {
+      if (dec.last_error != 0) {
+        LOG_ERROR("Error in decoding MP3 binary data.");
+      }
+      break;
+    }
+  }
+
+  decode_ms += std::chrono::duration<double, std::milli>(
+                   std::chrono::steady_clock::now() - start)
+                   .count();
+  return written;
+}
+
+size_t MP3Stream::readAllMonoParallel(double* out, ThreadPool& pool,
+                                      size_t segmentFrames) {
+  if (!isOpen || atEnd || dec.cur_sample != 0) {
+    LOG_ERROR("Parallel decoding needs a stream that has not been read.");
+    return 0;
+  }
+  if (segmentFrames == 0 && pool.getNumThreads() == 1) {
+    return readMono(out, numSamples);
+  }
+  auto start = std::chrono::steady_clock::now();
+
+  // Offsets of every frame, from the headers alone.
+  const uint8_t* data = file.data();
+  const uint64_t endOffset = dec.end_offset;
+  std::vector<uint64_t> offsets{};
+  if (endOffset > dec.start_offset) {
+    mp3dec_iterate_buf(data + dec.start_offset, endOffset - dec.start_offset,
+                       &collectFrameOffset, &offsets);
+  }
+  for (uint64_t& offset : offsets) {
+    offset += dec.start_offset;
+  }
+  const size_t numFrames = offsets.size();
+
+  if (segmentFrames == 0) {
+    const size_t numWanted = SEGMENTS_PER_THREAD * pool.getNumThreads();
+    segmentFrames = std::max(MIN_SEGMENT_FRAMES,
+                             (numFrames + numWanted - 1) / numWanted);
+  }
+  const size_t numSegments = (numFrames + segmentFrames - 1) / segmentFrames;
+
+  // Position of each frame in the serial output, counted in interleaved
+  // samples before the start delay is dropped.
+  const size_t numChannels = static_cast<size_t>(channel);
+  std::vector<uint64_t> frameStart(numFrames + 1, 0);
+  for (size_t i = 0; i < numFrames; i++) {
+    frameStart[i + 1] =
+        frameStart[i] + getFrameSamples(data + offsets[i]) * numChannels;
+  }
+
+  // The start delay must end within the first segment, and the frames must
+  // cover the whole track.
+  const uint64_t delay = static_cast<uint64_t>(dec.start_delay);
+  const uint64_t total = dec.samples;
+  if (numSegments < 2 || frameStart[segmentFrames] < delay ||
+      frameStart[numFrames] < total + delay) {
+    return readMono(out, numSamples);
+  }
+
+  const int layer = dec.info.layer;
+  const int sampleRate = dec.info.hz;
+  std::atomic<bool> failed{false};
+
+  auto decodeSegment = [&](size_t segment) {
+    const size_t first = segment * segmentFrames;
+    const size_t last = std::min(first + segmentFrames, numFrames);
+
+    // Warm up on the frames before the segment: enough main data to fill the
+    // bit reservoir of the frame before the segment, plus that frame itself
+    // so the overlap and synthesis filter state match serial decoding.
+    size_t warmUp = first;
+    if (first > 0) {
+      warmUp = first - 1;
+      size_t numBytes = 0;
+      while (layer == 3 && warmUp > 0 && numBytes < MAX_RESERVOIR_BYTES) {
+        warmUp--;
+        numBytes += getMainDataBytes(data + offsets[warmUp],
+                                     offsets[warmUp + 1] - offsets[warmUp]);
+      }
+    }
+
+    mp3dec_t decoder;
+    mp3dec_init(&decoder);
+    std::vector<mp3d_sample_t> pcm(MINIMP3_MAX_SAMPLES_PER_FRAME);
+    uint64_t toSkip = first == 0 ? delay : 0;
+
+    for (size_t i = warmUp; i < last && !failed; i++) {
+      const uint64_t offset = offsets[i];
+      const uint64_t nextOffset = i + 1 < numFrames ? offsets[i + 1] : 0;
+      mp3dec_frame_info_t info{};
+      const int numDecoded = mp3dec_decode_frame(
+          &decoder, data + offset,
+          static_cast<int>(std::min<uint64_t>(endOffset - offset, INT_MAX)),
+          pcm.data(), &info);
+
+      if (info.hz != sampleRate || info.layer != layer ||
+          (nextOffset != 0 &&
+           static_cast<uint64_t>(info.frame_bytes) != nextOffset - offset)) {
+        failed = true;
+        break;
+      }
+      if (i < first) {
+        continue;
+      }
+
+      // A frame without samples only counts towards the start delay, like in
+      // mp3dec_ex. Anywhere else serial output would shift.
+      const uint64_t frameLength = frameStart[i + 1] - frameStart[i];
+      if (numDecoded == 0 && toSkip > 0) {
+        toSkip -= std::min(frameLength, toSkip);
+        continue;
+      }
+      if (static_cast<uint64_t>(numDecoded) * numChannels != frameLength ||
+          static_cast<size_t>(info.channels) != numChannels) {
+        failed = true;
+        break;
+      }
+
+      const uint64_t skip = std::min(frameLength, toSkip);
+      toSkip -= skip;
+      const uint64_t begin = frameStart[i] + skip - delay;
+      const uint64_t end = std::min(frameStart[i + 1] - delay, total);
+      if (begin < end) {
+        int16ToMono(pcm.data() + skip, numChannels,
+                    (end - begin) / numChannels, out + begin / numChannels);
+      }
+    }
+  };
+
+  pool.parallelFor(
+      0, numSegments,
+      [&](size_t segmentStart, size_t segmentEnd) {
+        for (size_t segment = segmentStart; segment < segmentEnd; segment++) {
+          decodeSegment(segment);
+        }
+      },
+      1);
+
+  decode_ms += std::chrono::duration<double, std::milli>(
+                   std::chrono::steady_clock::now() - start)
+                   .count();
+
+  if (failed) {
+    LOG_WARNING("MP3 frames did not split cleanly. Decoding serially.");
+    return readMono(out, numSamples);
+  }
+
+  atEnd = true;
+  return numSamples;
+}
+
+bool MP3Stream::seek(size_t sample) {
+  if (!isOpen || sample > numSamples) {
+    return false;
+  }
+  auto start = std::chrono::steady_clock::now();
+
+  // Positions count the samples of every channel.
+  const size_t numChannels = static_cast<size_t>(channel);
+  const int statusCode = mp3dec_ex_seek(&dec, sample * numChannels);
+  atEnd = false;
+
+  decode_ms += std::chrono::duration<double, std::milli>(
+                   std::chrono::steady_clock::now() - start)
+                   .count();
+  if (statusCode != 0) {
+    LOG_ERROR("Could not seek to sample " << sample << " of the MP3 file.");
+    return false;
+  }
+  return true;
+}
+
+void MP3Stream::close() {
+  if (isOpen) {
+    mp3dec_ex_close(&dec);
+    isOpen = false;
+  }
+  atEnd = false;
+  file.close();
+  numSamples = 0;
+  sampleRate_hz = 0;
+}
@@ -0,0 +1,154 @@
+/**
+ ******************************************************************************
+ * @file    mp3Stream.h
+ * @brief   Streaming MP3 decoder header.
+ ******************************************************************************
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "audioStream.h"
+#include "channel.h"
+#include "mappedFile.h"
+#include "minimp3.h"
+#include "minimp3_ex.h"
+#include "threadPool.h"
+
+/**
+ * @brief Decodes an MP3 file block by block.
+ *
+ * Opening the stream maps the file and only scans the frame headers to find
+ * the track length. Frames are then decoded straight from the mapping as
+ * samples are requested, so the compressed data is never copied and the whole
+ * int16 PCM is never held in memory.
+ */
+class MP3Stream : public AudioStream {
+ public:
+  /** @brief Construct a new MP3Stream object. */
+  MP3Stream() = default;
+
+  /** @brief Destroy the MP3Stream object and close the file. */
+  ~MP3Stream() override;
+
+  // The decoder keeps a pointer into the mapping of this object.
+  MP3Stream(const MP3Stream&) = delete;
+  MP3Stream& operator=(const MP3Stream&) = delete;
+
+  /**
+   * @brief Open an MP3 file and scan it for its length.
+   *
+   * @param[in] filepath path to MP3 file.
+   * @return true if the file holds decodable audio.
+   */
+  bool open(const std::string& filepath);
+
+  /**
+   * @brief Decode the next samples, down mixed to mono and normalized to
+   * [-1, 1]. Stereo samples are the average of both channels.
+   *
+   * @param[out] out Destination of the samples.
+   * @param[in] count The number of samples to decode.
+   * @return size_t The number of samples written. Less than count only at the
+   * end of the stream.
+   */
+  size_t readMono(double* out, size_t count) override;
+
+  /**
+   * @brief Decode the whole track on the thread pool, down mixed to mono and
+   * normalized like readMono. The output is identical to readMono from the
+   * start of the track.
+   *
+   * The frame headers are scanned and the track is split into segments of
+   * whole frames. Each segment is decoded by its own decoder, which first
+   * decodes warm-up frames before the segment: enough to fill the bit
+   * reservoir plus one complete frame to settle the filter bank state. The
+   * decoder start delay only applies to the first segment. If a segment does
+   * not decode as expected the track is decoded serially instead. Does not
+   * move the read position of readMono.
+   *
+   * @param[out] out Destination of getNumSamples() samples.
+   * @param[in] pool Pool to decode on.
+   * @param[in] segmentFrames Frames per segment. 0 picks a size that gives
+   * each thread several segments.
+   * @return size_t The number of samples written.
+   */
+  size_t readAllMonoParallel(double* out, ThreadPool& pool,
+                             size_t segmentFrames);
+
+  /**
+   * @brief Decode the next samples of both channels, normalized like
+   * readMono. Mono tracks give the same samples in both.
+   *
+   * @param[out] left Destination of the left channel samples.
+   * @param[out] right Destination of the right channel samples.
+   * @param[in] count The number of samples per channel to decode.
+   * @return size_t The number of samples per channel written. Less than count
+   * only at the end of the stream.
+   */
+  size_t readStereo(double* left, double* right, size_t count) override;
+
+  /**
+   * @brief Move the read position to a sample. The seek index built while
+   * opening finds the frame holding it, and decoding starts a few frames
+   * earlier to fill the bit reservoir, so the samples match decoding from
+   * the start of the track.
+   *
+   * @param[in] sample Index of the next sample per channel to read.
+   * @return true if the position is within the track.
+   */
+  bool seek(size_t sample) override;
+
+  /** @brief readAllMonoParallel with a picked segment size. */
+  inline size_t readAllMonoParallel(double* out, ThreadPool& pool) override {
+    return readAllMonoParallel(out, pool, 0);
+  }
+
+  /** @brief Segments of frames are decoded on the pool. */
+  inline bool hasParallelRead() const override { return true; }
+
+  /** @brief The number of samples per channel of the track. */
+  inline size_t getNumSamples() const override { return numSamples; }
+
+  /** @brief Channel classification. */
+  inline Channel getChannel() const override { return channel; }
+
+  /** @brief Sample rate of the track. */
+  inline int getSampleRate() const override { return sampleRate_hz; }
+
+  /** @brief Time spent scanning and decoding so far. */
+  inline double getDecodeMs() const override { return decode_ms; }
+
+ private:
+  /** @brief Close the file and release the decoder. */
+  void close();
+
+  /** @brief Mapped input file. */
+  MappedFile file{};
+
+  /** @brief True once the decoder is open. */
+  bool isOpen{false};
+
+  /** @brief True once the whole track has been read in parallel. */
+  bool atEnd{false};
+
+  /** @brief minimp3 stream decoder. */
+  mp3dec_ex_t dec{};
+
+  /** @brief Interleaved int16 samples of the block being converted. */
+  std::vector<mp3d_sample_t> block{};
+
+  /** @brief The number of samples per channel. */
+  size_t numSamples{0};
+
+  /** @brief Channel classification. */
+  Channel channel{Channel::Mono};
+
+  /** @brief Sample rate of the track. */
+  int sampleRate_hz{0};
+
+  /** @brief Time spent scanning and decoding so far. */
+  double decode_ms{0.0};
+};
@@ -0,0 +1,93 @@
+/**
+ ******************************************************************************
+ * @file    outputWriter.cpp
+ * @brief   Asynchronous audio file writer.
+ ******************************************************************************
+ */
+
+#include "outputWriter.h"
+
+#include "logging.h"
+#include "wav_encoding.h"
+
+/** @brief Bytes of samples held by a file. */
+static size_t getSignalBytes(const OutputFile& file) {
+  size_t bytes = 0;
+  for (const std::vector<double>& channel : file.channels) {
+    bytes += channel.size() * sizeof(double);
+  }
+  return bytes;
+}
+
+OutputWriter::OutputWriter(size_t maxQueuedBytes)
+    : capacity(maxQueuedBytes), thread([this]() { run(); }) {}
+
+OutputWriter::~OutputWriter() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  changed.notify_all();
+  thread.join();
+}
+
+void OutputWriter::submit(OutputFile file) {
+  const size_t bytes = getSignalBytes(file);
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    changed.wait(lock, [&]() {
+      return capacity == 0 || queuedBytes == 0 ||
+             queuedBytes + bytes <= capacity;
+    });
+    queuedBytes += bytes;
+    queue.push_back(std::move(file));
+  }
+  changed.notify_all();
+}
+
+bool OutputWriter::wait() {
+  std::unique_lock<std::mutex> lock(mutex);
+  changed.wait(lock, [&]() { return queuedBytes == 0 && queue.empty(); });
+  return numFailed == 0;
+}
+
+void OutputWriter::run() {
+  WAVFileEncoder encoder{};
+
+  while (true) {
+    OutputFile file{};
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      changed.wait(lock, [&]() { return stopping || !queue.empty(); });
+      if (queue.empty()) {
+        return;
+      }
+      file = std::move(queue.front());
+      queue.pop_front();
+    }
+
+    LOG_INFO("Saving " << file.path);
+    std::vector<const double*> channels{};
+    for (const std::vector<double>& channel : file.channels) {
+      channels.push_back(channel.data());
+    }
+    const size_t numFrames =
+        file.channels.empty() ? 0 : file.channels.front().size();
+    const bool ok = encoder.write(file.path, channels.data(), channels.size(),
+                                  numFrames, file.format, file.sampleRate);
+
+    // Free the samples before making room for more.
+    const size_t bytes = getSignalBytes(file);
+    std::vector<std::vector<double>>().swap(file.channels);
+    if (file.onWritten) {
+      file.onWritten(ok);
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      queuedBytes -= bytes;
+      numFailed += ok ? 0 : 1;
+    }
+    changed.notify_all();
+  }
+}
@@ -0,0 +1,113 @@
+/**
+ ******************************************************************************
+ * @file    outputWriter.h
+ * @brief   Asynchronous audio file writer header.
+ ******************************************************************************
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "wav_format.h"
+
+/** @brief Default bytes of samples the output writer may hold. */
+inline constexpr size_t DEFAULT_OUTPUT_QUEUE_BYTES = size_t{512} << 20;
+
+/** @brief A signal waiting to be written to a WAV file. */
+struct OutputFile {
+  /** @brief Path of the file. */
+  std::string path{};
+
+  /** @brief Samples of each channel, all the same length. */
+  std::vector<std::vector<double>> channels{};
+
+  /** @brief Sample encoding of the file. */
+  WAVSampleFormat format{WAVSampleFormat::Int16};
+
+  /** @brief Sample rate of the signal. */
+  uint32_t sampleRate{0};
+
+  /**
+   * @brief Called on the writer thread once the file is written, with whether
+   * the write succeeded. Optional.
+   */
+  std::function<void(bool ok)> onWritten{};
+};
+
+/**
+ * @brief Writes audio files on its own thread, in the order they are queued.
+ *
+ * Pipelines hand finished signals over and carry on, so encoding and disk
+ * writes overlap the rest of the processing. The queue is bounded by the
+ * bytes of samples it holds, including the file being written. A full queue
+ * blocks the caller until earlier files are written, which caps the memory
+ * held by pending outputs. A file larger than the whole bound waits for an
+ * empty queue.
+ */
+class OutputWriter {
+ public:
+  /**
+   * @brief Construct a new OutputWriter object and start its thread.
+   *
+   * @param[in] maxQueuedBytes Bytes of samples the queue may hold. 0 means no
+   * limit.
+   */
+  explicit OutputWriter(size_t maxQueuedBytes = DEFAULT_OUTPUT_QUEUE_BYTES);
+
+  /** @brief Write every queued file and stop the thread. */
+  ~OutputWriter();
+
+  OutputWriter(const OutputWriter&) = delete;
+  OutputWriter& operator=(const OutputWriter&) = delete;
+
+  /**
+   * @brief Queue a file. Blocks while the queue is full.
+   *
+   * @param[in] file File to write. Its samples are moved, not copied.
+   */
+  void submit(OutputFile file);
+
+  /**
+   * @brief Wait until every queued file is written.
+   *
+   * @return true if no write has failed so far.
+   */
+  bool wait();
+
+ private:
+  /** @brief Writer thread loop. */
+  void run();
+
+  /** @brief Bytes of samples the queue may hold. 0 means no limit. */
+  const size_t capacity;
+
+  /** @brief Files waiting to be written. */
+  std::deque<OutputFile> queue{};
+
+  /** @brief Bytes of samples queued or being written. */
+  size_t queuedBytes{0};
+
+  /** @brief The number of failed writes. */
+  size_t numFailed{0};
+
+  /** @brief Set to stop the thread once the queue is empty. */
+  bool stopping{false};
+
+  /** @brief Guards every member above. */
+  std::mutex mutex{};
+
+  /** @brief Signalled whenever the queue or queuedBytes changes. */
+  std::condition_variable changed{};
+
+  /** @brief Writer thread. Started last, once the members exist. */
+  std::thread thread{};
+};
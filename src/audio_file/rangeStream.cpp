@@ -0,0 +1,64 @@
+/**
+ ******************************************************************************
+ * @file    rangeStream.cpp
+ * @brief   Audio stream over a range of samples.
+ ******************************************************************************
+ */
+
+#include "rangeStream.h"
+
+#include <algorithm>
+
+#include "logging.h"
+
+RangeStream::RangeStream(AudioStream& source, size_t first, size_t count)
+    : source(source) {
+  const size_t numSourceSamples = source.getNumSamples();
+  this->first = std::min(first, numSourceSamples);
+  numSamples = std::min(count, numSourceSamples - this->first);
+}
+
+size_t RangeStream::readMono(double* out, size_t count) {
+  if (!seekSource()) {
+    return 0;
+  }
+  const size_t numRead =
+      source.readMono(out, std::min(count, numSamples - position));
+  position += numRead;
+  return numRead;
+}
+
+size_t RangeStream::readAllMonoParallel(double* out, ThreadPool& /*pool*/) {
+  return readMono(out, numSamples - position);
+}
+
+size_t RangeStream::readStereo(double* left, double* right, size_t count) {
+  if (!seekSource()) {
+    return 0;
+  }
+  const size_t numRead =
+      source.readStereo(left, right, std::min(count, numSamples - position));
+  position += numRead;
+  return numRead;
+}
+
+bool RangeStream::seek(size_t sample) {
+  if (sample > numSamples) {
+    return false;
+  }
+  position = sample;
+  isSeeked = false;
+  return true;
+}
+
+bool RangeStream::seekSource() {
+  if (isSeeked) {
+    return true;
+  }
+  if (!source.seek(first + position)) {
+    LOG_ERROR("Could not seek to sample " << first + position << ".");
+    return false;
+  }
+  isSeeked = true;
+  return true;
+}
@@ -0,0 +1,112 @@
+/**
+ ******************************************************************************
+ * @file    rangeStream.h
+ * @brief   Audio stream over a range of samples header.
+ ******************************************************************************
+ */
+
+#pragma once
+
+#include <cstddef>
+
+#include "audioStream.h"
+
+/**
+ * @brief Presents a range of samples of another stream as a whole track.
+ *
+ * The source is moved to the start of the range before the first read, so
+ * only the range is decoded and the cost does not depend on the length of the
+ * track. Whole track reads decode the range serially, since a parallel read
+ * needs a source that starts at its first sample.
+ */
+class RangeStream : public AudioStream {
+ public:
+  /**
+   * @brief Construct a new RangeStream object.
+   *
+   * @param[in,out] source Stream to read from. Must outlive this object.
+   * @param[in] first Index of the first sample per channel of the range.
+   * Clamped to the track.
+   * @param[in] count The number of samples per channel of the range. Clamped
+   * to the track.
+   */
+  RangeStream(AudioStream& source, size_t first, size_t count);
+
+  /**
+   * @brief Read the next samples of the range, down mixed to mono by the
+   * source.
+   *
+   * @param[out] out Destination of the samples.
+   * @param[in] count The number of samples to read.
+   * @return size_t The number of samples written. Less than count only at the
+   * end of the range.
+   */
+  size_t readMono(double* out, size_t count) override;
+
+  /**
+   * @brief Read the whole range like readMono. The pool is not used.
+   *
+   * @param[out] out Destination of getNumSamples() samples.
+   * @param[in] pool Unused.
+   * @return size_t The number of samples written.
+   */
+  size_t readAllMonoParallel(double* out, ThreadPool& pool) override;
+
+  /** @brief Whole range reads are serial. */
+  inline bool hasParallelRead() const override { return false; }
+
+  /**
+   * @brief Read the next samples of the range for both channels.
+   *
+   * @param[out] left Destination of the left channel samples.
+   * @param[out] right Destination of the right channel samples.
+   * @param[in] count The number of samples per channel to read.
+   * @return size_t The number of samples per channel written. Less than count
+   * only at the end of the range.
+   */
+  size_t readStereo(double* left, double* right, size_t count) override;
+
+  /**
+   * @brief Move the read position within the range.
+   *
+   * @param[in] sample Index of the next sample per channel, from the start of
+   * the range.
+   * @return true if the position is within the range.
+   */
+  bool seek(size_t sample) override;
+
+  /** @brief The number of samples per channel of the range. */
+  inline size_t getNumSamples() const override { return numSamples; }
+
+  /** @brief Channel classification of the source. */
+  inline Channel getChannel() const override { return source.getChannel(); }
+
+  /** @brief Sample rate of the source. */
+  inline int getSampleRate() const override { return source.getSampleRate(); }
+
+  /** @brief Time spent seeking and decoding the source so far. */
+  inline double getDecodeMs() const override { return source.getDecodeMs(); }
+
+ private:
+  /**
+   * @brief Seek the source to the read position if it is not there yet.
+   *
+   * @return true if the source is at the read position.
+   */
+  bool seekSource();
+
+  /** @brief Stream to read from. */
+  AudioStream& source;
+
+  /** @brief Index of the first sample of the range in the source. */
+  size_t first{0};
+
+  /** @brief The number of samples per channel of the range. */
+  size_t numSamples{0};
+
+  /** @brief Index of the next sample to read, from the start of the range. */
+  size_t position{0};
+
+  /** @brief True once the source is at the read position. */
+  bool isSeeked{false};
+};
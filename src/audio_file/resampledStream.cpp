@@ -0,0 +1,164 @@
+/**
+ ******************************************************************************
+ * @file    resampledStream.cpp
+ * @brief   Sample rate converting audio stream.
+ ******************************************************************************
+ */
+
+#include "resampledStream.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include "logging.h"
+
+/** @brief Output samples per channel converted per block. */
+static const size_t BLOCK_SAMPLES = 1 << 16;
+
+ResampledStream::ResampledStream(AudioStream& source, uint32_t sampleRate,
+                                 ResampleQuality quality)
+    : source(source),
+      resampler(static_cast<uint32_t>(source.getSampleRate()), sampleRate,
+                quality) {
+  numSamples = resampler.getOutputSize(source.getNumSamples());
+}
+
+size_t ResampledStream::readMono(double* out, size_t count) {
+  if (pending.empty()) {
+    pending.resize(1);
+  }
+  if (pending.size() != 1) {
+    LOG_ERROR("Resampled stream already read as stereo.");
+    return 0;
+  }
+  return read(&out, count);
+}
+
+size_t ResampledStream::readStereo(double* left, double* right, size_t count) {
+  if (pending.empty()) {
+    pending.resize(2);
+  }
+  if (pending.size() != 2) {
+    LOG_ERROR("Resampled stream already read as mono.");
+    return 0;
+  }
+  double* const outs[2] = {left, right};
+  return read(outs, count);
+}
+
+size_t ResampledStream::readAllMonoParallel(double* out, ThreadPool& pool) {
+  if (position != 0 || !pending.empty()) {
+    LOG_ERROR("Parallel resampling needs a stream that has not been read.");
+    return 0;
+  }
+
+  std::vector<double> input(source.getNumSamples());
+  const size_t numIn = source.readAllMonoParallel(input.data(), pool);
+  const size_t count = std::min(numSamples, resampler.getOutputSize(numIn));
+  auto start = std::chrono::steady_clock::now();
+
+  // Output ranges are independent, so each chunk reads the whole input.
+  pool.parallelFor(0, count, [&](size_t rowStart, size_t rowEnd) {
+    resampler.process(input.data(), 0, numIn, rowStart, rowEnd - rowStart,
+                      out + rowStart);
+  });
+
+  resample_ms += std::chrono::duration<double, std::milli>(
+                     std::chrono::steady_clock::now() - start)
+                     .count();
+  position = numSamples;
+  sourceDone = true;
+  return count;
+}
+
+bool ResampledStream::seek(size_t sample) {
+  if (sample > numSamples) {
+    return false;
+  }
+  const int64_t inFirst = std::max<int64_t>(0, resampler.getFirstInput(sample));
+  if (!source.seek(static_cast<size_t>(inFirst))) {
+    return false;
+  }
+
+  for (std::vector<double>& channel : pending) {
+    channel.clear();
+  }
+  pendingFirst = inFirst;
+  position = sample;
+  sourceDone = false;
+  return true;
+}
+
+size_t ResampledStream::read(double* const* outs, size_t count) {
+  size_t written = 0;
+
+  while (written < count && position < numSamples) {
+    size_t blockSize = std::min(count - written, BLOCK_SAMPLES);
+    blockSize = std::min(blockSize, static_cast<size_t>(numSamples - position));
+
+    // Fill the input up to the last sample the block needs.
+    const int64_t needEnd = resampler.getEndInput(position + blockSize);
+    while (!sourceDone &&
+           pendingFirst + static_cast<int64_t>(pending[0].size()) < needEnd) {
+      readSource(static_cast<size_t>(
+          needEnd - pendingFirst - static_cast<int64_t>(pending[0].size())));
+    }
+
+    // The source can come up short of its reported length.
+    blockSize = std::min(blockSize, static_cast<size_t>(numSamples - position));
+    if (blockSize == 0) {
+      break;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t ch = 0; ch < pending.size(); ch++) {
+      resampler.process(pending[ch].data(), pendingFirst, pending[ch].size(),
+                        position, blockSize, outs[ch] + written);
+    }
+    resample_ms += std::chrono::duration<double, std::milli>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+    position += blockSize;
+    written += blockSize;
+
+    // Drop the input no later output needs.
+    const int64_t keepFirst = resampler.getFirstInput(position);
+    if (keepFirst > pendingFirst) {
+      const size_t numDropped =
+          std::min(static_cast<size_t>(keepFirst - pendingFirst),
+                   pending[0].size());
+      for (std::vector<double>& channel : pending) {
+        channel.erase(channel.begin(), channel.begin() + numDropped);
+      }
+      pendingFirst += static_cast<int64_t>(numDropped);
+    }
+  }
+
+  return written;
+}
+
+size_t ResampledStream::readSource(size_t count) {
+  const size_t offset = pending[0].size();
+  for (std::vector<double>& channel : pending) {
+    channel.resize(offset + count);
+  }
+
+  size_t numRead = 0;
+  if (pending.size() == 1) {
+    numRead = source.readMono(pending[0].data() + offset, count);
+  } else {
+    numRead = source.readStereo(pending[0].data() + offset,
+                                pending[1].data() + offset, count);
+  }
+
+  for (std::vector<double>& channel : pending) {
+    channel.resize(offset + numRead);
+  }
+  if (numRead < count) {
+    sourceDone = true;
+    const int64_t numIn = pendingFirst + static_cast<int64_t>(offset + numRead);
+    numSamples = std::min(
+        numSamples, resampler.getOutputSize(static_cast<size_t>(numIn)));
+  }
+  return numRead;
+}
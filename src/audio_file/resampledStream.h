@@ -0,0 +1,138 @@
+/**
+ ******************************************************************************
+ * @file    resampledStream.h
+ * @brief   Sample rate converting audio stream header.
+ ******************************************************************************
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "audioStream.h"
+#include "resampler.h"
+
+/**
+ * @brief Presents another stream at a different sample rate.
+ *
+ * Samples are read from the source in blocks and converted as they are
+ * requested. Each channel keeps the input that the next output samples still
+ * need, so the output is identical to resampling the whole signal at once. A
+ * stream is read with either readMono or readStereo, not both.
+ */
+class ResampledStream : public AudioStream {
+ public:
+  /**
+   * @brief Construct a new ResampledStream object.
+   *
+   * @param[in,out] source Stream to convert. Must outlive this object and not
+   * have been read from yet.
+   * @param[in] sampleRate Sample rate of the output.
+   * @param[in] quality Filter length and stop band.
+   */
+  ResampledStream(AudioStream& source, uint32_t sampleRate,
+                  ResampleQuality quality = ResampleQuality::Balanced);
+
+  /**
+   * @brief Convert the next samples, down mixed to mono by the source.
+   *
+   * @param[out] out Destination of the samples.
+   * @param[in] count The number of samples to read.
+   * @return size_t The number of samples written. Less than count only at the
+   * end of the stream.
+   */
+  size_t readMono(double* out, size_t count) override;
+
+  /**
+   * @brief Read the whole source in parallel, then convert output ranges on
+   * the thread pool. The output is identical to readMono.
+   *
+   * @param[out] out Destination of getNumSamples() samples.
+   * @param[in] pool Pool to work on.
+   * @return size_t The number of samples written.
+   */
+  size_t readAllMonoParallel(double* out, ThreadPool& pool) override;
+
+  /** @brief The conversion runs on the pool whatever the source does. */
+  inline bool hasParallelRead() const override { return true; }
+
+  /**
+   * @brief Convert the next samples of both channels.
+   *
+   * @param[out] left Destination of the left channel samples.
+   * @param[out] right Destination of the right channel samples.
+   * @param[in] count The number of samples per channel to read.
+   * @return size_t The number of samples per channel written. Less than count
+   * only at the end of the stream.
+   */
+  size_t readStereo(double* left, double* right, size_t count) override;
+
+  /**
+   * @brief Move the read position to an output sample. The source is moved
+   * to the first input sample the output needs, so the samples match reading
+   * from the start.
+   *
+   * @param[in] sample Index of the next output sample per channel to read.
+   * @return true if the position is within the track.
+   */
+  bool seek(size_t sample) override;
+
+  /** @brief The number of samples per channel at the output rate. */
+  inline size_t getNumSamples() const override { return numSamples; }
+
+  /** @brief Channel classification of the source. */
+  inline Channel getChannel() const override { return source.getChannel(); }
+
+  /** @brief Sample rate of the output. */
+  inline int getSampleRate() const override {
+    return static_cast<int>(resampler.getOutputRate());
+  }
+
+  /** @brief Time spent decoding the source and converting so far. */
+  inline double getDecodeMs() const override {
+    return source.getDecodeMs() + resample_ms;
+  }
+
+ private:
+  /**
+   * @brief Convert the next samples of each channel.
+   *
+   * @param[out] outs Destination of each channel.
+   * @param[in] count The number of samples per channel to read.
+   * @return size_t The number of samples per channel written.
+   */
+  size_t read(double* const* outs, size_t count);
+
+  /**
+   * @brief Read more input from the source into every pending buffer.
+   *
+   * @param[in] count The number of samples per channel wanted.
+   * @return size_t The number of samples per channel read.
+   */
+  size_t readSource(size_t count);
+
+  /** @brief Stream to convert. */
+  AudioStream& source;
+
+  /** @brief Converter from the source rate. */
+  const Resampler resampler;
+
+  /** @brief The number of output samples per channel. */
+  size_t numSamples{0};
+
+  /** @brief Index of the next output sample. */
+  uint64_t position{0};
+
+  /** @brief Input of each channel still needed, from pendingFirst on. */
+  std::vector<std::vector<double>> pending{};
+
+  /** @brief Index of the first sample of pending. */
+  int64_t pendingFirst{0};
+
+  /** @brief True once the source has no more samples. */
+  bool sourceDone{false};
+
+  /** @brief Time spent converting so far. */
+  double resample_ms{0.0};
+};
@@ -0,0 +1,418 @@
+/**
+ ******************************************************************************
+ * @file    wav_decoding.cpp
+ * @brief   WAV file decoding source code.
+ ******************************************************************************
+ */
+
+#include "wav_decoding.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+#include "constants.h"
+#include "logging.h"
+#include "pcmKernels.h"
+
+/** @brief Largest positive 24 bit sample. */
+static const double INT24_MAX_VALUE = 8388607.0;
+
+/** @brief Read a little endian 16 bit value. */
+static uint16_t readLE16(const uint8_t* in) {
+  return static_cast<uint16_t>(in[0] | (in[1] << 8));
+}
+
+/** @brief Read a little endian 32 bit value. */
+static uint32_t readLE32(const uint8_t* in) {
+  return static_cast<uint32_t>(in[0]) | (static_cast<uint32_t>(in[1]) << 8) |
+         (static_cast<uint32_t>(in[2]) << 16) |
+         (static_cast<uint32_t>(in[3]) << 24);
+}
+
+/** @brief Read a little endian 64 bit value. */
+static uint64_t readLE64(const uint8_t* in) {
+  return static_cast<uint64_t>(readLE32(in)) |
+         (static_cast<uint64_t>(readLE32(in + 4)) << 32);
+}
+
+/** @brief Read one sample normalized to [-1, 1]. */
+template <WAVSampleFormat Format>
+static double readSample(const uint8_t* in) {
+  if constexpr (Format == WAVSampleFormat::UInt8) {
+    // 8 bit samples are unsigned with 128 as silence.
+    return (static_cast<double>(in[0]) - 128.0) / INT8_MAX;
+  } else if constexpr (Format == WAVSampleFormat::Int16) {
+    return static_cast<double>(static_cast<int16_t>(readLE16(in))) / INT16_MAX;
+  } else if constexpr (Format == WAVSampleFormat::Int24) {
+    // Sign extend from bit 23.
+    const int32_t value =
+        static_cast<int32_t>((readLE32(in) & 0xFFFFFF) ^ 0x800000) - 0x800000;
+    return static_cast<double>(value) / INT24_MAX_VALUE;
+  } else if constexpr (Format == WAVSampleFormat::Int32) {
+    return static_cast<double>(static_cast<int32_t>(readLE32(in))) / INT32_MAX;
+  } else if constexpr (Format == WAVSampleFormat::Float32) {
+    const uint32_t bits = readLE32(in);
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return static_cast<double>(value);
+  } else {
+    const uint64_t bits = readLE64(in);
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+  }
+}
+
+/**
+ * @brief Convert interleaved samples to mono. Stereo samples are the average
+ * of both channels, like MP3 input.
+ *
+ * @param[in] in First byte of the samples.
+ * @param[in] count The number of samples per channel.
+ * @param[in] channel Channel layout of in.
+ * @param[out] out Destination of count samples.
+ */
+template <WAVSampleFormat Format>
+static void toMono(const uint8_t* in, size_t count, Channel channel,
+                   double* out) {
+  constexpr size_t sampleBytes = getSampleBytes(Format);
+
+  if (channel == Channel::Stereo) {
+    for (size_t i = 0; i < count; i++) {
+      const double left = readSample<Format>(in + 2 * i * sampleBytes);
+      const double right = readSample<Format>(in + (2 * i + 1) * sampleBytes);
+      out[i] = (left + right) / 2.0;
+    }
+  } else {
+    for (size_t i = 0; i < count; i++) {
+      out[i] = readSample<Format>(in + i * sampleBytes);
+    }
+  }
+}
+
+/**
+ * @brief Convert interleaved samples to one array per channel.
+ *
+ * @param[in] in First byte of the samples.
+ * @param[in] count The number of samples per channel.
+ * @param[in] numChannels The number of channels of in.
+ * @param[out] out One destination of count samples per channel.
+ */
+template <WAVSampleFormat Format>
+static void toChannels(const uint8_t* in, size_t count, size_t numChannels,
+                       double* const* out) {
+  constexpr size_t sampleBytes = getSampleBytes(Format);
+
+  for (size_t i = 0; i < count; i++) {
+    for (size_t c = 0; c < numChannels; c++) {
+      out[c][i] = readSample<Format>(in + (i * numChannels + c) * sampleBytes);
+    }
+  }
+}
+
+/**
+ * @brief True if samples of the given type can be read in place from the
+ * mapped file: the host is little endian like WAV and the data is aligned.
+ */
+template <typename Sample>
+static bool isReadableInPlace(const uint8_t* pcm) {
+  return !HOST_IS_BIG_ENDIAN && pcm != nullptr &&
+         reinterpret_cast<uintptr_t>(pcm) % alignof(Sample) == 0;
+}
+
+bool WAVFileDecoder::open(const std::string& filepath) {
+  close();
+  auto start = std::chrono::steady_clock::now();
+
+  if (!file.open(filepath)) {
+    return false;
+  }
+
+  const uint8_t* data = file.data();
+  const size_t size = file.size();
+  const bool isRiff = size >= 12 && std::memcmp(data, "RIFF", 4) == 0;
+  const bool isRf64 = size >= 12 && (std::memcmp(data, "RF64", 4) == 0 ||
+                                     std::memcmp(data, "BW64", 4) == 0);
+  if ((!isRiff && !isRf64) || std::memcmp(data + 8, "WAVE", 4) != 0) {
+    LOG_ERROR("Not a WAV file: " << filepath.c_str());
+    close();
+    return false;
+  }
+
+  uint16_t audioFormat = 0;
+  uint16_t numChannels = 0;
+  uint16_t blockAlign = 0;
+  uint16_t bitsPerSample = 0;
+  uint32_t sampleRate = 0;
+  uint64_t ds64DataSize = 0;
+  size_t dataOffset = 0;
+  uint64_t dataSize = 0;
+  bool hasFormat = false;
+  bool hasData = false;
+
+  // Walk the chunks. Unknown chunks such as LIST are skipped.
+  size_t offset = 12;
+  while (offset + 8 <= size) {
+    const uint8_t* chunk = data + offset;
+    const uint8_t* body = chunk + 8;
+    const size_t available = size - offset - 8;
+    uint64_t chunkSize = readLE32(chunk + 4);
+
+    if (std::memcmp(chunk, "ds64", 4) == 0 && available >= 24) {
+      ds64DataSize = readLE64(body + 8);
+    } else if (std::memcmp(chunk, "fmt ", 4) == 0 && chunkSize >= 16 &&
+               available >= 16) {
+      audioFormat = readLE16(body);
+      numChannels = readLE16(body + 2);
+      sampleRate = readLE32(body + 4);
+      blockAlign = readLE16(body + 12);
+      bitsPerSample = readLE16(body + 14);
+
+      // The sub format GUID starts with the actual format tag.
+      if (audioFormat == WAVE_FORMAT_EXTENSIBLE && chunkSize >= 40 &&
+          available >= 40) {
+        audioFormat = readLE16(body + 24);
+      }
+      hasFormat = true;
+    } else if (std::memcmp(chunk, "data", 4) == 0 && !hasData) {
+      if (isRf64 && chunkSize == RF64_SIZE_IN_DS64) {
+        chunkSize = ds64DataSize;
+      }
+      if (chunkSize > available) {
+        LOG_WARNING("WAV data chunk is cut short. Reading the "
+                    << available << " bytes present.");
+      }
+      dataOffset = offset + 8;
+      dataSize = std::min<uint64_t>(chunkSize, available);
+      hasData = true;
+    }
+
+    if (chunkSize >= available) {
+      break;
+    }
+
+    // Chunks are padded to an even size.
+    offset += 8 + static_cast<size_t>(chunkSize) + (chunkSize & 1);
+  }
+
+  if (!hasFormat || !hasData) {
+    LOG_ERROR("WAV file has no " << (hasFormat ? "data" : "fmt ")
+                                 << " chunk: " << filepath.c_str());
+    close();
+    return false;
+  }
+
+  if (audioFormat == WAVE_FORMAT_PCM && bitsPerSample == 8) {
+    format = WAVSampleFormat::UInt8;
+  } else if (audioFormat == WAVE_FORMAT_PCM && bitsPerSample == 16) {
+    format = WAVSampleFormat::Int16;
+  } else if (audioFormat == WAVE_FORMAT_PCM && bitsPerSample == 24) {
+    format = WAVSampleFormat::Int24;
+  } else if (audioFormat == WAVE_FORMAT_PCM && bitsPerSample == 32) {
+    format = WAVSampleFormat::Int32;
+  } else if (audioFormat == WAVE_FORMAT_IEEE_FLOAT && bitsPerSample == 32) {
+    format = WAVSampleFormat::Float32;
+  } else if (audioFormat == WAVE_FORMAT_IEEE_FLOAT && bitsPerSample == 64) {
+    format = WAVSampleFormat::Float64;
+  } else {
+    LOG_ERROR("Unsupported WAV format " << audioFormat << " with "
+                                        << bitsPerSample
+                                        << " bits per sample.");
+    close();
+    return false;
+  }
+
+  if (numChannels != 1 && numChannels != 2) {
+    LOG_ERROR("Only mono and stereo WAV files are supported, not "
+              << numChannels << " channels.");
+    close();
+    return false;
+  }
+
+  frameBytes = static_cast<size_t>(numChannels) * (bitsPerSample / BYTE_SIZE);
+  if (blockAlign != frameBytes || sampleRate == 0) {
+    LOG_ERROR("Malformed WAV fmt chunk: " << filepath.c_str());
+    close();
+    return false;
+  }
+
+  pcm = data + dataOffset;
+  channel = static_cast<Channel>(numChannels);
+  sampleRate_hz = static_cast<int>(sampleRate);
+  numSamples = static_cast<size_t>(dataSize / frameBytes);
+
+  LOG_INFO("WAV # samples: " << numSamples);
+  LOG_INFO("Sample rate (Hz): " << sampleRate_hz);
+  LOG_INFO("Channels: " << numChannels);
+  LOG_INFO("Bits per sample: " << bitsPerSample);
+
+  decode_ms = std::chrono::duration<double, std::milli>(
+                  std::chrono::steady_clock::now() - start)
+                  .count();
+  return true;
+}
+
+size_t WAVFileDecoder::readMono(double* out, size_t count) {
+  if (pcm == nullptr) {
+    return 0;
+  }
+  auto start = std::chrono::steady_clock::now();
+
+  const size_t numRead = std::min(count, numSamples - position);
+  convert(position, numRead, out);
+  position += numRead;
+
+  decode_ms += std::chrono::duration<double, std::milli>(
+                   std::chrono::steady_clock::now() - start)
+                   .count();
+  return numRead;
+}
+
+size_t WAVFileDecoder::readAllMonoParallel(double* out, ThreadPool& pool) {
+  if (pcm == nullptr || position != 0) {
+    LOG_ERROR("Parallel decoding needs a stream that has not been read.");
+    return 0;
+  }
+  auto start = std::chrono::steady_clock::now();
+
+  pool.parallelFor(0, numSamples, [&](size_t first, size_t last) {
+    convert(first, last - first, out + first);
+  });
+  position = numSamples;
+
+  decode_ms += std::chrono::duration<double, std::milli>(
+                   std::chrono::steady_clock::now() - start)
+                   .count();
+  return numSamples;
+}
+
+size_t WAVFileDecoder::readStereo(double* left, double* right, size_t count) {
+  if (pcm == nullptr) {
+    return 0;
+  }
+  auto start = std::chrono::steady_clock::now();
+
+  const size_t numRead = std::min(count, numSamples - position);
+  double* const out[] = {left, right};
+  convertChannels(position, numRead, out);
+  if (channel == Channel::Mono) {
+    std::copy(left, left + numRead, right);
+  }
+  position += numRead;
+
+  decode_ms += std::chrono::duration<double, std::milli>(
+                   std::chrono::steady_clock::now() - start)
+                   .count();
+  return numRead;
+}
+
+bool WAVFileDecoder::seek(size_t sample) {
+  if (pcm == nullptr || sample > numSamples) {
+    return false;
+  }
+  // Samples are converted straight from the mapping, so any position is
+  // reached at no cost.
+  position = sample;
+  return true;
+}
+
+const int16_t* WAVFileDecoder::getInt16Samples() const {
+  if (format != WAVSampleFormat::Int16 || !isReadableInPlace<int16_t>(pcm)) {
+    return nullptr;
+  }
+  return reinterpret_cast<const int16_t*>(pcm);
+}
+
+void WAVFileDecoder::close() {
+  file.close();
+  pcm = nullptr;
+  frameBytes = 0;
+  numSamples = 0;
+  sampleRate_hz = 0;
+  position = 0;
+}
+
+void WAVFileDecoder::convert(size_t first, size_t count, double* out) const {
+  const uint8_t* in = pcm + first * frameBytes;
+  const size_t numChannels = static_cast<size_t>(channel);
+
+  switch (format) {
+    case WAVSampleFormat::UInt8:
+      toMono<WAVSampleFormat::UInt8>(in, count, channel, out);
+      break;
+    case WAVSampleFormat::Int16:
+      // Fast path: convert the samples in place from the mapped file.
+      if (isReadableInPlace<int16_t>(in)) {
+        int16ToMono(reinterpret_cast<const int16_t*>(in), numChannels, count,
+                    out);
+      } else {
+        toMono<WAVSampleFormat::Int16>(in, count, channel, out);
+      }
+      break;
+    case WAVSampleFormat::Int24:
+      toMono<WAVSampleFormat::Int24>(in, count, channel, out);
+      break;
+    case WAVSampleFormat::Int32:
+      if (isReadableInPlace<int32_t>(in)) {
+        int32ToMono(reinterpret_cast<const int32_t*>(in), numChannels, count,
+                    out);
+      } else {
+        toMono<WAVSampleFormat::Int32>(in, count, channel, out);
+      }
+      break;
+    case WAVSampleFormat::Float32:
+      if (isReadableInPlace<float>(in)) {
+        floatToMono(reinterpret_cast<const float*>(in), numChannels, count,
+                    out);
+      } else {
+        toMono<WAVSampleFormat::Float32>(in, count, channel, out);
+      }
+      break;
+    case WAVSampleFormat::Float64:
+      toMono<WAVSampleFormat::Float64>(in, count, channel, out);
+      break;
+  }
+}
+
+void WAVFileDecoder::convertChannels(size_t first, size_t count,
+                                     double* const* out) const {
+  const uint8_t* in = pcm + first * frameBytes;
+  const size_t numChannels = static_cast<size_t>(channel);
+
+  switch (format) {
+    case WAVSampleFormat::UInt8:
+      toChannels<WAVSampleFormat::UInt8>(in, count, numChannels, out);
+      break;
+    case WAVSampleFormat::Int16:
+      if (isReadableInPlace<int16_t>(in)) {
+        int16ToDouble(reinterpret_cast<const int16_t*>(in), numChannels, count,
+                      out);
+      } else {
+        toChannels<WAVSampleFormat::Int16>(in, count, numChannels, out);
+      }
+      break;
+    case WAVSampleFormat::Int24:
+      toChannels<WAVSampleFormat::Int24>(in, count, numChannels, out);
+      break;
+    case WAVSampleFormat::Int32:
+      if (isReadableInPlace<int32_t>(in)) {
+        int32ToDouble(reinterpret_cast<const int32_t*>(in), numChannels, count,
+                      out);
+      } else {
+        toChannels<WAVSampleFormat::Int32>(in, count, numChannels, out);
+      }
+      break;
+    case WAVSampleFormat::Float32:
+      if (isReadableInPlace<float>(in)) {
+        floatToDouble(reinterpret_cast<const float*>(in), numChannels, count,
+                      out);
+      } else {
+        toChannels<WAVSampleFormat::Float32>(in, count, numChannels, out);
+      }
+      break;
+    case WAVSampleFormat::Float64:
+      toChannels<WAVSampleFormat::Float64>(in, count, numChannels, out);
+      break;
+  }
+}
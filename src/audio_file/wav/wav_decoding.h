@@ -0,0 +1,122 @@
+/**
+ ******************************************************************************
+ * @file    wav_decoding.h
+ * @brief   WAV file decoding header.
+ ******************************************************************************
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "audioStream.h"
+#include "channel.h"
+#include "mappedFile.h"
+#include "wav_format.h"
+
+/**
+ * @brief Audio decoder from WAV file.
+ *
+ * The file is memory mapped and samples are converted straight from the
+ * mapping, so the PCM is never copied. Integer PCM of 8, 16, 24 and 32 bits
+ * and IEEE float of 32 and 64 bits are read, including WAVE_FORMAT_EXTENSIBLE
+ * and RF64 files. Integer samples are normalized by the largest positive
+ * value, like MP3 input.
+ */
+class WAVFileDecoder : public AudioStream {
+ public:
+  /** @brief Construct a new WAVFileDecoder object. */
+  WAVFileDecoder() = default;
+
+  /**
+   * @brief Open a WAV file and read its header.
+   *
+   * @param[in] filepath path to WAV file.
+   * @return true if the file holds supported PCM audio.
+   */
+  bool open(const std::string& filepath);
+
+  size_t readMono(double* out, size_t count) override;
+
+  size_t readAllMonoParallel(double* out, ThreadPool& pool) override;
+
+  /** @brief Samples are converted on the pool. */
+  inline bool hasParallelRead() const override { return true; }
+
+  size_t readStereo(double* left, double* right, size_t count) override;
+
+  bool seek(size_t sample) override;
+
+  /**
+   * @brief Samples of a 16 bit file, straight from the mapped file. Only
+   * available on little endian hosts when the samples are aligned.
+   *
+   * @return const int16_t* Interleaved samples, or nullptr if not available.
+   */
+  const int16_t* getInt16Samples() const;
+
+  /** @brief Sample encoding of the file. */
+  inline WAVSampleFormat getFormat() const { return format; }
+
+  /** @brief The number of samples per channel of the track. */
+  inline size_t getNumSamples() const override { return numSamples; }
+
+  /** @brief Channel classification. */
+  inline Channel getChannel() const override { return channel; }
+
+  /** @brief Sample rate of the track. */
+  inline int getSampleRate() const override { return sampleRate_hz; }
+
+  /** @brief Time spent reading the header and converting samples so far. */
+  inline double getDecodeMs() const override { return decode_ms; }
+
+ private:
+  /** @brief Unmap the file and reset the header. */
+  void close();
+
+  /**
+   * @brief Convert samples of the file to mono.
+   *
+   * @param[in] first Index of the first sample per channel.
+   * @param[in] count The number of samples per channel.
+   * @param[out] out Destination of count samples.
+   */
+  void convert(size_t first, size_t count, double* out) const;
+
+  /**
+   * @brief Convert samples of the file to one array per channel.
+   *
+   * @param[in] first Index of the first sample per channel.
+   * @param[in] count The number of samples per channel.
+   * @param[out] out One destination of count samples per channel.
+   */
+  void convertChannels(size_t first, size_t count, double* const* out) const;
+
+  /** @brief Mapped input file. */
+  MappedFile file{};
+
+  /** @brief First byte of the data chunk. */
+  const uint8_t* pcm{nullptr};
+
+  /** @brief Sample encoding. */
+  WAVSampleFormat format{WAVSampleFormat::Int16};
+
+  /** @brief Bytes per sample of every channel. */
+  size_t frameBytes{0};
+
+  /** @brief The number of samples per channel. */
+  size_t numSamples{0};
+
+  /** @brief Channel classification. */
+  Channel channel{Channel::Mono};
+
+  /** @brief Sample rate of the track. */
+  int sampleRate_hz{0};
+
+  /** @brief Index of the next sample to read. */
+  size_t position{0};
+
+  /** @brief Time spent reading the header and converting samples so far. */
+  double decode_ms{0.0};
+};
@@ -8,169 +8,272 @@
 #include "wav_encoding.h"
 
 #include <algorithm>
+#include <cstring>
+#include <fstream>
 
+#include "alignedAllocator.hpp"
 #include "constants.h"
 #include "endian.h"
 #include "logging.h"
 
-WAVFileEncoder::WAVFileEncoder() {};
+/** @brief Bytes quantized per write. */
+static const size_t BLOCK_BYTES = size_t{1} << 20;
 
-void WAVFileEncoder::writeToFile(std::string fileName, std::vector<double> pcm,
-                                 uint16_t bitsPerSample, Channel channel,
-                                 uint32_t sampleRate) {
-  // TODO: Restrict bits per sample is 8, 16, 24 or 32.
+/** @brief Size of the body of the ds64 chunk without a table. */
+static const uint32_t DS64_BODY_BYTES = 28;
 
-  // Prepare WAV header data.
-  WavHeaderData wavHeader{};
-  this->prepareHeader(wavHeader, static_cast<uint32_t>(pcm.size()),
-                      bitsPerSample, channel, sampleRate);
+/** @brief Sub format GUID after the format tag, for WAVE_FORMAT_EXTENSIBLE. */
+static const uint8_t SUB_FORMAT_SUFFIX[14] = {0x00, 0x00, 0x00, 0x00, 0x10,
+                                              0x00, 0x80, 0x00, 0x00, 0xAA,
+                                              0x00, 0x38, 0x9B, 0x71};
 
-  // TODO: Move the file reader to another file or class in helper.
-  // Stream WAV header data to file.
-  std::string path = fileName + ".wav";
-  std::ofstream wavFile(path, std::ios::out | std::ios::binary);
-  if (!wavFile.is_open()) {
-    LOG_ERROR("Error in opening file: " << path);
-    return;
+/** @brief Append a little endian value of numBytes bytes. */
+static void appendLE(std::vector<uint8_t>& out, uint64_t value,
+                     size_t numBytes) {
+  for (size_t i = 0; i < numBytes; i++) {
+    out.push_back(static_cast<uint8_t>(value >> (BYTE_SIZE * i)));
   }
+}
 
-  char wavHeaderChar[44];
-  size_t offset = 0;
-
-  // RIFF chunk.
-  memcpy(wavHeaderChar + offset, "RIFF", 4);
-  offset += 4;
-
-  memcpy(wavHeaderChar + offset, &wavHeader.riffChunkSize, 4);
-  offset += 4;
-
-  memcpy(wavHeaderChar + offset, "WAVE", 4);
-  offset += 4;
-
-  // fmt sub chunk.
-  memcpy(wavHeaderChar + offset, "fmt ", 4);
-  offset += 4;
-
-  memcpy(wavHeaderChar + offset, &FMT_SIZE_LE, 4);
-  offset += 4;
-
-  memcpy(wavHeaderChar + offset, &wavHeader.audioFormat, 2);
-  offset += 2;
-
-  memcpy(wavHeaderChar + offset, &wavHeader.numChannels, 2);
-  offset += 2;
-
-  memcpy(wavHeaderChar + offset, &wavHeader.sampleRate, 4);
-  offset += 4;
-
-  memcpy(wavHeaderChar + offset, &wavHeader.byteRate, 4);
-  offset += 4;
+/** @brief Append a four character code. */
+static void appendTag(std::vector<uint8_t>& out, const char* tag) {
+  for (size_t i = 0; i < 4; i++) {
+    out.push_back(static_cast<uint8_t>(tag[i]));
+  }
+}
 
-  memcpy(wavHeaderChar + offset, &wavHeader.blockAlign, 2);
-  offset += 2;
+/** @brief Speaker positions of the channels, for WAVE_FORMAT_EXTENSIBLE. */
+static uint32_t getChannelMask(size_t numChannels) {
+  if (numChannels == 1) {
+    return 0x4;  // Front center.
+  } else if (numChannels == 2) {
+    return 0x3;  // Front left and front right.
+  }
+  return 0;  // Not assigned to speakers.
+}
 
-  memcpy(wavHeaderChar + offset, &wavHeader.bitsPerSample, 2);
-  offset += 2;
+/** @brief Swap quantized samples to little endian on big endian hosts. */
+static void toLittleEndian(uint8_t* samples, size_t count,
+                           size_t sampleBytes) {
+  if (!HOST_IS_BIG_ENDIAN) {
+    return;
+  }
 
-  memcpy(wavHeaderChar + offset, "data", 4);
-  offset += 4;
+  for (size_t i = 0; i < count; i++) {
+    uint8_t* sample = samples + i * sampleBytes;
+    if (sampleBytes == 2) {
+      uint16_t value;
+      std::memcpy(&value, sample, 2);
+      value = endianSwap2B(value);
+      std::memcpy(sample, &value, 2);
+    } else if (sampleBytes == 4) {
+      uint32_t value;
+      std::memcpy(&value, sample, 4);
+      value = endianSwap4B(value);
+      std::memcpy(sample, &value, 4);
+    }
+  }
+}
 
-  memcpy(wavHeaderChar + offset, &wavHeader.dataChunkSize, 4);
-  offset += 4;
+/**
+ * @brief Quantize a block of frames into little endian samples.
+ *
+ * @param[in] format Sample encoding.
+ * @param[in] in One source per channel.
+ * @param[in] numChannels The number of channels.
+ * @param[in] numFrames The number of samples per channel.
+ * @param[out] out Aligned destination of the interleaved samples.
+ * @param[in,out] dither Dither noise source, or nullptr for no dither.
+ */
+static void quantizeBlock(WAVSampleFormat format, const double* const* in,
+                          size_t numChannels, size_t numFrames, uint8_t* out,
+                          TPDFDither* dither) {
+  switch (format) {
+    case WAVSampleFormat::UInt8:
+      doubleToUInt8(in, numChannels, numFrames, out, dither);
+      break;
+    case WAVSampleFormat::Int16:
+      doubleToInt16(in, numChannels, numFrames,
+                    reinterpret_cast<int16_t*>(out), dither);
+      break;
+    case WAVSampleFormat::Int24:
+      doubleToInt24(in, numChannels, numFrames, out, dither);
+      break;
+    case WAVSampleFormat::Int32:
+      doubleToInt32(in, numChannels, numFrames,
+                    reinterpret_cast<int32_t*>(out), dither);
+      break;
+    case WAVSampleFormat::Float32:
+      doubleToFloat(in, numChannels, numFrames, reinterpret_cast<float*>(out));
+      break;
+    case WAVSampleFormat::Float64:
+      break;
+  }
 
-  size_t wavHeaderSize = sizeof(wavHeaderChar);
-  this->flushBuffer(wavFile, wavHeaderChar, wavHeaderSize);
+  // 8 and 24 bit samples are written byte by byte already.
+  const size_t sampleBytes = getSampleBytes(format);
+  if (sampleBytes == 2 || sampleBytes == 4) {
+    toLittleEndian(out, numChannels * numFrames, sampleBytes);
+  }
+}
 
-  // Stream audio data to WAV file.
-  this->clampPCM(pcm);
+WAVFileEncoder::WAVFileEncoder() {};
 
-  char buffer[1024];
-  size_t bufferSize = sizeof(buffer);
-  offset = 0;
+bool WAVFileEncoder::write(const std::string& path,
+                           const double* const* channels, size_t numChannels,
+                           size_t numFrames, WAVSampleFormat format,
+                           uint32_t sampleRate) {
+  const size_t frameBytes = numChannels * getSampleBytes(format);
+  if (format == WAVSampleFormat::Float64) {
+    LOG_ERROR("64 bit float WAV output is not supported.");
+    return false;
+  }
+  if (numChannels == 0 || frameBytes > UINT16_MAX) {
+    LOG_ERROR("Cannot write " << numChannels << " channels to a WAV file.");
+    return false;
+  }
 
-  if (bitsPerSample == 8) {
-    for (double sample : pcm) {
-      if (offset >= bufferSize) {
-        this->flushBuffer(wavFile, buffer, offset);
-      }
+  std::ofstream wavFile(path, std::ios::out | std::ios::binary);
+  if (!wavFile.is_open()) {
+    LOG_ERROR("Error in opening file: " << path);
+    return false;
+  }
 
-      uint8_t pcmUInt = static_cast<uint8_t>(sample * INT8_MAX);
-      memcpy(buffer + offset, &pcmUInt, 1);
-      offset += 1;
+  std::vector<uint8_t> header =
+      createHeader(format, numChannels, numFrames, sampleRate);
+  wavFile.write(reinterpret_cast<const char*>(header.data()),
+                static_cast<std::streamsize>(header.size()));
+
+  // Quantize whole frames into one large block per write, which the stream
+  // hands to the file in a single call instead of copying it to its buffer.
+  const size_t blockFrames = std::max<size_t>(1, BLOCK_BYTES / frameBytes);
+  AlignedVector<uint8_t> block(blockFrames * frameBytes);
+  std::vector<const double*> in(numChannels);
+
+  for (size_t first = 0; first < numFrames && wavFile; first += blockFrames) {
+    const size_t count = std::min(blockFrames, numFrames - first);
+    for (size_t c = 0; c < numChannels; c++) {
+      in[c] = channels[c] + first;
     }
-
-    this->flushBuffer(wavFile, buffer, offset);
+    quantizeBlock(format, in.data(), numChannels, count, block.data(),
+                  dither);
+    wavFile.write(reinterpret_cast<const char*>(block.data()),
+                  static_cast<std::streamsize>(count * frameBytes));
   }
 
-  else if (bitsPerSample == 16) {
-    for (double sample : pcm) {
-      if (offset >= bufferSize) {
-        this->flushBuffer(wavFile, buffer, offset);
-      }
-
-      uint16_t pcmUInt = static_cast<uint16_t>(sample * INT16_MAX);
-      pcmUInt = convertToLE2B(pcmUInt);
-      memcpy(buffer + offset, &pcmUInt, 2);
-      offset += 2;
-    }
+  // Chunks are padded to an even size.
+  if ((numFrames * frameBytes) & 1) {
+    wavFile.put(0);
+  }
 
-    this->flushBuffer(wavFile, buffer, offset);
+  wavFile.close();
+  if (!wavFile) {
+    LOG_ERROR("Error in writing file: " << path);
+    return false;
   }
+  return true;
+}
 
-  else if (bitsPerSample == 24) {
-    LOG_ERROR("24 bits per sample is currently not supported.");
+bool WAVFileEncoder::writeToFile(std::string fileName,
+                                 const std::vector<double>& pcm,
+                                 uint16_t bitsPerSample, Channel channel,
+                                 uint32_t sampleRate) {
+  if (channel != Channel::Mono) {
+    LOG_ERROR("writeToFile takes a mono signal. Use write for more channels.");
+    return false;
   }
 
-  else if (bitsPerSample == 32) {
-    for (double sample : pcm) {
-      if (offset >= bufferSize) {
-        this->flushBuffer(wavFile, buffer, offset);
-      }
+  WAVSampleFormat format;
+  switch (bitsPerSample) {
+    case 8:
+      format = WAVSampleFormat::UInt8;
+      break;
+    case 16:
+      format = WAVSampleFormat::Int16;
+      break;
+    case 24:
+      format = WAVSampleFormat::Int24;
+      break;
+    case 32:
+      format = WAVSampleFormat::Int32;
+      break;
+    default:
+      LOG_ERROR(bitsPerSample << " bits per sample is not supported.");
+      return false;
+  }
 
-      uint32_t pcmUInt = static_cast<uint32_t>(sample * INT32_MAX);
-      pcmUInt = convertToLE4B(pcmUInt);
-      memcpy(buffer + offset, &pcmUInt, 4);
-      offset += 4;
-    }
+  const double* channels[] = {pcm.data()};
+  return write(fileName + ".wav", channels, 1, pcm.size(), format, sampleRate);
+}
 
-    this->flushBuffer(wavFile, buffer, offset);
+std::vector<uint8_t> WAVFileEncoder::createHeader(WAVSampleFormat format,
+                                                  size_t numChannels,
+                                                  uint64_t numFrames,
+                                                  uint32_t sampleRate) {
+  const bool isFloat = format == WAVSampleFormat::Float32 ||
+                       format == WAVSampleFormat::Float64;
+  const uint16_t formatTag = isFloat ? WAVE_FORMAT_IEEE_FLOAT : WAVE_FORMAT_PCM;
+  const size_t sampleBytes = getSampleBytes(format);
+  const uint16_t bitsPerSample = static_cast<uint16_t>(sampleBytes * BYTE_SIZE);
+  const uint16_t blockAlign = static_cast<uint16_t>(numChannels * sampleBytes);
+
+  // WAVE_FORMAT_EXTENSIBLE is required over 16 bits or two channels. Float
+  // uses it too, so that the fmt chunk never needs the 18 byte variant.
+  const bool isExtensible = isFloat || bitsPerSample > 16 || numChannels > 2;
+  const uint32_t fmtBytes = isExtensible ? 40 : 16;
+
+  // Formats other than integer PCM carry the sample count in a fact chunk.
+  const bool hasFact = isFloat;
+
+  // Everything after the RIFF size field, including the data pad byte.
+  const uint64_t dataBytes = numFrames * blockAlign;
+  uint64_t riffBytes =
+      4 + (8 + fmtBytes) + (hasFact ? 12 : 0) + 8 + dataBytes + (dataBytes & 1);
+
+  // Sizes that do not fit 32 bits move to the ds64 chunk of RF64.
+  const bool isRF64 = riffBytes > UINT32_MAX;
+  if (isRF64) {
+    riffBytes += 8 + DS64_BODY_BYTES;
   }
 
-  wavFile.close();
-}
+  std::vector<uint8_t> header{};
+  appendTag(header, isRF64 ? "RF64" : "RIFF");
+  appendLE(header, isRF64 ? RF64_SIZE_IN_DS64 : riffBytes, 4);
+  appendTag(header, "WAVE");
+
+  if (isRF64) {
+    appendTag(header, "ds64");
+    appendLE(header, DS64_BODY_BYTES, 4);
+    appendLE(header, riffBytes, 8);
+    appendLE(header, dataBytes, 8);
+    appendLE(header, numFrames, 8);
+    appendLE(header, 0, 4);  // No table of other chunk sizes.
+  }
 
-void WAVFileEncoder::clampPCM(std::vector<double>& pcm) {
-  for (double& data : pcm) {
-    data = std::clamp(data, -1.0, 1.0);
+  appendTag(header, "fmt ");
+  appendLE(header, fmtBytes, 4);
+  appendLE(header, isExtensible ? WAVE_FORMAT_EXTENSIBLE : formatTag, 2);
+  appendLE(header, numChannels, 2);
+  appendLE(header, sampleRate, 4);
+  appendLE(header, static_cast<uint64_t>(sampleRate) * blockAlign, 4);
+  appendLE(header, blockAlign, 2);
+  appendLE(header, bitsPerSample, 2);
+  if (isExtensible) {
+    appendLE(header, fmtBytes - 18, 2);
+    appendLE(header, bitsPerSample, 2);
+    appendLE(header, getChannelMask(numChannels), 4);
+    appendLE(header, formatTag, 2);
+    header.insert(header.end(), SUB_FORMAT_SUFFIX,
+                  SUB_FORMAT_SUFFIX + sizeof(SUB_FORMAT_SUFFIX));
   }
-}
 
-void WAVFileEncoder::flushBuffer(std::ofstream& file, char* buffer,
-                                 size_t& numBytesFlush) {
-  if (numBytesFlush > 0) {
-    file.write(buffer, numBytesFlush);
-    numBytesFlush = 0;
+  if (hasFact) {
+    appendTag(header, "fact");
+    appendLE(header, 4, 4);
+    appendLE(header, isRF64 ? RF64_SIZE_IN_DS64 : numFrames, 4);
   }
-}
 
-void WAVFileEncoder::prepareHeader(WavHeaderData& wavHeader, uint32_t dataSize,
-                                   uint16_t bitsPerSample, Channel channel,
-                                   uint32_t sampleRate) {
-  // Store the data in little endian format as WAV data can only be in that
-  // format.
-
-  this->bytesPerSample = bitsPerSample / static_cast<uint16_t>(BYTE_SIZE);
-  uint16_t numChannels = static_cast<uint16_t>(channel);
-  uint16_t blockAlign = numChannels * bytesPerSample;
-  uint32_t dataChunkSize = dataSize * blockAlign;
-
-  // Add 36 to include contents of WAV  header except for RIFF chunk desciption.
-  wavHeader.riffChunkSize = convertToLE4B(dataChunkSize + 36U);
-  wavHeader.dataChunkSize = convertToLE4B(dataChunkSize);
-  wavHeader.audioFormat = convertToLE2B(1U);
-  wavHeader.numChannels = convertToLE2B(numChannels);
-  wavHeader.sampleRate = convertToLE4B(sampleRate);
-  wavHeader.byteRate = convertToLE4B(sampleRate * wavHeader.blockAlign);
-  wavHeader.blockAlign = convertToLE2B(blockAlign);
-  wavHeader.bitsPerSample = convertToLE2B(bitsPerSample);
+  appendTag(header, "data");
+  appendLE(header, isRF64 ? RF64_SIZE_IN_DS64 : dataBytes, 4);
+  return header;
 }
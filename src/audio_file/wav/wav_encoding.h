@@ -7,66 +7,81 @@
 
 #pragma once
 
-#include <fstream>
+#include <cstdint>
 #include <string>
 #include <vector>
 
 #include "channel.h"
-#include "endian.h"
-#include "wav_header_data.h"
+#include "pcmKernels.h"
+#include "wav_format.h"
 
-/** @brief Audio encoder to WAV file. */
+/**
+ * @brief Audio encoder to WAV file.
+ *
+ * Samples are quantized by the PCM kernels into a large aligned block, which
+ * is written to the file in one call, so the signal is never copied whole.
+ * Integer PCM of 8, 16, 24 and 32 bits and 32 bit IEEE float are written.
+ * Float, more than 16 bits or more than two channels use
+ * WAVE_FORMAT_EXTENSIBLE. Files over 4 GiB are written as RF64.
+ */
 class WAVFileEncoder {
  public:
   /** @brief Construct a new WAVFileEncoder object. */
   WAVFileEncoder();
 
   /**
-   * @brief Write to WAV file.
+   * @brief Write channels to a WAV file.
    *
-   * @param[in] fileName The name of the file.
-   * @param[in] pcm PCM audio data.
-   * @param[in] bitsPerSample Bits per sample. (8, 16, 24 or 32).
-   * @param[in] channel Mono or stero channel.
+   * @param[in] path Path of the file.
+   * @param[in] channels One array of numFrames samples per channel.
+   * @param[in] numChannels The number of channels.
+   * @param[in] numFrames The number of samples per channel.
+   * @param[in] format Sample encoding. 64 bit float is not written.
    * @param[in] sampleRate The sampling rate.
+   * @return true on success.
    */
-  void writeToFile(std::string fileName, std::vector<double> pcm,
-                   uint16_t bitsPerSample, Channel channel,
-                   uint32_t sampleRate);
+  bool write(const std::string& path, const double* const* channels,
+             size_t numChannels, size_t numFrames, WAVSampleFormat format,
+             uint32_t sampleRate);
 
- private:
   /**
-   * @brief Clamps the data within PCM range.
+   * @brief Write a mono signal to WAV file.
    *
-   * @param[in,out] pcm PCM data.
+   * @param[in] fileName The name of the file, without extension.
+   * @param[in] pcm PCM audio data.
+   * @param[in] bitsPerSample Bits per sample. (8, 16, 24 or 32).
+   * @param[in] channel Must be mono. Use write for more channels.
+   * @param[in] sampleRate The sampling rate.
+   * @return true on success.
    */
-  void clampPCM(std::vector<double>& pcm);
+  bool writeToFile(std::string fileName, const std::vector<double>& pcm,
+                   uint16_t bitsPerSample, Channel channel,
+                   uint32_t sampleRate);
 
   /**
-   * @brief Flush the buffer to the file.
+   * @brief Dither integer output. Off by default.
    *
-   * @param[in] file File path.
-   * @param[in] buffer Buffer to flush.
-   * @param[in] numBytesFlush Number of bytes to flush.
+   * @param[in] noise Noise source, or nullptr to turn dither off. Must
+   * outlive every write.
    */
-  void flushBuffer(std::ofstream& file, char* buffer, size_t& numBytesFlush);
+  inline void setDither(TPDFDither* noise) { dither = noise; }
 
   /**
-   * @brief Prepare the WAV header.
+   * @brief Build the WAV header that precedes the samples: the RIFF or RF64
+   * header, the fmt chunk, a fact chunk for float and the data chunk header.
    *
-   * @param[in] wavHeader The WAV header data struct.
-   * @param[in] dataSize The size of the PCM audio data.
-   * @param[in] bitsPerSample Bits per sample. (8, 16, 24 or 32).
-   * @param[in] channel Mono or stero channel.
+   * @param[in] format Sample encoding.
+   * @param[in] numChannels The number of channels.
+   * @param[in] numFrames The number of samples per channel.
    * @param[in] sampleRate The sampling rate.
+   * @return std::vector<uint8_t> Header bytes.
    */
-  void prepareHeader(WavHeaderData& wavHeader, uint32_t dataSize,
-                     uint16_t bitsPerSample, Channel channel,
-                     uint32_t sampleRate);
-
-  /** @brief Number of bytes per sample. */
-  uint16_t bytesPerSample{0};
+  static std::vector<uint8_t> createHeader(WAVSampleFormat format,
+                                           size_t numChannels,
+                                           uint64_t numFrames,
+                                           uint32_t sampleRate);
 
-  /** @brief fmt sub chunk size in little endian representation. */
-  uint32_t FMT_SIZE_LE{convertToLE4B(16U)};
+ private:
+  /** @brief Dither noise source. nullptr for no dither. */
+  TPDFDither* dither{nullptr};
 };
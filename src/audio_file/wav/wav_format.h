@@ -0,0 +1,51 @@
+/**
+ ******************************************************************************
+ * @file    wav_format.h
+ * @brief   WAV sample formats and header constants.
+ ******************************************************************************
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/** @brief Sample encodings of WAV files. */
+enum class WAVSampleFormat {
+  UInt8,
+  Int16,
+  Int24,
+  Int32,
+  Float32,
+  Float64,
+};
+
+/** @brief Format tag of integer PCM. */
+inline constexpr uint16_t WAVE_FORMAT_PCM = 1;
+
+/** @brief Format tag of IEEE float PCM. */
+inline constexpr uint16_t WAVE_FORMAT_IEEE_FLOAT = 3;
+
+/** @brief Format tag whose actual format is in the sub format GUID. */
+inline constexpr uint16_t WAVE_FORMAT_EXTENSIBLE = 0xFFFE;
+
+/** @brief Chunk size marking that the size is in the ds64 chunk of RF64. */
+inline constexpr uint32_t RF64_SIZE_IN_DS64 = 0xFFFFFFFF;
+
+/** @brief Bytes per sample of one channel. */
+constexpr size_t getSampleBytes(WAVSampleFormat format) {
+  switch (format) {
+    case WAVSampleFormat::UInt8:
+      return 1;
+    case WAVSampleFormat::Int16:
+      return 2;
+    case WAVSampleFormat::Int24:
+      return 3;
+    case WAVSampleFormat::Int32:
+    case WAVSampleFormat::Float32:
+      return 4;
+    case WAVSampleFormat::Float64:
+      return 8;
+  }
+  return 0;
+}
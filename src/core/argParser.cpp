@@ -7,12 +7,66 @@
 
 #include "argParser.h"
 
+#include <charconv>
+#include <cstdint>
 #include <iostream>
 
 #include "logging.h"
 
+/**
+ * @brief Parse a non negative integer argument value.
+ *
+ * @param[in] value Argument value.
+ * @param[out] out Parsed value.
+ * @return true if the whole value is a valid integer.
+ */
+static bool parseCount(std::string_view value, size_t& out) {
+  const char* end = value.data() + value.size();
+  auto [ptr, ec] = std::from_chars(value.data(), end, out);
+  return ec == std::errc() && ptr == end;
+}
+
+/**
+ * @brief Parse a non negative time in seconds.
+ *
+ * @param[in] value Argument value.
+ * @param[out] out Parsed value.
+ * @return true if the whole value is a valid non negative number.
+ */
+static bool parseSeconds(std::string_view value, double& out) {
+  const char* end = value.data() + value.size();
+  double seconds = 0.0;
+  auto [ptr, ec] = std::from_chars(value.data(), end, seconds);
+  if (ec != std::errc() || ptr != end || !(seconds >= 0.0)) {
+    return false;
+  }
+  out = seconds;
+  return true;
+}
+
+/**
+ * @brief Parse a resampler quality preset name.
+ *
+ * @param[in] value Argument value.
+ * @param[out] out Parsed preset.
+ * @return true if the value names a preset.
+ */
+static bool parseQuality(std::string_view value, ResampleQuality& out) {
+  if (value == "fast") {
+    out = ResampleQuality::Fast;
+  } else if (value == "balanced") {
+    out = ResampleQuality::Balanced;
+  } else if (value == "best") {
+    out = ResampleQuality::Best;
+  } else {
+    return false;
+  }
+  return true;
+}
+
 Arguments parseArgumnets(int argc, char* argv[]) {
   Arguments arguments{};
+  size_t rate_hz = 0;
 
   for (int i = 1; i < argc; i++) {
     std::string_view arg = argv[i];
@@ -25,6 +79,34 @@ Arguments parseArgumnets(int argc, char* argv[]) {
 
     else if (arg == "-f" && (i + 1) < argc) {
       arguments.filePath = argv[++i];
+    } else if ((arg == "-j" || arg == "--threads") && (i + 1) < argc &&
+               parseCount(argv[i + 1], arguments.numThreads)) {
+      i++;
+    } else if ((arg == "-b" || arg == "--batch") && (i + 1) < argc) {
+      arguments.batchSpec = argv[++i];
+    } else if (arg == "--jobs" && (i + 1) < argc &&
+               parseCount(argv[i + 1], arguments.numJobs)) {
+      i++;
+    } else if (arg == "--max-memory" && (i + 1) < argc &&
+               parseCount(argv[i + 1], arguments.maxMemory_mib)) {
+      i++;
+    } else if (arg == "--stereo") {
+      arguments.stereo = true;
+    } else if (arg == "--rate" && (i + 1) < argc &&
+               parseCount(argv[i + 1], rate_hz) && rate_hz <= UINT32_MAX) {
+      arguments.analysisRate_hz = static_cast<uint32_t>(rate_hz);
+      i++;
+    } else if (arg == "--quality" && (i + 1) < argc &&
+               parseQuality(argv[i + 1], arguments.resampleQuality)) {
+      i++;
+    } else if (arg == "--start" && (i + 1) < argc &&
+               parseSeconds(argv[i + 1], arguments.start_s)) {
+      i++;
+    } else if (arg == "--duration" && (i + 1) < argc &&
+               parseSeconds(argv[i + 1], arguments.duration_s)) {
+      i++;
+    } else if (arg == "--plot") {
+      arguments.plot = true;
     } else {
       arguments.action = ParseAction::ExitFailure;
       LOG_ERROR("Unknown or malformed argument: "
@@ -41,7 +123,52 @@ void displayHelp() {
   std::cout << "SwaraTone" << std::endl;
   std::cout << "\nArguments" << std::endl;
   std::cout << "=========" << std::endl;
-  std::cout << "-f <file_path>   Path to audio file to run audio decomposition."
+  std::cout << "-f <file_path>       Path to audio file to run "
+               "audio decomposition."
+            << std::endl;
+  std::cout << "-j, --threads <n>    Number of worker threads. "
+               "Defaults to the number of"
+            << std::endl;
+  std::cout << "                     cores." << std::endl;
+  std::cout << "-b, --batch <input>  Process a directory, glob "
+               "(quoted, e.g."
+            << std::endl;
+  std::cout << "                     \"music/*.mp3\") or manifest "
+               "file listing one path per"
+            << std::endl;
+  std::cout << "                     line." << std::endl;
+  std::cout << "--jobs <n>           Tracks processed at the same "
+               "time in batch mode."
+            << std::endl;
+  std::cout << "--max-memory <MiB>   Memory budget. Long tracks are "
+               "processed in chunks to fit"
+            << std::endl;
+  std::cout << "                     it. Batch jobs share the budget."
+            << std::endl;
+  std::cout << "--stereo             Write stereo stems for stereo input. "
+               "Masks are shared by"
+            << std::endl;
+  std::cout << "                     both channels." << std::endl;
+  std::cout << "--rate <Hz>          Resample the input to this rate "
+               "before the analysis. Stems"
+            << std::endl;
+  std::cout << "                     are written at it. Default "
+            << SAMPLE_RATE << ", 0 keeps the input rate." << std::endl;
+  std::cout << "                     A lower rate runs faster." << std::endl;
+  std::cout << "--quality <preset>   Resampler filter: fast, balanced "
+               "(default) or best."
+            << std::endl;
+  std::cout << "--start <seconds>    Separate the track from this time on. "
+               "Only the selected"
+            << std::endl;
+  std::cout << "                     part is decoded." << std::endl;
+  std::cout << "--duration <seconds> Length of the part to separate. "
+               "Defaults to the rest of"
+            << std::endl;
+  std::cout << "                     the track." << std::endl;
+  std::cout << "--plot               Save a spectrogram of the input as a "
+               "PNG. Only in builds"
             << std::endl;
+  std::cout << "                     with BUILD_VIZ=ON." << std::endl;
   std::cout << std::endl;
 }
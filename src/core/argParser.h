@@ -7,8 +7,13 @@
 
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
 
+#include "constants.h"
+#include "resampler.h"
+
 /** @brief Argument parsing action status. */
 enum ParseAction { Continue, ExitSuccess, ExitFailure };
 
@@ -19,6 +24,36 @@ struct Arguments {
 
   /** @brief File path to audio file. */
   std::string filePath{"sample.mp3"};
+
+  /** @brief Number of worker threads. 0 uses the hardware concurrency. */
+  size_t numThreads{0};
+
+  /** @brief Batch input: directory, glob or manifest. Empty for one file. */
+  std::string batchSpec{};
+
+  /** @brief Tracks processed at the same time in batch mode. 0 is automatic. */
+  size_t numJobs{0};
+
+  /** @brief Memory budget in MiB. 0 means no limit. */
+  size_t maxMemory_mib{0};
+
+  /** @brief True to write stereo stems for stereo input. */
+  bool stereo{false};
+
+  /** @brief Sample rate of the analysis in Hz. 0 keeps the input rate. */
+  uint32_t analysisRate_hz{SAMPLE_RATE};
+
+  /** @brief Filter of the conversion to the analysis rate. */
+  ResampleQuality resampleQuality{ResampleQuality::Balanced};
+
+  /** @brief Start of the part to separate in seconds. */
+  double start_s{0.0};
+
+  /** @brief Length of the part to separate in seconds. 0 runs to the end. */
+  double duration_s{0.0};
+
+  /** @brief True to save a spectrogram plot of the input. Needs BUILD_VIZ. */
+  bool plot{false};
 };
 
 /**
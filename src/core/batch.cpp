@@ -0,0 +1,330 @@
+/**
+ *******************************************************************************
+ * @file    batch.cpp
+ * @brief   Batch processing source.
+ *******************************************************************************
+ */
+
+#include "batch.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <thread>
+
+#include "coreLogic.h"
+#include "logging.h"
+#include "threadPool.h"
+
+namespace fs = std::filesystem;
+
+/** @brief Result of one file of a batch. */
+struct BatchResult {
+  bool ok{false};
+  CoreRunStats stats{};
+  double total_ms{0.0};
+};
+
+/**
+ * @brief Shared byte budget. Jobs reserve their estimated memory before
+ * running and give it back when done.
+ */
+class MemoryBudget {
+ public:
+  explicit MemoryBudget(size_t capacity) : capacity(capacity) {}
+
+  /**
+   * @brief Wait until bytes fit in the budget and reserve them.
+   *
+   * @param[in] bytes Bytes wanted. Clamped to the whole budget.
+   * @return size_t Bytes reserved, to be passed to release.
+   */
+  size_t acquire(size_t bytes) {
+    if (capacity == 0) {
+      return 0;
+    }
+
+    bytes = std::min(bytes, capacity);
+    std::unique_lock<std::mutex> lock(mutex);
+    freed.wait(lock, [&]() { return used + bytes <= capacity; });
+    used += bytes;
+    return bytes;
+  }
+
+  /** @brief Return bytes reserved by acquire. */
+  void release(size_t bytes) {
+    if (bytes == 0) {
+      return;
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      used -= bytes;
+    }
+    freed.notify_all();
+  }
+
+ private:
+  const size_t capacity;
+  size_t used{0};
+  std::mutex mutex{};
+  std::condition_variable freed{};
+};
+
+/** @brief True if path has a .mp3 or .wav extension, ignoring case. */
+static bool isAudioFile(const fs::path& path) {
+  std::string ext = path.extension().string();
+  std::transform(ext.begin(), ext.end(), ext.begin(),
+                 [](unsigned char c) { return std::tolower(c); });
+  return ext == ".mp3" || ext == ".wav";
+}
+
+/** @brief Regular files in dir accepted by keep, sorted by path. */
+template <typename Keep>
+static std::vector<std::string> listFiles(const fs::path& dir, Keep keep) {
+  std::vector<std::string> files{};
+  std::error_code ec;
+
+  for (const fs::directory_entry& entry : fs::directory_iterator(dir, ec)) {
+    if (entry.is_regular_file() && keep(entry.path())) {
+      files.push_back(entry.path().string());
+    }
+  }
+  if (ec) {
+    LOG_ERROR("Could not list directory " << dir.string() << ": "
+                                          << ec.message());
+  }
+
+  std::sort(files.begin(), files.end());
+  return files;
+}
+
+/** @brief Read the paths listed in a manifest file. */
+static std::vector<std::string> readManifest(const fs::path& manifest) {
+  std::vector<std::string> files{};
+  std::ifstream file(manifest);
+  if (!file.is_open()) {
+    LOG_ERROR("Could not open batch manifest " << manifest.string());
+    return files;
+  }
+
+  const fs::path base = manifest.parent_path();
+  std::string line;
+  while (std::getline(file, line)) {
+    // Trim surrounding whitespace, including a Windows line ending.
+    const size_t first = line.find_first_not_of(" \t\r");
+    if (first == std::string::npos || line[first] == '#') {
+      continue;
+    }
+    const size_t last = line.find_last_not_of(" \t\r");
+    fs::path path = line.substr(first, last - first + 1);
+
+    files.push_back(path.is_relative() ? (base / path).string()
+                                       : path.string());
+  }
+
+  return files;
+}
+
+std::vector<std::string> collectBatchInputs(const std::string& spec) {
+  const fs::path path(spec);
+  std::error_code ec;
+
+  if (fs::is_directory(path, ec)) {
+    return listFiles(path, isAudioFile);
+  }
+
+  const std::string pattern = path.filename().string();
+  if (pattern.find_first_of("*?") != std::string::npos) {
+    fs::path dir = path.parent_path();
+    return listFiles(dir.empty() ? fs::path(".") : dir,
+                     [&](const fs::path& file) {
+                       return matchWildcard(pattern, file.filename().string());
+                     });
+  }
+
+  return readManifest(path);
+}
+
+bool matchWildcard(std::string_view pattern, std::string_view name) {
+  size_t p = 0;
+  size_t n = 0;
+
+  // Position after the last '*' and the name position it was tried at, so a
+  // mismatch can retry with the star covering one more character.
+  size_t starP = std::string_view::npos;
+  size_t starN = 0;
+
+  while (n < name.size()) {
+    if (p < pattern.size() && (pattern[p] == '?' || pattern[p] == name[n])) {
+      p++;
+      n++;
+    } else if (p < pattern.size() && pattern[p] == '*') {
+      starP = ++p;
+      starN = n;
+    } else if (starP != std::string_view::npos) {
+      p = starP;
+      n = ++starN;
+    } else {
+      return false;
+    }
+  }
+
+  while (p < pattern.size() && pattern[p] == '*') {
+    p++;
+  }
+  return p == pattern.size();
+}
+
+/**
+ * @brief Process one file of the batch within the memory budget.
+ *
+ * The stems are written by the shared writer while the job moves on to the
+ * next file. The reservation is held until they are written, so pending
+ * outputs count against the budget and slow down new jobs.
+ *
+ * @param[in] file Input file.
+ * @param[in] budget Memory budget shared by the jobs.
+ * @param[in] options Run settings of the track.
+ * @param[in] writer Output writer shared by the jobs.
+ * @param[out] writeOk Set once the stems are written, to whether all were.
+ * @return BatchResult Result of the processing, without the writes.
+ */
+static BatchResult runJob(const std::string& file, MemoryBudget& budget,
+                          const CoreOptions& options, OutputWriter& writer,
+                          std::atomic<bool>& writeOk) {
+  BatchResult result{};
+  auto start = std::chrono::steady_clock::now();
+
+  // Opening only reads the headers. Samples are decoded by the pipeline.
+  std::unique_ptr<AudioStream> stream = openAudioStream(file);
+  if (stream) {
+    // A track too large for the whole budget is processed in chunks that fit
+    // it, and runs alone.
+    size_t reserved = budget.acquire(
+        estimateRunMemory(getNumAnalysisSamples(*stream, options),
+                          getNumOutputChannels(*stream, options)));
+    result.ok = processTrack(
+        *stream, file, &result.stats, options, nullptr, &writer,
+        [&budget, &writeOk, reserved](bool ok) {
+          writeOk = ok;
+          budget.release(reserved);
+        });
+  }
+
+  result.total_ms = std::chrono::duration<double, std::milli>(
+                        std::chrono::steady_clock::now() - start)
+                        .count();
+  return result;
+}
+
+/** @brief Quote a CSV field, doubling the quotes inside it. */
+static std::string quoteCsv(const std::string& field) {
+  std::string quoted = "\"";
+  for (char c : field) {
+    if (c == '"') {
+      quoted += '"';
+    }
+    quoted += c;
+  }
+  return quoted + '"';
+}
+
+/** @brief Write the per file timings as CSV. */
+static void writeSummary(const std::string& path,
+                         const std::vector<std::string>& files,
+                         const std::vector<BatchResult>& results) {
+  std::ofstream summary(path);
+  if (!summary.is_open()) {
+    LOG_ERROR("Could not write batch summary " << path);
+    return;
+  }
+
+  summary << "file,status,samples,decode_ms,process_ms,critical_path_ms,"
+             "total_ms,estimated_mib\n";
+  for (size_t i = 0; i < files.size(); i++) {
+    const BatchResult& result = results[i];
+    summary << quoteCsv(files[i]) << ',' << (result.ok ? "ok" : "failed")
+            << ',' << result.stats.numSamples << ','
+            << result.stats.decode_ms << ',' << result.stats.process_ms << ','
+            << result.stats.criticalPath_ms << ',' << result.total_ms << ','
+            << (result.stats.estimatedBytes >> 20) << '\n';
+  }
+}
+
+bool runBatch(const std::vector<std::string>& files,
+              const BatchOptions& options) {
+  if (files.empty()) {
+    LOG_ERROR("Batch has no input files.");
+    return false;
+  }
+
+  // Job threads work on the pool while they wait on it, so the pool gets
+  // whatever part of the thread budget the jobs do not take.
+  const size_t numThreads = options.numThreads > 0 ? options.numThreads
+                                                   : getDefaultNumThreads();
+  size_t numJobs = options.numJobs > 0 ? options.numJobs
+                                       : std::max<size_t>(1, numThreads / 4);
+  numJobs = std::min(numJobs, files.size());
+  setThreadPoolSize(numThreads > numJobs ? numThreads - numJobs + 1 : 1);
+
+  LOG_INFO("Batch: " << files.size() << " files, " << numJobs << " jobs, "
+                     << numThreads << " threads.");
+
+  MemoryBudget budget(options.maxMemoryBytes);
+  OutputWriter writer(options.maxMemoryBytes > 0 ? options.maxMemoryBytes
+                                                 : DEFAULT_OUTPUT_QUEUE_BYTES);
+  CoreOptions coreOptions{};
+  coreOptions.maxMemoryBytes = options.maxMemoryBytes;
+  coreOptions.stereo = options.stereo;
+  coreOptions.analysisRate = options.analysisRate;
+  coreOptions.resampleQuality = options.resampleQuality;
+  coreOptions.start_s = options.start_s;
+  coreOptions.duration_s = options.duration_s;
+  std::vector<BatchResult> results(files.size());
+  std::vector<std::atomic<bool>> writeOk(files.size());
+  std::atomic<size_t> nextFile{0};
+  auto start = std::chrono::steady_clock::now();
+
+  auto jobLoop = [&]() {
+    size_t i;
+    while ((i = nextFile.fetch_add(1)) < files.size()) {
+      LOG_INFO("Batch: processing " << files[i]);
+      results[i] = runJob(files[i], budget, coreOptions, writer, writeOk[i]);
+    }
+  };
+
+  std::vector<std::thread> jobs{};
+  jobs.reserve(numJobs - 1);
+  for (size_t j = 1; j < numJobs; j++) {
+    jobs.emplace_back(jobLoop);
+  }
+  jobLoop();
+  for (std::thread& job : jobs) {
+    job.join();
+  }
+  writer.wait();
+  for (size_t i = 0; i < files.size(); i++) {
+    results[i].ok = results[i].ok && writeOk[i];
+  }
+
+  const double wall_ms = std::chrono::duration<double, std::milli>(
+                             std::chrono::steady_clock::now() - start)
+                             .count();
+
+  writeSummary(options.summaryPath, files, results);
+
+  size_t numFailed = std::count_if(
+      results.begin(), results.end(),
+      [](const BatchResult& result) { return !result.ok; });
+  LOG_INFO("Batch: " << files.size() - numFailed << " of " << files.size()
+                     << " files done in " << wall_ms
+                     << " ms. Summary written to " << options.summaryPath);
+
+  return numFailed == 0;
+}
@@ -0,0 +1,93 @@
+/**
+ *******************************************************************************
+ * @file    batch.h
+ * @brief   Batch processing header.
+ *******************************************************************************
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "constants.h"
+#include "resampler.h"
+
+/** @brief Settings of a batch run. */
+struct BatchOptions {
+  /** @brief Tracks processed at the same time. 0 picks from numThreads. */
+  size_t numJobs{0};
+
+  /** @brief Threads shared by every job. 0 uses the hardware concurrency. */
+  size_t numThreads{0};
+
+  /**
+   * @brief Estimated bytes the running jobs may use together. A job waits
+   * until its estimate fits. A job larger than the whole budget runs alone,
+   * in chunks sized to the budget. 0 means no limit.
+   */
+  size_t maxMemoryBytes{0};
+
+  /** @brief Write stereo stems for stereo input. See CoreOptions. */
+  bool stereo{false};
+
+  /** @brief Sample rate of the analysis. See CoreOptions. */
+  uint32_t analysisRate{SAMPLE_RATE};
+
+  /** @brief Filter of the conversion to analysisRate. */
+  ResampleQuality resampleQuality{ResampleQuality::Balanced};
+
+  /** @brief Start of the part of each track to separate, in seconds. */
+  double start_s{0.0};
+
+  /** @brief Length of the part to separate in seconds. 0 runs to the end. */
+  double duration_s{0.0};
+
+  /** @brief Path of the per file timing summary (CSV). */
+  std::string summaryPath{"batch_summary.csv"};
+};
+
+/**
+ * @brief Expand a batch input specification into a list of files.
+ *
+ * The specification is one of:
+ * - a directory: every .mp3 and .wav file in it.
+ * - a glob: a path whose file name contains '*' or '?', such as every .mp3
+ *   file of a music directory.
+ * - a manifest: a text file listing one path per line. Empty lines and lines
+ *   starting with '#' are skipped. Relative paths are relative to the
+ *   manifest.
+ *
+ * @param[in] spec Directory, glob or manifest path.
+ * @return std::vector<std::string> Files in sorted order for directories and
+ * globs, and in listed order for manifests. Empty on error.
+ */
+std::vector<std::string> collectBatchInputs(const std::string& spec);
+
+/**
+ * @brief Match a file name against a pattern where '*' matches any run of
+ * characters and '?' matches one character.
+ *
+ * @param[in] pattern Wildcard pattern.
+ * @param[in] name File name.
+ * @return true if the whole name matches.
+ */
+bool matchWildcard(std::string_view pattern, std::string_view name);
+
+/**
+ * @brief Run the core logic on every file, several files at a time.
+ *
+ * Jobs share the process wide thread pool, FFT plans, window tables and memory
+ * pool, so nothing is set up again per file. Must be called before the thread
+ * pool is first used, since it sizes the pool to leave room for the job
+ * threads within the thread budget.
+ *
+ * @param[in] files Input files.
+ * @param[in] options Batch settings.
+ * @return true if every file was processed.
+ */
+bool runBatch(const std::vector<std::string>& files,
+              const BatchOptions& options);
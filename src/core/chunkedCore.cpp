@@ -0,0 +1,83 @@
+/**
+ *******************************************************************************
+ * @file    chunkedCore.cpp
+ * @brief   Chunked stem separation source.
+ *******************************************************************************
+ */
+
+#include "chunkedCore.h"
+
+#include <algorithm>
+
+#include "constants.h"
+#include "coreLogic.h"
+#include "fft_helper.hpp"
+#include "hpss.h"
+#include "logging.h"
+#include "spectrum.h"
+#include "splitComplexMatrix.hpp"
+
+static_assert(CHUNK_CONTEXT_FRAMES >= HMEDIAN_OFFSET,
+              "Chunk context must cover the harmonic median filter.");
+
+size_t planChunkFrames(size_t numSamples, size_t maxMemoryBytes) {
+  // Each chunk also holds a copy of its input samples.
+  const size_t frameBytes = estimateFrameMemory() + HOP_SIZE * sizeof(double);
+  const size_t trackBytes = estimateTrackMemory(numSamples);
+  const size_t minBytes =
+      trackBytes +
+      (MIN_CHUNK_FRAMES + 2 * CHUNK_CONTEXT_FRAMES) * frameBytes / 4 * 5;
+
+  if (maxMemoryBytes < minBytes) {
+    LOG_WARNING("Memory budget of " << (maxMemoryBytes >> 20)
+                                    << " MiB is too small. Using "
+                                    << (minBytes >> 20) << " MiB.");
+    return MIN_CHUNK_FRAMES;
+  }
+
+  // The memory pool rounds large blocks up to a size class, which costs up to
+  // a fifth of each chunk matrix.
+  const size_t chunkBytes = (maxMemoryBytes - trackBytes) / 5 * 4;
+  return std::max(MIN_CHUNK_FRAMES,
+                  chunkBytes / frameBytes - 2 * CHUNK_CONTEXT_FRAMES);
+}
+
+void separateStemsChunked(const AlignedVector<double>& input, size_t numFrames,
+                          size_t chunkFrames,
+                          const std::vector<StemBlend>& blends,
+                          std::vector<std::vector<double>>& stems) {
+  const size_t numChunks = (numFrames + chunkFrames - 1) / chunkFrames;
+  LOG_INFO("Processing " << numFrames << " frames in " << numChunks
+                         << " chunks of " << chunkFrames << " frames.");
+
+  // Emits the stems as chunks finish, so no whole track overlap-add buffers.
+  StemSynthesizer synthesizer(numFrames, 2, blends, stems);
+
+  // Reused by every chunk.
+  AlignedVector<double> chunkInput{};
+  SplitComplexMatrix complexSpectrum{};
+  Matrix<double> powerSpectrum{};
+  Matrix<double> hMask{};
+  Matrix<double> pMask{};
+
+  for (size_t coreStart = 0; coreStart < numFrames; coreStart += chunkFrames) {
+    const size_t coreEnd = std::min(numFrames, coreStart + chunkFrames);
+    const size_t first =
+        coreStart > CHUNK_CONTEXT_FRAMES ? coreStart - CHUNK_CONTEXT_FRAMES : 0;
+    const size_t last = std::min(numFrames, coreEnd + CHUNK_CONTEXT_FRAMES);
+    const size_t n = last - first;
+
+    // Samples read by frames [first, last).
+    auto samples = input.begin() + first * HOP_SIZE;
+    chunkInput.assign(samples, samples + (n - 1) * HOP_SIZE + WINDOW_SIZE);
+
+    createSpectra(chunkInput, n, {&complexSpectrum, &powerSpectrum});
+    createHPSSMasks(powerSpectrum, hMask, pMask, true);
+
+    // Only the chunk's own frames; context frames belong to its neighbours.
+    synthesizer.addFrames(complexSpectrum, {&hMask, &pMask}, coreStart - first,
+                          coreEnd - first);
+  }
+
+  synthesizer.finish();
+}
@@ -0,0 +1,57 @@
+/**
+ *******************************************************************************
+ * @file    chunkedCore.h
+ * @brief   Chunked stem separation header.
+ *******************************************************************************
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "alignedAllocator.hpp"
+#include "signalReconstruction.h"
+
+/**
+ * @brief Frames of context read on each side of a chunk. Enough for the
+ * harmonic median filter.
+ */
+inline constexpr size_t CHUNK_CONTEXT_FRAMES = 64;
+
+/** @brief Smallest chunk, so the context stays a small part of each chunk. */
+inline constexpr size_t MIN_CHUNK_FRAMES = 256;
+
+/**
+ * @brief Pick the number of frames per chunk so every intermediate of a run
+ * fits in a memory budget.
+ *
+ * @param[in] numSamples The number of samples per channel of the input.
+ * @param[in] maxMemoryBytes Memory budget.
+ * @return size_t Frames per chunk, excluding context. At least
+ * MIN_CHUNK_FRAMES, even if that exceeds the budget.
+ */
+size_t planChunkFrames(size_t numSamples, size_t maxMemoryBytes);
+
+/**
+ * @brief Separate the harmonic and percussive stems chunk by chunk.
+ *
+ * Each chunk of frames is transformed together with CHUNK_CONTEXT_FRAMES
+ * frames on each side and runs through the HPSS masks. Only its own frames are
+ * overlap-added, by a StemSynthesizer that emits the finished samples straight
+ * into the stems. Spectrum frames and HPSS masks away from the context edges
+ * do not depend on the rest of the track, so the stems match an unchunked run
+ * up to rounding. Only one chunk of spectra and synthesis buffers is held at a
+ * time.
+ *
+ * @param[in] input Padded input signal.
+ * @param[in] numFrames The number of frames of the whole input.
+ * @param[in] chunkFrames Frames per chunk, excluding context.
+ * @param[in] blends Stems to build as weighted sums of the harmonic and
+ * percussive stems.
+ * @param[out] stems Harmonic and percussive stems, followed by one per blend.
+ */
+void separateStemsChunked(const AlignedVector<double>& input, size_t numFrames,
+                          size_t chunkFrames,
+                          const std::vector<StemBlend>& blends,
+                          std::vector<std::vector<double>>& stems);
@@ -7,101 +7,530 @@
 
 #include "coreLogic.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
 #include <filesystem>
+#include <memory>
 
+#include "chunkedCore.h"
 #include "constants.h"
 #include "fft_helper.hpp"
 #include "highPass.h"
 #include "hpss.h"
 #include "matrix.hpp"
-#include "mp3.h"
-#include "plot.h"
-#include "repet.h"
+#include "memoryPool.h"
+#include "rangeStream.h"
+#include "resampledStream.h"
 #include "signalReconstruction.h"
+#include "splitComplexMatrix.hpp"
 #include "spectrum.h"
-#include "wav_encoding.h"
-
-void runCore(std::string filePath) {
-  // Read audio input from MP3 file.
-  MP3Data mp3Data = readMP3File(filePath);
-
-  // Determine size of spectrums. Input will include padding for smoothness.
-  const size_t numFreqBins = getNyquistSize(WINDOW_SIZE);
-  const size_t numWindows = (mp3Data.numSamples / HOP_SIZE) + 1;
-  const size_t r = numWindows;
-  const size_t c = numFreqBins;
-
-  // Pad input.
-  std::vector<double> input(mp3Data.numSamples + PADDING_SIZE * 2, 0.0);
-  createInput(mp3Data, input);
-
-  // Compute complex and power spectrum.
-  LOG_INFO("Creating complex and power spectrum.");
-  Matrix<std::complex<double>> complexSpectrum{r, c};
-  Matrix<double> powerSpectrum{r, c};
-  Matrix<double> magnitudeSpectrum{r, c};
-  createComplexSpectrum(input, complexSpectrum);
-
-  // TODO: we can combine the following into the same function.
-  createPowerSpectrum(complexSpectrum, powerSpectrum);
-  createMagnitudeSpectrum(complexSpectrum, magnitudeSpectrum);
-
-  // Apply REPET.
-  Matrix<std::complex<double>> maskedX =
-      runRepet(magnitudeSpectrum, powerSpectrum, complexSpectrum);
-
-  // Apply HPSS.
-  Matrix<std::complex<double>> hComplexSpectrum{};
-  Matrix<std::complex<double>> pComplexSpectrum{};
-  runHPSS(complexSpectrum, powerSpectrum, hComplexSpectrum, pComplexSpectrum);
-
-  // Reconstruct signals.
-  LOG_INFO("Reconstructing signals.");
-  std::vector<double> harmonics{};
-  std::vector<double> percussive{};
-  std::vector<double> vocals{};
-  std::vector<double> vocalsFiltered{};
-  reconstructSignal(hComplexSpectrum, harmonics);
-  reconstructSignal(pComplexSpectrum, percussive);
-
-  Matrix<std::complex<double>> vComplexSpectrum =
-      hComplexSpectrum.scale(0.8) + pComplexSpectrum.scale(0.2);
-  reconstructSignal(vComplexSpectrum, vocals);
-
-  digitalHighPass(vocals, vocalsFiltered, VOICE_CUTOFF_HZ,
-                  static_cast<double>(mp3Data.sampleRate_hz));
-
-  // Save signals to audio file.
-  LOG_INFO("Saving signals to audio");
-  WAVFileEncoder wavEncoder{};
-  std::string fileSuffix = std::filesystem::path(filePath).stem().string();
-  wavEncoder.writeToFile("harmonics_" + fileSuffix, harmonics, BITS_PER_SAMPLE,
-                         Channel::Mono, mp3Data.sampleRate_hz);
-  wavEncoder.writeToFile("percussive_" + fileSuffix, percussive,
-                         BITS_PER_SAMPLE, Channel::Mono, mp3Data.sampleRate_hz);
-  wavEncoder.writeToFile("vocals_" + fileSuffix, vocalsFiltered,
-                         BITS_PER_SAMPLE, Channel::Mono, mp3Data.sampleRate_hz);
+#include "taskGraph.h"
+#include "threadPool.h"
+
+/** @brief Output files of one track, until all of them are written. */
+struct TrackOutputs {
+  /**
+   * @brief Files queued and not yet written, plus one held by the pipeline
+   * until it has queued every file.
+   */
+  std::atomic<size_t> numPending{1};
+
+  /** @brief False once a file fails. */
+  std::atomic<bool> ok{true};
+
+  /** @brief Called once nothing is pending. */
+  OutputCallback onWritten{};
+
+  /** @brief Record one finished file, or the end of the pipeline. */
+  void finish(bool fileOk) {
+    if (!fileOk) {
+      ok = false;
+    }
+    if (numPending.fetch_sub(1) == 1 && onWritten) {
+      onWritten(ok);
+    }
+  }
+};
+
+/**
+ * @brief Samples decoded on each side of a time range: the STFT window plus
+ * the frames the median filters see around each frame, as for chunks.
+ */
+static const size_t RANGE_CONTEXT_SAMPLES =
+    CHUNK_CONTEXT_FRAMES * HOP_SIZE + WINDOW_SIZE;
+
+/** @brief Part of a track that is decoded and part that is written. */
+struct InputRange {
+  /** @brief First sample written. */
+  size_t first{0};
+
+  /** @brief The number of samples written. */
+  size_t count{0};
+
+  /** @brief First sample decoded, including context. */
+  size_t decodeFirst{0};
+
+  /** @brief The number of samples decoded, including context. */
+  size_t decodeCount{0};
+};
+
+/** @brief Samples of the stems that are written. */
+struct OutputRange {
+  /** @brief First sample written. */
+  size_t first{0};
+
+  /** @brief The number of samples written. Clamped to the stems. */
+  size_t count{SIZE_MAX};
+};
+
+/** @brief The range of a stream selected by the start and duration options. */
+static InputRange getInputRange(const AudioStream& stream,
+                                const CoreOptions& options) {
+  const size_t numSamples = stream.getNumSamples();
+  const double sampleRate = static_cast<double>(stream.getSampleRate());
+  InputRange range{0, numSamples, 0, numSamples};
+  if (options.start_s <= 0.0 && options.duration_s <= 0.0) {
+    return range;
+  }
+
+  const double start = std::max(options.start_s, 0.0) * sampleRate;
+  range.first = std::min(numSamples, static_cast<size_t>(std::llround(start)));
+  range.count = numSamples - range.first;
+  if (options.duration_s > 0.0) {
+    const double duration = options.duration_s * sampleRate;
+    range.count =
+        std::min(range.count, static_cast<size_t>(std::llround(duration)));
+  }
+
+  range.decodeFirst =
+      range.first - std::min(range.first, RANGE_CONTEXT_SAMPLES);
+  const size_t decodeEnd =
+      range.first + range.count +
+      std::min(numSamples - range.first - range.count, RANGE_CONTEXT_SAMPLES);
+  range.decodeCount = decodeEnd - range.decodeFirst;
+  return range;
+}
+
+/**
+ * @brief Queue a signal to be written to a WAV file.
+ *
+ * @param[in] writer Output writer.
+ * @param[in] outputs Output files of the track.
+ * @param[in] fileName File name without extension.
+ * @param[in,out] channels Samples of each channel. Moved to the writer.
+ * @param[in] sampleRate The sampling rate.
+ * @param[in] range Samples of each channel to write.
+ */
+static void writeSignal(OutputWriter& writer,
+                        const std::shared_ptr<TrackOutputs>& outputs,
+                        const std::string& fileName,
+                        const std::vector<std::vector<double>*>& channels,
+                        uint32_t sampleRate, const OutputRange& range) {
+  OutputFile file{};
+  file.path = fileName + ".wav";
+  for (std::vector<double>* channel : channels) {
+    const size_t first = std::min(range.first, channel->size());
+    const size_t count = std::min(range.count, channel->size() - first);
+    channel->erase(channel->begin(), channel->begin() + first);
+    channel->resize(count);
+    file.channels.push_back(std::move(*channel));
+  }
+  file.sampleRate = sampleRate;
+  file.onWritten = [outputs](bool ok) { outputs->finish(ok); };
+
+  outputs->numPending++;
+  writer.submit(std::move(file));
+}
+
+/** @brief Name of a per channel stage or buffer. Mono keeps the plain name. */
+static std::string getChannelName(const std::string& name, size_t channel,
+                                  size_t numChannels) {
+  if (numChannels == 1) {
+    return name;
+  }
+  return name + (channel == 0 ? " left" : " right");
+}
+
+bool runCore(std::string filePath, CoreRunStats* stats,
+             const CoreOptions& options, const SpectrumCallback& onSpectrum) {
+  // The file is decoded while the pipeline runs.
+  std::unique_ptr<AudioStream> stream = openAudioStream(filePath);
+  if (!stream) {
+    return false;
+  }
+
+  return processTrack(*stream, filePath, stats, options, onSpectrum);
+}
+
+/**
+ * @brief Run the decomposition pipeline on a stream that is already at the
+ * analysis rate. See processTrack.
+ *
+ * @param[in] range Samples of the stems to write.
+ */
+static bool runPipeline(AudioStream& stream, const std::string& filePath,
+                        CoreRunStats* stats, const CoreOptions& options,
+                        const SpectrumCallback& onSpectrum,
+                        OutputWriter* writer, const OutputCallback& onWritten,
+                        const OutputRange& range) {
+  const size_t numSamples = stream.getNumSamples();
+  if (numSamples == 0) {
+    LOG_ERROR("No audio decoded from " << filePath);
+    if (onWritten) {
+      onWritten(false);
+    }
+    return false;
+  }
+
+  // Stems are encoded and written on the writer thread. Without a shared
+  // writer the track waits for its own before returning.
+  std::unique_ptr<OutputWriter> ownWriter{};
+  if (writer == nullptr) {
+    ownWriter = std::make_unique<OutputWriter>();
+    writer = ownWriter.get();
+  }
+  auto outputs = std::make_shared<TrackOutputs>();
+  outputs->onWritten = onWritten;
+
+  // Determine number of frames. Input will include padding for smoothness.
+  const size_t r = (numSamples / HOP_SIZE) + 1;
+  const size_t inputSize = numSamples + PADDING_SIZE * 2;
+  const double sampleRate = static_cast<double>(stream.getSampleRate());
+  const uint32_t outputRate = static_cast<uint32_t>(stream.getSampleRate());
+  const std::string fileSuffix =
+      std::filesystem::path(filePath).stem().string();
+
+  // Harmonics, percussive and their vocal blend.
+  const std::vector<StemBlend> blends{StemBlend{{0.8, 0.2}}};
+
+  // Split the track into chunks if a whole run would not fit the budget.
+  // Chunks are only separated in mono.
+  const size_t maxMemoryBytes = options.maxMemoryBytes;
+  size_t numChannels = getNumOutputChannels(stream, options);
+  size_t chunkFrames = 0;
+  if (maxMemoryBytes > 0 &&
+      estimateRunMemory(numSamples, numChannels) > maxMemoryBytes) {
+    if (numChannels > 1) {
+      LOG_WARNING("Stereo separation does not fit the memory budget. Writing "
+                  "mono stems.");
+      numChannels = 1;
+    }
+    if (estimateRunMemory(numSamples) > maxMemoryBytes) {
+      chunkFrames = planChunkFrames(numSamples, maxMemoryBytes);
+    }
+  }
+
+  // Intermediates live in the memory pool, so the blocks of spent buffers are
+  // reused by later stages.
+  getMemoryPool().resetPeak();
+
+  // Mono runs only use the first entry of the per channel buffers.
+  AlignedVector<double> input{};
+  AlignedVector<double> rightInput{};
+  SplitComplexMatrix complexSpectrum{};
+  SplitComplexMatrix rightSpectrum{};
+  Matrix<double> powerSpectrum{};
+  Matrix<double> hMask{};
+  Matrix<double> pMask{};
+  std::vector<std::vector<std::vector<double>>> stems(numChannels);
+  std::vector<std::vector<double>> vocalsFiltered(numChannels);
+
+  // Each buffer is released once the last stage reading it is done.
+  TaskGraph graph{};
+  std::vector<TaskGraph::BufferId> stemsBufs{};
+  std::vector<TaskGraph::BufferId> vocalsBufs{};
+  for (size_t ch = 0; ch < numChannels; ch++) {
+    stemsBufs.push_back(
+        graph.addBuffer(getChannelName("stems", ch, numChannels)));
+    vocalsBufs.push_back(
+        graph.addBuffer(getChannelName("vocals filtered", ch, numChannels)));
+  }
+
+  // A mono run either decodes the whole track on the pool and then runs the
+  // STFT, or decodes block by block on one thread while the STFT of complete
+  // frames runs on the pool. The first spreads the decode, usually the longer
+  // step, over every thread but holds the whole padded track. The second
+  // overlaps decode and STFT and only holds a window of samples. Stream
+  // unless the decode can actually be spread, and whenever a memory budget
+  // asks for the lower peak.
+  const bool useParallelDecode = stream.hasParallelRead() &&
+                                 getThreadPool().getNumThreads() > 1 &&
+                                 maxMemoryBytes == 0;
+
+  if (chunkFrames == 0) {
+    const auto complexBuf = graph.addBuffer(
+        "complex", [&]() { complexSpectrum = SplitComplexMatrix{}; });
+    const auto powerBuf = graph.addBuffer(
+        "power", [&]() { powerSpectrum = Matrix<double>{}; });
+    const auto masksBuf = graph.addBuffer("hpss masks", [&]() {
+      hMask = Matrix<double>{};
+      pMask = Matrix<double>{};
+    });
+    TaskGraph::BufferId rightComplexBuf = complexBuf;
+
+    if (numChannels > 1) {
+      rightComplexBuf = graph.addBuffer(
+          "complex right", [&]() { rightSpectrum = SplitComplexMatrix{}; });
+      // Both channels go through the STFT, but the masks are computed once
+      // from their mean power and shared, which keeps the stereo image.
+      const auto inputBuf = graph.addBuffer("input", [&]() {
+        AlignedVector<double>().swap(input);
+        AlignedVector<double>().swap(rightInput);
+      });
+      graph.addStage("decode", {}, {inputBuf}, [&]() {
+        input.assign(inputSize, 0.0);
+        rightInput.assign(inputSize, 0.0);
+        stream.readStereo(input.data() + PADDING_SIZE,
+                          rightInput.data() + PADDING_SIZE, numSamples);
+      });
+
+      graph.addStage(
+          "spectra", {inputBuf},
+          {complexBuf, rightComplexBuf, powerBuf}, [&]() {
+            LOG_INFO("Creating stereo complex and power spectrum.");
+            createStereoSpectra(input, rightInput, r, complexSpectrum,
+                                rightSpectrum, powerSpectrum);
+          });
+    } else if (useParallelDecode) {
+      // Decode segments of the track on every thread, then run the STFT.
+      const auto inputBuf = graph.addBuffer(
+          "input", [&]() { AlignedVector<double>().swap(input); });
+      graph.addStage("decode", {}, {inputBuf}, [&]() {
+        input.assign(inputSize, 0.0);
+        stream.readAllMonoParallel(input.data() + PADDING_SIZE,
+                                   getThreadPool());
+      });
+
+      // Complex and power spectrum come from a single pass.
+      graph.addStage("spectra", {inputBuf}, {complexBuf, powerBuf}, [&]() {
+        LOG_INFO("Creating complex and power spectrum.");
+        createSpectra(input, r, {&complexSpectrum, &powerSpectrum});
+      });
+    } else {
+      // Decode block by block while the frames already complete go through
+      // the STFT. Complex and power spectrum come from a single pass.
+      graph.addStage("decode spectra", {}, {complexBuf, powerBuf}, [&]() {
+        LOG_INFO("Creating complex and power spectrum.");
+        createSpectraStreamed(numSamples, {&complexSpectrum, &powerSpectrum},
+                              [&](double* out, size_t maxSamples) {
+                                return stream.readMono(out, maxSamples);
+                              });
+      });
+    }
+
+    if (onSpectrum) {
+      graph.addStage("spectrum callback", {complexBuf}, {},
+                     [&]() { onSpectrum(complexSpectrum); });
+    }
+
+    graph.addStage("hpss masks", {powerBuf}, {masksBuf}, [&]() {
+      // Create HPSS masks. They are applied while reconstructing each stem.
+      LOG_INFO("Running HPSS.");
+      createHPSSMasks(powerSpectrum, hMask, pMask, true);
+    });
+
+    // Reconstruct harmonics, percussive and their vocal blend in one pass
+    // per channel.
+    const SplitComplexMatrix* spectra[] = {&complexSpectrum, &rightSpectrum};
+    const TaskGraph::BufferId spectraBufs[] = {complexBuf, rightComplexBuf};
+    for (size_t ch = 0; ch < numChannels; ch++) {
+      graph.addStage(getChannelName("reconstruct", ch, numChannels),
+                     {spectraBufs[ch], masksBuf}, {stemsBufs[ch]}, [&, ch]() {
+                       LOG_INFO("Reconstructing signals.");
+                       reconstructStems(*spectra[ch], {&hMask, &pMask},
+                                        blends, stems[ch]);
+                     });
+    }
+  } else {
+    if (onSpectrum) {
+      LOG_WARNING("The full spectrum is not kept in chunked mode.");
+    }
+
+    const auto inputBuf = graph.addBuffer(
+        "input", [&]() { AlignedVector<double>().swap(input); });
+    graph.addStage("decode", {}, {inputBuf}, [&]() {
+      // Pad input.
+      input.assign(inputSize, 0.0);
+      stream.readAllMonoParallel(input.data() + PADDING_SIZE, getThreadPool());
+    });
+
+    // Spectra for one chunk at a time, to stay within the memory budget.
+    graph.addStage("chunked stems", {inputBuf}, {stemsBufs[0]}, [&]() {
+      separateStemsChunked(input, r, chunkFrames, blends, stems[0]);
+    });
+  }
+
+  for (size_t ch = 0; ch < numChannels; ch++) {
+    graph.addStage(getChannelName("vocal filter", ch, numChannels),
+                   {stemsBufs[ch]}, {vocalsBufs[ch]}, [&, ch]() {
+                     digitalHighPass(stems[ch][2], vocalsFiltered[ch],
+                                     VOICE_CUTOFF_HZ, sampleRate);
+                   });
+  }
+
+  // Hand each signal to the output writer as soon as it is final. Harmonics
+  // and percussive are written while the vocals are still filtered, and the
+  // writer blocks these stages if too much output is pending.
+  auto getStem = [&](size_t k) {
+    std::vector<std::vector<double>*> channels{};
+    for (std::vector<std::vector<double>>& channelStems : stems) {
+      channels.push_back(&channelStems[k]);
+    }
+    return channels;
+  };
+  graph.addStage("write harmonics", stemsBufs, {}, [&]() {
+    writeSignal(*writer, outputs, "harmonics_" + fileSuffix, getStem(0),
+                outputRate, range);
+  });
+  graph.addStage("write percussive", stemsBufs, {}, [&]() {
+    writeSignal(*writer, outputs, "percussive_" + fileSuffix, getStem(1),
+                outputRate, range);
+  });
+  graph.addStage("write vocals", vocalsBufs, {}, [&]() {
+    std::vector<std::vector<double>*> channels{};
+    for (std::vector<double>& channel : vocalsFiltered) {
+      channels.push_back(&channel);
+    }
+    writeSignal(*writer, outputs, "vocals_" + fileSuffix, channels,
+                outputRate, range);
+  });
+
+  const bool ran = graph.run();
+  outputs->finish(ran);
+  if (!ran) {
+    LOG_ERROR("Core pipeline could not be scheduled.");
+    return false;
+  }
+  graph.logReport();
+
+  if (stats != nullptr) {
+    stats->numSamples = numSamples;
+    stats->decode_ms = stream.getDecodeMs();
+    stats->process_ms = graph.getWallMs();
+    stats->criticalPath_ms = graph.getCriticalPathMs();
+    stats->estimatedBytes =
+        chunkFrames == 0
+            ? estimateRunMemory(numSamples, numChannels)
+            : estimateTrackMemory(numSamples) +
+                  (chunkFrames + 2 * CHUNK_CONTEXT_FRAMES) *
+                      estimateFrameMemory();
+  }
+
+  MemoryStats memoryStats = getMemoryPool().getStats();
+  LOG_INFO("Memory pool: " << memoryStats.numAllocations << " allocations, "
+                           << memoryStats.numReused << " reused, peak "
+                           << (memoryStats.peakBytesInUse >> 20) << " of "
+                           << (estimateRunMemory(numSamples, numChannels) >> 20)
+                           << " MiB without early release.");
+
+  if (ownWriter && !ownWriter->wait()) {
+    LOG_ERROR("Could not write every output of " << filePath);
+    return false;
+  }
   LOG_INFO("Done core logic");
+  return true;
 }
 
-void createInput(const MP3Data& mp3Data, std::vector<double>& input) {
-  switch (mp3Data.channel) {
-    case Channel::Mono:
-      // Copy mono channel into input vector.
-      std::copy(mp3Data.channel1.begin(), mp3Data.channel1.end(),
-                input.begin() + PADDING_SIZE);
-      break;
-
-    case Channel::Stereo:
-      // Take average of both channel to create a mono channel.
-      for (size_t n = 0; n < mp3Data.numSamples; n++) {
-        input[PADDING_SIZE + n] =
-            (mp3Data.channel1[n] + mp3Data.channel2[n]) / 2.0;
-      }
-      break;
-
-    default:
-      LOG_ERROR("Channel type is not supported");
-      break;
+bool processTrack(AudioStream& stream, const std::string& filePath,
+                  CoreRunStats* stats, const CoreOptions& options,
+                  const SpectrumCallback& onSpectrum, OutputWriter* writer,
+                  const OutputCallback& onWritten) {
+  AudioStream* input = &stream;
+  OutputRange outputRange{};
+
+  // Only decode the selected range and the context its frames need.
+  std::unique_ptr<RangeStream> rangeStream{};
+  const InputRange range = getInputRange(stream, options);
+  if (range.count == 0 && stream.getNumSamples() > 0) {
+    LOG_ERROR("The selected range is outside " << filePath);
+    if (onWritten) {
+      onWritten(false);
+    }
+    return false;
+  }
+  if (range.count < stream.getNumSamples()) {
+    LOG_INFO("Processing samples " << range.first << " to "
+                                   << range.first + range.count << " of "
+                                   << stream.getNumSamples());
+    rangeStream = std::make_unique<RangeStream>(stream, range.decodeFirst,
+                                                range.decodeCount);
+    input = rangeStream.get();
+    outputRange.first = range.first - range.decodeFirst;
+    outputRange.count = range.count;
+  }
+
+  // Convert the track to the analysis rate as it is decoded.
+  std::unique_ptr<ResampledStream> resampled{};
+  const uint64_t inputRate = static_cast<uint64_t>(stream.getSampleRate());
+  if (options.analysisRate != 0 && inputRate != 0 &&
+      inputRate != options.analysisRate) {
+    LOG_INFO("Resampling " << filePath << " from " << inputRate << " Hz to "
+                           << options.analysisRate << " Hz");
+    resampled = std::make_unique<ResampledStream>(
+        *input, options.analysisRate, options.resampleQuality);
+    input = resampled.get();
+    if (outputRange.count != SIZE_MAX) {
+      outputRange.first = static_cast<size_t>(
+          outputRange.first * options.analysisRate / inputRate);
+      outputRange.count = static_cast<size_t>(
+          (outputRange.count * options.analysisRate + inputRate - 1) /
+          inputRate);
+    }
   }
+
+  return runPipeline(*input, filePath, stats, options, onSpectrum, writer,
+                     onWritten, outputRange);
+}
+
+size_t getNumOutputChannels(const AudioStream& stream,
+                            const CoreOptions& options) {
+  return options.stereo && stream.getChannel() == Channel::Stereo ? 2 : 1;
+}
+
+size_t getNumAnalysisSamples(const AudioStream& stream,
+                             const CoreOptions& options) {
+  const uint64_t inRate = static_cast<uint64_t>(stream.getSampleRate());
+  const uint64_t numSamples = getInputRange(stream, options).decodeCount;
+  if (options.analysisRate == 0 || inRate == 0 ||
+      inRate == options.analysisRate) {
+    return numSamples;
+  }
+  return static_cast<size_t>((numSamples * options.analysisRate + inRate - 1) /
+                             inRate);
+}
+
+size_t estimateFrameMemory(size_t numChannels) {
+  const size_t c = getNyquistSize(WINDOW_SIZE);
+
+  // Complex spectra: input of each channel.
+  size_t bytes = numChannels * c * sizeof(std::complex<double>);
+
+  // Real spectra: power, HPSS medians and masks.
+  bytes += 5 * c * sizeof(double);
+
+  // One hop of overlap-add buffer per masked stem.
+  bytes += numChannels * 2 * HOP_SIZE * sizeof(double);
+
+  return bytes;
+}
+
+size_t estimateTrackMemory(size_t numSamples, size_t numChannels) {
+  const size_t r = (numSamples / HOP_SIZE) + 1;
+  const size_t paddedInputSize = numSamples + PADDING_SIZE * 2;
+  const size_t outputSize = (r - 1) * HOP_SIZE + WINDOW_SIZE;
+
+  // Per channel: padded input and the output signals: harmonics, percussive,
+  // vocals and filtered vocals.
+  return numChannels * (paddedInputSize + 4 * outputSize) * sizeof(double);
+}
+
+size_t estimateRunMemory(size_t numSamples, size_t numChannels) {
+  const size_t r = (numSamples / HOP_SIZE) + 1;
+  size_t bytes = estimateTrackMemory(numSamples, numChannels) +
+                 r * estimateFrameMemory(numChannels);
+
+  // Slack for alignment and small matrices.
+  return bytes + bytes / 32;
 }
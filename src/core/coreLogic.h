@@ -7,23 +7,181 @@
 
 #pragma once
 
+#include <cstdint>
+#include <functional>
 #include <string>
 #include <vector>
 
-#include "mp3.h"
+#include "alignedAllocator.hpp"
+#include "audioStream.h"
+#include "constants.h"
+#include "outputWriter.h"
+#include "resampler.h"
+#include "splitComplexMatrix.hpp"
 
+/** @brief Timing and size of one run of the core logic. */
+struct CoreRunStats {
+  /** @brief The number of samples per channel of the input. */
+  size_t numSamples{0};
+
+  /**
+   * @brief Time spent decoding the input file. Decoding overlaps the spectra,
+   * so it is also part of process_ms.
+   */
+  double decode_ms{0.0};
+
+  /**
+   * @brief Wall time of the processing pipeline. WAV files are written on the
+   * output writer thread, so writes that outlast the pipeline are not part of
+   * it.
+   */
+  double process_ms{0.0};
+
+  /** @brief Longest chain of dependent pipeline stages. */
+  double criticalPath_ms{0.0};
+
+  /** @brief Estimated memory of the run. See estimateRunMemory. */
+  size_t estimatedBytes{0};
+};
+
+/** @brief Settings of one run of the core logic. */
+struct CoreOptions {
+  /**
+   * @brief Memory budget. If a whole run would not fit, the spectra are built
+   * and processed one chunk of frames at a time. 0 means no limit.
+   */
+  size_t maxMemoryBytes{0};
+
+  /**
+   * @brief Write stereo stems for stereo input. Both channels go through the
+   * STFT and the reconstruction, but the masks are computed once from their
+   * mean power and shared. Falls back to mono stems when the stereo run does
+   * not fit the memory budget.
+   */
+  bool stereo{false};
+
+  /**
+   * @brief Sample rate the track is converted to before the analysis. The
+   * stems are written at this rate. Defaults to SAMPLE_RATE, which the STFT
+   * and filter settings are tuned for. A lower rate gives a faster run that
+   * drops the high band. 0 keeps the rate of the input.
+   */
+  uint32_t analysisRate{SAMPLE_RATE};
+
+  /** @brief Filter of the conversion to analysisRate. */
+  ResampleQuality resampleQuality{ResampleQuality::Balanced};
+
+  /**
+   * @brief Start of the part of the track to separate, in seconds. Only that
+   * part and the context its frames need are decoded, so the cost does not
+   * depend on the length of the track. The stems hold just the part.
+   */
+  double start_s{0.0};
+
+  /** @brief Length of the part to separate in seconds. 0 runs to the end. */
+  double duration_s{0.0};
+};
+
+/**
+ * @brief Receives the complex spectrum of the input once it is built. Called
+ * from a pipeline worker, so it should only copy what it needs.
+ */
+using SpectrumCallback = std::function<void(const SplitComplexMatrix&)>;
+
+/**
+ * @brief Called once every output file of a track is written, with whether
+ * all of them were. Called from the output writer thread.
+ */
+using OutputCallback = std::function<void(bool ok)>;
 
 /**
  * @brief Run core logic.
  *
- * @param filePath Path to mp3 file to run audio decomposition.
+ * @param filePath Path to the MP3 or WAV file to run audio decomposition.
+ * @param stats Filled with the run timings if not null.
+ * @param options Run settings.
+ * @param onSpectrum Called with the input spectrum if set.
+ * @return true on success.
+ */
+bool runCore(std::string filePath, CoreRunStats* stats = nullptr,
+             const CoreOptions& options = {},
+             const SpectrumCallback& onSpectrum = nullptr);
+
+/**
+ * @brief Run the decomposition pipeline on an audio stream and write the stems
+ * next to the working directory, named after the input file.
+ *
+ * @param[in,out] stream Opened stream. It is decoded while the pipeline runs.
+ * @param[in] filePath Path of the input file. Used to name the outputs.
+ * @param[out] stats Filled with the run timings if not null.
+ * @param[in] options Run settings.
+ * @param[in] onSpectrum Called with the input spectrum if set, the left
+ * channel one for stereo stems. Not called in chunked mode since the whole
+ * spectrum never exists at once.
+ * @param[in] writer Writer shared with other tracks. The call returns once the
+ * stems are queued, and they are written while the caller moves on. If null,
+ * the track uses its own writer and returns once its files are written.
+ * @param[in] onWritten Called exactly once when every stem is written, or
+ * when the track fails, if set.
+ * @return true on success. With a shared writer, write errors are only
+ * reported through onWritten.
+ */
+bool processTrack(AudioStream& stream, const std::string& filePath,
+                  CoreRunStats* stats = nullptr,
+                  const CoreOptions& options = {},
+                  const SpectrumCallback& onSpectrum = nullptr,
+                  OutputWriter* writer = nullptr,
+                  const OutputCallback& onWritten = nullptr);
+
+/**
+ * @brief Estimate the bytes needed by every intermediate buffer of one run of
+ * the core logic if all of them were alive at once. Reported next to the
+ * memory pool peak, which is lower since spent buffers are released early.
+ *
+ * @param[in] numSamples The number of samples per channel of the input.
+ * @param[in] numChannels The number of channels processed.
+ * @return size_t Estimated number of bytes.
+ */
+size_t estimateRunMemory(size_t numSamples, size_t numChannels = 1);
+
+/**
+ * @brief Estimate the bytes of every per frame intermediate (spectra, HPSS
+ * matrices, overlap-add buffers) for one frame.
+ *
+ * @param[in] numChannels The number of channels processed.
+ * @return size_t Estimated number of bytes per frame.
+ */
+size_t estimateFrameMemory(size_t numChannels = 1);
+
+/**
+ * @brief Estimate the bytes of the intermediates that span the whole track
+ * whatever the chunk size: the padded input and the output signals.
+ *
+ * @param[in] numSamples The number of samples per channel of the input.
+ * @param[in] numChannels The number of channels processed.
+ * @return size_t Estimated number of bytes.
+ */
+size_t estimateTrackMemory(size_t numSamples, size_t numChannels = 1);
+
+/**
+ * @brief The number of channels processTrack separates for a stream: 2 for
+ * stereo stems of a stereo track, 1 otherwise. Does not account for the
+ * memory budget.
+ *
+ * @param[in] stream Opened stream.
+ * @param[in] options Run settings.
+ * @return size_t The number of channels.
  */
-void runCore(std::string filePath);
+size_t getNumOutputChannels(const AudioStream& stream,
+                            const CoreOptions& options);
 
 /**
- * @brief Create input based on number of channels for audio processing.
+ * @brief The number of samples per channel processTrack analyses for a
+ * stream: the decoded range, including context, at the analysis rate.
  *
- * @param[in] mp3Data Mp3 input data.
- * @param[out] input Input signal that will be used for audio processing.
+ * @param[in] stream Opened stream.
+ * @param[in] options Run settings.
+ * @return size_t The number of samples per channel.
  */
-void createInput(const MP3Data& mp3Data, std::vector<double>& input);
+size_t getNumAnalysisSamples(const AudioStream& stream,
+                             const CoreOptions& options);
@@ -0,0 +1,244 @@
+/**
+ *******************************************************************************
+ * @file    taskGraph.cpp
+ * @brief   Pipeline task graph source.
+ *******************************************************************************
+ */
+
+#include "taskGraph.h"
+
+#include <algorithm>
+#include <chrono>
+#include <sstream>
+
+#include "logging.h"
+
+/** @brief Steady clock time in nanoseconds. */
+static int64_t nowNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+/** @brief Append id to list unless it is already there. */
+static void addUnique(std::vector<size_t>& list, size_t id) {
+  if (std::find(list.begin(), list.end(), id) == list.end()) {
+    list.push_back(id);
+  }
+}
+
+TaskGraph::BufferId TaskGraph::addBuffer(std::string name, ReleaseFn release) {
+  buffers.push_back({std::move(name), std::move(release), NO_STAGE});
+  return buffers.size() - 1;
+}
+
+TaskGraph::StageId TaskGraph::addStage(std::string name,
+                                       std::vector<BufferId> inputs,
+                                       std::vector<BufferId> outputs,
+                                       StageFn fn) {
+  const StageId id = stages.size();
+
+  for (BufferId output : outputs) {
+    if (buffers[output].producer != NO_STAGE) {
+      LOG_ERROR("Buffer " << buffers[output].name
+                          << " has more than one producer.");
+      valid = false;
+    }
+    buffers[output].producer = id;
+  }
+
+  stages.push_back({std::move(name), std::move(inputs), std::move(fn)});
+  return id;
+}
+
+bool TaskGraph::build() {
+  if (!valid) {
+    return false;
+  }
+
+  for (Buffer& buffer : buffers) {
+    buffer.numConsumers = 0;
+  }
+  for (Stage& stage : stages) {
+    stage.predecessors.clear();
+    stage.successors.clear();
+  }
+
+  for (StageId s = 0; s < stages.size(); s++) {
+    std::vector<BufferId> inputs{};
+    for (BufferId input : stages[s].inputs) {
+      addUnique(inputs, input);
+    }
+    stages[s].inputs = inputs;
+
+    for (BufferId input : inputs) {
+      Buffer& buffer = buffers[input];
+      buffer.numConsumers++;
+
+      if (buffer.producer == s) {
+        LOG_ERROR("Stage " << stages[s].name << " reads its own output "
+                           << buffer.name << ".");
+        return false;
+      }
+      if (buffer.producer != NO_STAGE) {
+        addUnique(stages[s].predecessors, buffer.producer);
+        addUnique(stages[buffer.producer].successors, s);
+      }
+    }
+  }
+
+  // Kahn's algorithm. Stages left out of the order are part of a cycle.
+  order.clear();
+  std::vector<size_t> numWaiting(stages.size());
+  for (StageId s = 0; s < stages.size(); s++) {
+    numWaiting[s] = stages[s].predecessors.size();
+    if (numWaiting[s] == 0) {
+      order.push_back(s);
+    }
+  }
+  for (size_t k = 0; k < order.size(); k++) {
+    for (StageId next : stages[order[k]].successors) {
+      if (--numWaiting[next] == 0) {
+        order.push_back(next);
+      }
+    }
+  }
+
+  if (order.size() != stages.size()) {
+    LOG_ERROR("Task graph stages form a cycle.");
+    return false;
+  }
+
+  return true;
+}
+
+bool TaskGraph::run(ThreadPool& pool) {
+  if (!build()) {
+    return false;
+  }
+
+  numPendingInputs = std::vector<std::atomic<size_t>>(stages.size());
+  for (StageId s = 0; s < stages.size(); s++) {
+    numPendingInputs[s] = stages[s].predecessors.size();
+  }
+  numPendingConsumers = std::vector<std::atomic<size_t>>(buffers.size());
+  for (BufferId b = 0; b < buffers.size(); b++) {
+    numPendingConsumers[b] = buffers[b].numConsumers;
+  }
+  numFinished = 0;
+
+  runStart_ns = nowNs();
+  for (StageId s = 0; s < stages.size(); s++) {
+    if (stages[s].predecessors.empty()) {
+      launch(pool, s);
+    }
+  }
+  pool.helpUntil([this]() { return numFinished == stages.size(); });
+  wall_ms = elapsedMs();
+
+  // Longest chain of durations ending at each stage, in execution order so
+  // predecessors are done first.
+  for (StageId s : order) {
+    StageTiming& timing = stages[s].timing;
+    double longest = 0.0;
+    for (StageId p : stages[s].predecessors) {
+      longest = std::max(longest, stages[p].timing.path_ms);
+    }
+    timing.path_ms = longest + timing.duration_ms;
+  }
+
+  return true;
+}
+
+void TaskGraph::launch(ThreadPool& pool, StageId stage) {
+  pool.submit([this, &pool, stage]() { runStage(pool, stage); });
+}
+
+void TaskGraph::runStage(ThreadPool& pool, StageId s) {
+  Stage& stage = stages[s];
+
+  stage.timing.start_ms = elapsedMs();
+  if (stage.fn) {
+    stage.fn();
+  }
+  stage.timing.duration_ms = elapsedMs() - stage.timing.start_ms;
+
+  // Free inputs nothing else is waiting on.
+  for (BufferId input : stage.inputs) {
+    if (--numPendingConsumers[input] == 0 && buffers[input].release) {
+      buffers[input].release();
+    }
+  }
+
+  for (StageId next : stage.successors) {
+    if (--numPendingInputs[next] == 0) {
+      launch(pool, next);
+    }
+  }
+
+  numFinished++;
+}
+
+double TaskGraph::elapsedMs() const {
+  return static_cast<double>(nowNs() - runStart_ns) / 1e6;
+}
+
+std::vector<TaskGraph::StageId> TaskGraph::getCriticalPath() const {
+  std::vector<StageId> path{};
+  if (stages.empty()) {
+    return path;
+  }
+
+  // Walk back from the stage with the longest chain, always through the
+  // predecessor with the longest chain.
+  StageId s = 0;
+  for (StageId k = 1; k < stages.size(); k++) {
+    if (stages[k].timing.path_ms > stages[s].timing.path_ms) {
+      s = k;
+    }
+  }
+
+  while (true) {
+    path.push_back(s);
+    const std::vector<StageId>& preds = stages[s].predecessors;
+    if (preds.empty()) {
+      break;
+    }
+    s = *std::max_element(preds.begin(), preds.end(),
+                          [this](StageId a, StageId b) {
+                            return stages[a].timing.path_ms <
+                                   stages[b].timing.path_ms;
+                          });
+  }
+
+  std::reverse(path.begin(), path.end());
+  return path;
+}
+
+double TaskGraph::getCriticalPathMs() const {
+  double longest = 0.0;
+  for (const Stage& stage : stages) {
+    longest = std::max(longest, stage.timing.path_ms);
+  }
+  return longest;
+}
+
+void TaskGraph::logReport() const {
+  for (const Stage& stage : stages) {
+    LOG_INFO("Stage " << stage.name << ": started at "
+                      << stage.timing.start_ms << " ms, took "
+                      << stage.timing.duration_ms << " ms.");
+  }
+
+  std::vector<StageId> path = getCriticalPath();
+  if (path.empty()) {
+    return;
+  }
+
+  std::ostringstream names;
+  for (size_t k = 0; k < path.size(); k++) {
+    names << (k > 0 ? " -> " : "") << stages[path[k]].name;
+  }
+  LOG_INFO("Critical path: " << names.str() << " (" << getCriticalPathMs()
+                             << " of " << wall_ms << " ms wall time).");
+}
@@ -0,0 +1,176 @@
+/**
+ *******************************************************************************
+ * @file    taskGraph.h
+ * @brief   Pipeline task graph header.
+ *******************************************************************************
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "threadPool.h"
+
+/**
+ * @brief Small DAG scheduler for the stages of a pipeline.
+ *
+ * Each stage declares the buffers it reads and writes. A stage is started on
+ * the thread pool as soon as the stages producing its inputs have finished,
+ * so independent stages run concurrently. A buffer's release callback runs as
+ * soon as the last stage reading it has finished. Buffers no stage writes are
+ * inputs of the graph and are ready from the start; buffers no stage reads are
+ * results and are never released.
+ */
+class TaskGraph {
+ public:
+  /** @brief Handle of a buffer. */
+  using BufferId = size_t;
+
+  /** @brief Handle of a stage. */
+  using StageId = size_t;
+
+  /** @brief Stage body. */
+  using StageFn = std::function<void()>;
+
+  /** @brief Frees the memory held by a buffer. */
+  using ReleaseFn = std::function<void()>;
+
+  /** @brief Timing of one stage of the last run. */
+  struct StageTiming {
+    /** @brief Start time relative to the start of the run. */
+    double start_ms{0.0};
+
+    /** @brief Time spent in the stage body. */
+    double duration_ms{0.0};
+
+    /** @brief Longest chain of stage durations ending with this stage. */
+    double path_ms{0.0};
+  };
+
+  /**
+   * @brief Declare a buffer.
+   *
+   * @param[in] name Name used in reports.
+   * @param[in] release Called once the last consumer has finished. May be
+   * empty.
+   * @return BufferId Handle of the buffer.
+   */
+  BufferId addBuffer(std::string name, ReleaseFn release = nullptr);
+
+  /**
+   * @brief Declare a stage.
+   *
+   * @param[in] name Name used in reports.
+   * @param[in] inputs Buffers the stage reads.
+   * @param[in] outputs Buffers the stage writes. A buffer has at most one
+   * producer.
+   * @param[in] fn Stage body.
+   * @return StageId Handle of the stage.
+   */
+  StageId addStage(std::string name, std::vector<BufferId> inputs,
+                   std::vector<BufferId> outputs, StageFn fn);
+
+  /**
+   * @brief Run every stage once, in dependency order.
+   *
+   * @param[in] pool Thread pool to run the stages on.
+   * @return true on success, false if the graph is invalid, i.e. a buffer has
+   * more than one producer or the stages form a cycle.
+   */
+  bool run(ThreadPool& pool = getThreadPool());
+
+  /**
+   * @brief Get the critical path of the last run, i.e. the chain of dependent
+   * stages with the longest total duration.
+   *
+   * @return std::vector<StageId> Stages from first to last.
+   */
+  std::vector<StageId> getCriticalPath() const;
+
+  /**
+   * @brief Get the timing of a stage from the last run.
+   *
+   * @param[in] stage Stage handle.
+   * @return const StageTiming& Stage timing.
+   */
+  inline const StageTiming& getTiming(StageId stage) const {
+    return stages[stage].timing;
+  }
+
+  /** @brief Wall time of the last run. */
+  inline double getWallMs() const { return wall_ms; }
+
+  /** @brief Total duration of the critical path of the last run. */
+  double getCriticalPathMs() const;
+
+  /** @brief Log the per stage timings and the critical path of the last run. */
+  void logReport() const;
+
+ private:
+  /** @brief A declared buffer. */
+  struct Buffer {
+    std::string name;
+    ReleaseFn release;
+
+    /** @brief Stage writing the buffer, or NO_STAGE. */
+    StageId producer;
+
+    /** @brief Number of stages reading the buffer. */
+    size_t numConsumers{0};
+  };
+
+  /** @brief A declared stage. */
+  struct Stage {
+    std::string name;
+    std::vector<BufferId> inputs;
+    StageFn fn;
+
+    /** @brief Stages producing an input of this stage. No duplicates. */
+    std::vector<StageId> predecessors{};
+
+    /** @brief Stages reading an output of this stage. No duplicates. */
+    std::vector<StageId> successors{};
+
+    StageTiming timing{};
+  };
+
+  /** @brief Link stages through their buffers and check the graph. */
+  bool build();
+
+  /** @brief Queue a stage whose inputs are ready. */
+  void launch(ThreadPool& pool, StageId stage);
+
+  /** @brief Run a stage, release its spent inputs and launch successors. */
+  void runStage(ThreadPool& pool, StageId stage);
+
+  /** @brief Milliseconds since the start of the current run. */
+  double elapsedMs() const;
+
+  /** @brief Marks a buffer without a producer. */
+  static constexpr StageId NO_STAGE = static_cast<StageId>(-1);
+
+  std::vector<Buffer> buffers{};
+  std::vector<Stage> stages{};
+
+  /** @brief Cleared when a buffer is given a second producer. */
+  bool valid{true};
+
+  /** @brief Stages in a valid execution order. Set by build. */
+  std::vector<StageId> order{};
+
+  /** @brief Per run counters. */
+  std::vector<std::atomic<size_t>> numPendingInputs{};
+  std::vector<std::atomic<size_t>> numPendingConsumers{};
+  std::atomic<size_t> numFinished{0};
+
+  /** @brief Start of the current run, in steady clock nanoseconds. */
+  int64_t runStart_ns{0};
+
+  /** @brief Wall time of the last run. */
+  double wall_ms{0.0};
+};
@@ -8,23 +8,52 @@
 #include "hpss.h"
 
 #include <algorithm>
-#include <thread>
 
 #include "constants.h"
 #include "hpssMask.hpp"
 #include "logging.h"
 #include "stats.h"
+#include "threadPool.h"
 
-static const size_t HMEDIAN_FILTER_SIZE = 11;
 static const size_t PMEDIAN_FILTER_SIZE = 5;
-static const size_t HMEDIAN_OFFSET = (HMEDIAN_FILTER_SIZE - 1) / 2;
 static const size_t PMEDIAN_OFFSET = (PMEDIAN_FILTER_SIZE - 1) / 2;
 
-void runHPSS(ComplexMatrix& complexSpectrum, Matrix<double>& powerSpectrum,
-             ComplexMatrix& hComplexSpectrum, ComplexMatrix& pComplexSpectrum,
-             bool softMask) {
+/** @brief Apply a real mask to an interleaved complex spectrum. */
+static void applyMask(const ComplexMatrix& complexSpectrum,
+                      const Matrix<double>& mask, ComplexMatrix& out) {
+  out = complexSpectrum * mask;
+}
+
+/** @brief Apply a real mask to a split complex spectrum. */
+static void applyMask(const SplitComplexMatrix& complexSpectrum,
+                      const Matrix<double>& mask, SplitComplexMatrix& out) {
+  complexScale(complexSpectrum, mask, out);
+}
+
+/** @brief Run HPSS on a complex spectrum in either layout. */
+template <typename Spectrum>
+static void hpss(const Spectrum& complexSpectrum,
+                 const Matrix<double>& powerSpectrum,
+                 Spectrum& hComplexSpectrum, Spectrum& pComplexSpectrum,
+                 bool softMask) {
   LOG_INFO("Running HPSS.");
 
+  const size_t r = powerSpectrum.getNumRows();
+  const size_t c = powerSpectrum.getNumCols();
+  Matrix<double> mH{r, c};
+  Matrix<double> mP{r, c};
+  createHPSSMasks(powerSpectrum, mH, mP, softMask);
+
+  // 3. Apply mask to complex spectrum.
+  LOG_INFO("Applying mask to complex spectrum.");
+  applyMask(complexSpectrum, mH, hComplexSpectrum);
+  applyMask(complexSpectrum, mP, pComplexSpectrum);
+
+  LOG_INFO("Finished running HPSS.");
+}
+
+void createHPSSMasks(const Matrix<double>& powerSpectrum, Matrix<double>& mH,
+                     Matrix<double>& mP, bool softMask) {
   // 1. Apply median filtering.
   LOG_INFO("Applying median filtering.");
   const size_t r = powerSpectrum.getNumRows();
@@ -36,101 +65,78 @@ void runHPSS(ComplexMatrix& complexSpectrum, Matrix<double>& powerSpectrum,
 
   // 2. Create mask.
   LOG_INFO("Applying filter mask.");
-  Matrix<double> mH{r, c};
-  Matrix<double> mP{r, c};
+  mH.resize({r, c});
+  mP.resize({r, c});
 
   if (softMask) {
     applySoftMask(yH, yP, mH, mP);
   } else {
     applyBinaryMask(yH, yP, mH, mP);
   }
+}
 
-  // 3. Apply mask to complex spectrum.
-  LOG_INFO("Applying mask to complex spectrum.");
-  hComplexSpectrum = complexSpectrum * mH;
-  pComplexSpectrum = complexSpectrum * mP;
+void runHPSS(ComplexMatrix& complexSpectrum, Matrix<double>& powerSpectrum,
+             ComplexMatrix& hComplexSpectrum, ComplexMatrix& pComplexSpectrum,
+             bool softMask) {
+  hpss(complexSpectrum, powerSpectrum, hComplexSpectrum, pComplexSpectrum,
+       softMask);
+}
 
-  LOG_INFO("Finished running HPSS.");
+void runHPSS(const SplitComplexMatrix& complexSpectrum,
+             const Matrix<double>& powerSpectrum,
+             SplitComplexMatrix& hComplexSpectrum,
+             SplitComplexMatrix& pComplexSpectrum, bool softMask) {
+  hpss(complexSpectrum, powerSpectrum, hComplexSpectrum, pComplexSpectrum,
+       softMask);
 }
 
-void runMedianFiltering(Matrix<double>& powerSpectrum, Matrix<double>& yH,
-                        Matrix<double>& yP) {
-  // Create threads to run median filtering.
+void runMedianFiltering(const Matrix<double>& powerSpectrum,
+                        Matrix<double>& yH, Matrix<double>& yP) {
   const size_t c = powerSpectrum.getNumCols();
   const size_t r = powerSpectrum.getNumRows();
 
-  const size_t NUM_H_THREADS = std::min<size_t>(4, c);  // Should be power of 2.
-  const size_t NUM_P_THREADS = std::min<size_t>(BASE_NUM_THREADS, r);
-  std::vector<std::thread> threads;
-  threads.reserve(NUM_H_THREADS + NUM_P_THREADS);
-
-  size_t start = 0;
-  size_t end = 0;
-
-  // Percussive median filtering threads.
-  size_t base = r / NUM_P_THREADS;
-  size_t rem = r % NUM_P_THREADS;
-  for (size_t i = 0; i < NUM_P_THREADS; i++) {
-    start = i * base + std::min(i, rem);
-    end = start + base + (i < rem ? 1 : 0);
-
-    threads.emplace_back(std::thread(runPMedianFiltering,
-                                     std::ref(powerSpectrum), std::ref(yP),
-                                     start, end));
-  }
-
-  // Harmonic median filtering threads.
-  base = c / NUM_H_THREADS;
-  rem = c % NUM_H_THREADS;
-  for (size_t i = 0; i < NUM_H_THREADS; i++) {
-    start = i * base + std::min(i, rem);
-    end = start + base + (i < rem ? 1 : 0);
-
-    threads.emplace_back(std::thread(runHMedianFiltering,
-                                     std::ref(powerSpectrum), std::ref(yH),
-                                     start, end));
-  }
-
-  // Join threads.
-  for (std::thread& thread : threads) {
-    thread.join();
-  }
+  // Percussive rows and harmonic columns share one index space, [0, r) for
+  // rows and [r, r + c) for columns, so the pool balances both filters.
+  parallelFor(0, r + c, [&](size_t start, size_t end) {
+    if (start < r) {
+      runPMedianFiltering(powerSpectrum, yP, start, std::min(end, r));
+    }
+    if (end > r) {
+      runHMedianFiltering(powerSpectrum, yH, std::max(start, r) - r, end - r);
+    }
+  });
 }
 
-void runHMedianFiltering(Matrix<double>& powerSpectrum, Matrix<double>& yH,
-                         size_t colStart, size_t colEnd) {
+void runHMedianFiltering(const Matrix<double>& powerSpectrum,
+                         Matrix<double>& yH, size_t colStart, size_t colEnd) {
   const size_t r = powerSpectrum.getNumRows();
-  const size_t c = powerSpectrum.getNumCols();
+  std::vector<double> scratch;
+  scratch.reserve(HMEDIAN_FILTER_SIZE);
 
   // Columns: Harmonics
   for (size_t i = colStart; i < colEnd; i++) {
-    std::vector<double> colData = powerSpectrum.getCol(i);
-    auto first = colData.begin();
-    auto last = colData.begin() + HMEDIAN_FILTER_SIZE;
+    ColView<const double> colData = powerSpectrum.col(i);
+    ColView<double> yHCol = yH.col(i);
     for (size_t j = HMEDIAN_OFFSET; j < r - HMEDIAN_OFFSET; j++) {
-      std::vector<double> vec(first, last);
-      yH(j, i) = median(vec);
-      ++first;
-      ++last;
+      yHCol[j] = median(
+          colData.subspan(j - HMEDIAN_OFFSET, HMEDIAN_FILTER_SIZE), scratch);
     }
   }
 }
 
-void runPMedianFiltering(Matrix<double>& powerSpectrum, Matrix<double>& yP,
-                         size_t rowStart, size_t rowEnd) {
-  const size_t r = powerSpectrum.getNumRows();
+void runPMedianFiltering(const Matrix<double>& powerSpectrum,
+                         Matrix<double>& yP, size_t rowStart, size_t rowEnd) {
   const size_t c = powerSpectrum.getNumCols();
+  std::vector<double> scratch;
+  scratch.reserve(PMEDIAN_FILTER_SIZE);
 
   // Rows: Percussion
   for (size_t i = rowStart; i < rowEnd; i++) {
-    std::vector<double> rowData = powerSpectrum.getRow(i);
-    auto first = rowData.begin();
-    auto last = rowData.begin() + PMEDIAN_FILTER_SIZE;
+    RowView<const double> rowData = powerSpectrum.row(i);
+    RowView<double> yPRow = yP.row(i);
     for (size_t j = PMEDIAN_OFFSET; j < c - PMEDIAN_OFFSET; j++) {
-      std::vector<double> vec(first, last);
-      yP(i, j) = median(vec);
-      ++first;
-      ++last;
+      yPRow[j] = median(
+          rowData.subspan(j - PMEDIAN_OFFSET, PMEDIAN_FILTER_SIZE), scratch);
     }
   }
 }
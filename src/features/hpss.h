@@ -11,9 +11,19 @@
 #include <vector>
 
 #include "matrix.hpp"
+#include "splitComplexMatrix.hpp"
 
 typedef Matrix<std::complex<double>> ComplexMatrix;
 
+/** @brief Length in frames of the harmonic (time) median filter. */
+inline constexpr size_t HMEDIAN_FILTER_SIZE = 11;
+
+/**
+ * @brief Frames on each side of a frame read by its harmonic median. Masks of
+ * a chunk match those of the whole track this many frames from its edges.
+ */
+inline constexpr size_t HMEDIAN_OFFSET = (HMEDIAN_FILTER_SIZE - 1) / 2;
+
 /**
  * @brief Run HPSS algo.
  *
@@ -27,6 +37,32 @@ void runHPSS(ComplexMatrix& complexSpectrum, Matrix<double>& powerSpectrum,
              ComplexMatrix& hComplexSpectrum, ComplexMatrix& pComplexSpectrum,
              bool softMask = true);
 
+/**
+ * @brief Run HPSS algo on a split complex spectrum.
+ *
+ * @param[in] complexSpectrum Complex Spectrum.
+ * @param[in] powerSpectrum Power spectrum.
+ * @param[out] hComplexSpectrum harmonics components complex spectrum.
+ * @param[out] pComplexSpectrum percussive components complex spectrum.
+ * @param[in] softMask True to use soft mask. False to use binary mask.
+ */
+void runHPSS(const SplitComplexMatrix& complexSpectrum,
+             const Matrix<double>& powerSpectrum,
+             SplitComplexMatrix& hComplexSpectrum,
+             SplitComplexMatrix& pComplexSpectrum, bool softMask = true);
+
+/**
+ * @brief Create the HPSS masks without applying them, for callers that apply
+ * them later, e.g. while reconstructing each stem.
+ *
+ * @param[in] powerSpectrum Power spectrum.
+ * @param[out] mH Harmonic mask.
+ * @param[out] mP Percussive mask.
+ * @param[in] softMask True to use soft mask. False to use binary mask.
+ */
+void createHPSSMasks(const Matrix<double>& powerSpectrum, Matrix<double>& mH,
+                     Matrix<double>& mP, bool softMask = true);
+
 /**
  * @brief Run median filtering on power spectrum.
  *
@@ -34,8 +70,8 @@ void runHPSS(ComplexMatrix& complexSpectrum, Matrix<double>& powerSpectrum,
  * @param[out] yH Median filter for harmonics.
  * @param[out] yP Median filter for percussives.
  */
-void runMedianFiltering(Matrix<double>& powerSpectrum, Matrix<double>& yH,
-                        Matrix<double>& yP);
+void runMedianFiltering(const Matrix<double>& powerSpectrum,
+                        Matrix<double>& yH, Matrix<double>& yP);
 
 /**
  * @brief Run median filtering on for harmonics.
@@ -46,8 +82,8 @@ void runMedianFiltering(Matrix<double>& powerSpectrum, Matrix<double>& yH,
  * @param colEnd The last column (non-inclusive) of the power spectrum to
  * analyze.
  */
-void runHMedianFiltering(Matrix<double>& powerSpectrum, Matrix<double>& yH,
-                         size_t colStart, size_t colEnd);
+void runHMedianFiltering(const Matrix<double>& powerSpectrum,
+                         Matrix<double>& yH, size_t colStart, size_t colEnd);
 
 /**
  * @brief Run median filtering on for percussions.
@@ -57,5 +93,5 @@ void runHMedianFiltering(Matrix<double>& powerSpectrum, Matrix<double>& yH,
  * @param rowStart The first row of the power spectrum to analyze.
  * @param rowEnd The last row (non-inclusive) of the power spectrum to analyze.
  */
-void runPMedianFiltering(Matrix<double>& powerSpectrum, Matrix<double>& yP,
-                         size_t rowStart, size_t rowEnd);
+void runPMedianFiltering(const Matrix<double>& powerSpectrum,
+                         Matrix<double>& yP, size_t rowStart, size_t rowEnd);
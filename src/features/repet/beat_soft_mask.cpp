@@ -12,9 +12,8 @@
 #include "constants.h"
 #include "stats.h"
 
-void applySoftMask(const Matrix<double>& magnitudeSpectrogram,
-                   const Matrix<std::complex<double>>& X, size_t period,
-                   Matrix<std::complex<double>>& maskedX) {
+void createRepeatingMask(const Matrix<double>& magnitudeSpectrogram,
+                         size_t period, Matrix<double>& maskMatrix) {
   size_t numTimeFrames = magnitudeSpectrogram.getNumRows();
   size_t numFreqBins = magnitudeSpectrogram.getNumCols();
   size_t numElements = magnitudeSpectrogram.getNumElements();
@@ -23,46 +22,60 @@ void applySoftMask(const Matrix<double>& magnitudeSpectrogram,
 
   // Create repeating segment matrix (S).
   Matrix<double> repeatingSegment(period, numFreqBins);
-  std::vector<double> periodMagnitudes;
-  periodMagnitudes.reserve(numTimeFrames / period + 1);
+  std::vector<double> scratch;
+  scratch.reserve(numTimeFrames / period + 1);
 
   for (size_t freq = 0; freq < numFreqBins; freq++) {
+    ColView<const double> freqCol = magnitudeSpectrogram.col(freq);
     for (size_t periodOffset = 0; periodOffset < period; periodOffset++) {
       size_t numPeriodFrames =
           (numTimeFrames - periodOffset + period - 1) / period;
-      periodMagnitudes.clear();
-      periodMagnitudes.resize(numPeriodFrames);
-
-      for (size_t i = 0; i < numPeriodFrames; i++) {
-        periodMagnitudes[i] =
-            magnitudeSpectrogram(periodOffset + i * period, freq);
-      }
-      repeatingSegment(periodOffset, freq) = median(periodMagnitudes);
+      repeatingSegment(periodOffset, freq) = median(
+          freqCol.slice(periodOffset, numPeriodFrames, period), scratch);
     }
   }
 
   // Create repeating weight matix (W).
   Matrix<double> repeatWeight(numTimeFrames, numFreqBins);
 
-  for (size_t freq = 0; freq < numFreqBins; freq++) {
-    for (int frame = static_cast<int>(numTimeFrames) - 1; frame >= 0; frame--) {
-      size_t offset = frame % period;
-      repeatWeight(frame, freq) = std::min(repeatingSegment(offset, freq),
-                                           magnitudeSpectrogram(frame, freq));
+  for (size_t frame = 0; frame < numTimeFrames; frame++) {
+    RowView<const double> segmentRow = repeatingSegment.row(frame % period);
+    RowView<const double> magnitudeRow = magnitudeSpectrogram.row(frame);
+    RowView<double> weightRow = repeatWeight.row(frame);
+    for (size_t freq = 0; freq < numFreqBins; freq++) {
+      weightRow[freq] = std::min(segmentRow[freq], magnitudeRow[freq]);
     }
   }
 
   // Create soft mask (M).
-  Matrix<double> maskMatrix(numTimeFrames, numFreqBins);
-  maskedX.resize(maskMatrix.size());
+  maskMatrix.resize(magnitudeSpectrogram.size());
 
   for (size_t i = 0; i < numElements; i++) {
     if (magnitudeSpectrogram(i) > DOUBLE_EPS) {
       maskMatrix(i) =
           std::clamp(repeatWeight(i) / magnitudeSpectrogram(i), 0.0, 1.0);
+    } else {
+      maskMatrix(i) = 0.0;
     }
   }
+}
+
+void applySoftMask(const Matrix<double>& magnitudeSpectrogram,
+                   const Matrix<std::complex<double>>& X, size_t period,
+                   Matrix<std::complex<double>>& maskedX) {
+  Matrix<double> maskMatrix(X.getNumRows(), X.getNumCols());
+  createRepeatingMask(magnitudeSpectrogram, period, maskMatrix);
 
   // Apply M onto STFT X.
   maskedX = X * maskMatrix;
 }
+
+void applySoftMask(const Matrix<double>& magnitudeSpectrogram,
+                   const SplitComplexMatrix& X, size_t period,
+                   SplitComplexMatrix& maskedX) {
+  Matrix<double> maskMatrix(X.getNumRows(), X.getNumCols());
+  createRepeatingMask(magnitudeSpectrogram, period, maskMatrix);
+
+  // Apply M onto STFT X.
+  complexScale(X, maskMatrix, maskedX);
+}
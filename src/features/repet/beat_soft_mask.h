@@ -10,6 +10,17 @@
 #include <complex>
 
 #include "matrix.hpp"
+#include "splitComplexMatrix.hpp"
+
+/**
+ * @brief Create the REPET soft mask (M) from the magnitude spectrogram.
+ *
+ * @param[in] magnitudeSpectrogram Full magnitude spectrum. (V)
+ * @param[in] period The determined period of the beat spectrum.
+ * @param[out] maskMatrix Soft mask with values in [0, 1].
+ */
+void createRepeatingMask(const Matrix<double>& magnitudeSpectrogram,
+                         size_t period, Matrix<double>& maskMatrix);
 
 /**
  * @brief Applies soft mask onto STFT X
@@ -22,3 +33,15 @@
 void applySoftMask(const Matrix<double>& magnitudeSpectrogram,
                    const Matrix<std::complex<double>>& X, size_t period,
                    Matrix<std::complex<double>>& maskedX);
+
+/**
+ * @brief Applies soft mask onto a split complex STFT X
+ *
+ * @param[in] magnitudeSpectrogram Full magnitude spectrum. (V)
+ * @param[in] X Original complex STFT. (X)
+ * @param[in] period The determined period of the beat spectrum.
+ * @param[out] maskedX soft mask on X.
+ */
+void applySoftMask(const Matrix<double>& magnitudeSpectrogram,
+                   const SplitComplexMatrix& X, size_t period,
+                   SplitComplexMatrix& maskedX);
@@ -8,9 +8,9 @@
 #include "beat_spectrum.h"
 
 #include <iostream>
-#include <thread>
 
 #include "constants.h"
+#include "threadPool.h"
 
 constexpr int MAX_LAG = 500;  // ~11.6 s = MAX_LAG / (SAMPLE_RATE / HOP_SIZE)
 
@@ -21,21 +21,18 @@ std::vector<double> createBeatSpectrum(const Matrix<double>& powerSpectrum) {
   size_t maxLag = std::min<size_t>(MAX_LAG, numTimeFrames - 1);
 
   std::vector<double> beatSpectrum(maxLag, 0.0);
-  std::vector<std::thread> threads;
-  threads.reserve(maxLag);
 
-  // Create condensed beat spectrum.
-  // TODO: Up to 500 threads are being created. Limit to couple of threads and
-  // let each thread handle multiple rows.
-  for (size_t lag = 0; lag < maxLag; lag++) {
-    threads.emplace_back(
-        std::thread(computeBeatSpectrumThread, lag, numTimeFrames, numFreq,
-                    std::ref(powerSpectrum), std::ref(beatSpectrum)));
-  }
-
-  for (std::thread& thread : threads) {
-    thread.join();
-  }
+  // Create condensed beat spectrum. Each lag is independent; short lags do the
+  // most work, so lags are handed out in small chunks.
+  parallelFor(
+      0, maxLag,
+      [&](size_t start, size_t end) {
+        for (size_t lag = start; lag < end; lag++) {
+          computeBeatSpectrumThread(lag, numTimeFrames, numFreq, powerSpectrum,
+                                    beatSpectrum);
+        }
+      },
+      1);
 
   // Normalize beat spectrum.
   if (std::abs(beatSpectrum[0]) > DOUBLE_EPS) {
@@ -51,16 +48,20 @@ std::vector<double> createBeatSpectrum(const Matrix<double>& powerSpectrum) {
 void computeBeatSpectrumThread(size_t lag, size_t numTimeFrames, size_t numFreq,
                                const Matrix<double>& powerSpectrum,
                                std::vector<double>& beatSpectrum) {
+  const size_t numOverlap = numTimeFrames - lag;
+
   for (size_t freqBin = 0; freqBin < numFreq; freqBin++) {
+    ColView<const double> freqCol = powerSpectrum.col(freqBin);
+    ColView<const double> current = freqCol.subspan(0, numOverlap);
+    ColView<const double> lagged = freqCol.subspan(lag, numOverlap);
     double lagCorrelation = 0.0;
 
     // Compute the beat spectrum correlation.
-    for (size_t timeIndex = 0; timeIndex < numTimeFrames - lag; timeIndex++) {
-      lagCorrelation += powerSpectrum(timeIndex, freqBin) *
-                        powerSpectrum(timeIndex + lag, freqBin);
+    for (size_t timeIndex = 0; timeIndex < numOverlap; timeIndex++) {
+      lagCorrelation += current[timeIndex] * lagged[timeIndex];
     }
 
-    lagCorrelation /= (numTimeFrames - lag);
+    lagCorrelation /= numOverlap;
     beatSpectrum[lag] += lagCorrelation;
   }
 
@@ -5,15 +5,18 @@
  *******************************************************************************
  */
 
+#include "repet.h"
+
 #include "beat_soft_mask.h"
 #include "beat_spectrum.h"
 #include "logging.h"
 #include "matrix.hpp"
 #include "repeating_period.h"
 
-Matrix<std::complex<double>> runRepet(const Matrix<double>& magnitudeSpectrum,
-                                      const Matrix<double>& powerSpectrum,
-                                      const Matrix<std::complex<double>>& X) {
+/** @brief Run REPET on a complex spectrum in either layout. */
+template <typename Spectrum>
+static Spectrum repet(const Matrix<double>& magnitudeSpectrum,
+                      const Matrix<double>& powerSpectrum, const Spectrum& X) {
   LOG_INFO("Running REPET.");
 
   LOG_INFO("Creating breat spectrum.");
@@ -23,10 +26,22 @@ Matrix<std::complex<double>> runRepet(const Matrix<double>& magnitudeSpectrum,
   size_t period = static_cast<size_t>(findRepeatingPeriod(beatSpectrum));
 
   LOG_INFO("Applying mask.");
-  Matrix<std::complex<double>> maskedX;
+  Spectrum maskedX{X.getNumRows(), X.getNumCols()};
   applySoftMask(magnitudeSpectrum, X, period, maskedX);
 
   LOG_INFO("Finished running REPET.");
 
   return maskedX;
 }
+
+Matrix<std::complex<double>> runRepet(const Matrix<double>& magnitudeSpectrum,
+                                      const Matrix<double>& powerSpectrum,
+                                      const Matrix<std::complex<double>>& X) {
+  return repet(magnitudeSpectrum, powerSpectrum, X);
+}
+
+SplitComplexMatrix runRepet(const Matrix<double>& magnitudeSpectrum,
+                            const Matrix<double>& powerSpectrum,
+                            const SplitComplexMatrix& X) {
+  return repet(magnitudeSpectrum, powerSpectrum, X);
+}
@@ -7,7 +7,34 @@
 
 #pragma once
 
+#include <complex>
+
+#include "matrix.hpp"
+#include "splitComplexMatrix.hpp"
+
+/**
+ * @brief Run REPET algo.
+ *
+ * @param[in] magnitudeSpectrum Magnitude spectrum.
+ * @param[in] powerSpectrum Power spectrum.
+ * @param[in] X Complex spectrum.
+ * @return Matrix<std::complex<double>> Complex spectrum with the repeating
+ * soft mask applied.
+ */
 // TODO: instead of return, pass as input.
 Matrix<std::complex<double>> runRepet(const Matrix<double>& magnitudeSpectrum,
                                       const Matrix<double>& powerSpectrum,
                                       const Matrix<std::complex<double>>& X);
+
+/**
+ * @brief Run REPET algo on a split complex spectrum.
+ *
+ * @param[in] magnitudeSpectrum Magnitude spectrum.
+ * @param[in] powerSpectrum Power spectrum.
+ * @param[in] X Complex spectrum.
+ * @return SplitComplexMatrix Complex spectrum with the repeating soft mask
+ * applied.
+ */
+SplitComplexMatrix runRepet(const Matrix<double>& magnitudeSpectrum,
+                            const Matrix<double>& powerSpectrum,
+                            const SplitComplexMatrix& X);
@@ -7,32 +7,185 @@
 
 #include "signalReconstruction.h"
 
-#include <thread>
+#include <algorithm>
+#include <cassert>
 
 #include "constants.h"
 #include "ifft.h"
-#include "windowingFunctions.hpp"
+#include "threadPool.h"
+#include "windowTable.h"
 
-void reconstructSignal(Matrix<std::complex<double>>& complexSpectrum,
-                       std::vector<double>& output) {
+/**
+ * @brief Inverse transform row i of the spectrum into x. The row is already
+ * interleaved, so no scratch frame is needed.
+ */
+static void inverseFrame(const Matrix<std::complex<double>>& complexSpectrum,
+                         size_t i,
+                         std::vector<std::complex<double>>& /*frame*/,
+                         std::vector<std::complex<double>>& x) {
+  runIFFT(complexSpectrum.getRowPtr(i), complexSpectrum.getNumCols(), x);
+}
+
+/**
+ * @brief Inverse transform row i of a split spectrum into x. The row is
+ * interleaved into frame first since the IFFT works in place on pairs.
+ */
+static void inverseFrame(const SplitComplexMatrix& complexSpectrum, size_t i,
+                         std::vector<std::complex<double>>& frame,
+                         std::vector<std::complex<double>>& x) {
+  const size_t c = complexSpectrum.getNumCols();
+  const double* re = complexSpectrum.real().getRowPtr(i);
+  const double* im = complexSpectrum.imag().getRowPtr(i);
+
+  frame.resize(c);
+  for (size_t j = 0; j < c; j++) {
+    frame[j] = {re[j], im[j]};
+  }
+  runIFFT(frame.data(), c, x);
+}
+
+/**
+ * @brief Overlap-add the frames rowStart to rowEnd (non-inclusive).
+ */
+template <typename Spectrum>
+static void overlapAddFrames(const Spectrum& complexSpectrum,
+                             const AlignedVector<double>& sqrtWeights,
+                             AlignedVector<double>& constructedSignal,
+                             size_t rowStart, size_t rowEnd) {
+  // Reconstruct signal while considering the window weights initially applied
+  // when computing the fourier transform.
+  double denominator = HALF_WINDOW_SIZE / HOP_SIZE;
+
+  std::vector<std::complex<double>> frame;
+  std::vector<std::complex<double>> x;
+
+  for (size_t i = rowStart; i < rowEnd; i++) {
+    inverseFrame(complexSpectrum, i, frame, x);
+    for (size_t j = 0; j < WINDOW_SIZE; j++) {
+      size_t pos = i * HOP_SIZE + j;
+      constructedSignal[pos] += (x[j].real() * sqrtWeights[j]) / denominator;
+    }
+  }
+}
+
+/**
+ * @brief Frames per overlap-add block. A block covers more samples than two
+ * frames overlap by, so only neighbouring blocks ever write the same sample.
+ */
+static const size_t OLA_BLOCK_FRAMES = 16;
+static_assert(OLA_BLOCK_FRAMES * HOP_SIZE >= WINDOW_SIZE - HOP_SIZE,
+              "Overlap-add blocks two apart must not overlap.");
+
+/**
+ * @brief Samples at the end of a range of frames that later frames still add
+ * to.
+ */
+static const size_t OLA_CARRY_SIZE = WINDOW_SIZE - HOP_SIZE;
+
+/**
+ * @brief Split the overlap-add of r frames across the pool. Frames are grouped
+ * into fixed blocks and all even blocks are added before all odd blocks.
+ * Blocks within a pass never touch the same sample, so threads need no
+ * locking, and every sample is summed in the same order whatever the thread
+ * count.
+ *
+ * @param[in] r The number of frames.
+ * @param[in] pool Thread pool to run the passes on.
+ * @param[in] addRows Called as addRows(rowStart, rowEnd) to overlap-add a
+ * range of frames.
+ */
+template <typename AddRows>
+static void runOverlapAddPasses(size_t r, ThreadPool& pool,
+                                const AddRows& addRows) {
+  const size_t numBlocks = (r + OLA_BLOCK_FRAMES - 1) / OLA_BLOCK_FRAMES;
+
+  for (size_t parity = 0; parity < 2; parity++) {
+    const size_t numPassBlocks = (numBlocks + 1 - parity) / 2;
+
+    // One block per chunk; blocks are already large.
+    pool.parallelFor(
+        0, numPassBlocks,
+        [&](size_t first, size_t last) {
+          for (size_t k = first; k < last; k++) {
+            size_t rowStart = (2 * k + parity) * OLA_BLOCK_FRAMES;
+            addRows(rowStart, std::min(r, rowStart + OLA_BLOCK_FRAMES));
+          }
+        },
+        1);
+  }
+}
+
+/** @brief Overlap-add every frame of a spectrum in either layout. */
+template <typename Spectrum>
+static void overlapAddAllFrames(const Spectrum& complexSpectrum,
+                                const AlignedVector<double>& sqrtWeights,
+                                AlignedVector<double>& constructedSignal,
+                                ThreadPool& pool) {
+  runOverlapAddPasses(complexSpectrum.getNumRows(), pool,
+                      [&](size_t rowStart, size_t rowEnd) {
+                        overlapAddFrames(complexSpectrum, sqrtWeights,
+                                         constructedSignal, rowStart, rowEnd);
+                      });
+}
+
+/**
+ * @brief Overlap-add frames rowStart to rowEnd (non-inclusive) of every stem.
+ * Each spectrum row is read once and masked for each stem in turn. Row rowStart
+ * lands at frame outFrame of the buffers.
+ */
+static void overlapAddStemFrames(
+    const SplitComplexMatrix& complexSpectrum,
+    const std::vector<const Matrix<double>*>& masks,
+    const AlignedVector<double>& sqrtWeights,
+    std::vector<AlignedVector<double>>& constructedSignals, size_t rowStart,
+    size_t rowEnd, size_t outFrame) {
+  const size_t c = complexSpectrum.getNumCols();
+  double denominator = HALF_WINDOW_SIZE / HOP_SIZE;
+
+  std::vector<std::complex<double>> frame(c);
+  std::vector<std::complex<double>> x;
+
+  for (size_t i = rowStart; i < rowEnd; i++) {
+    const double* re = complexSpectrum.real().getRowPtr(i);
+    const double* im = complexSpectrum.imag().getRowPtr(i);
+
+    for (size_t k = 0; k < masks.size(); k++) {
+      const double* mask = masks[k]->getRowPtr(i);
+      for (size_t j = 0; j < c; j++) {
+        frame[j] = {re[j] * mask[j], im[j] * mask[j]};
+      }
+      runIFFT(frame.data(), c, x);
+
+      double* out = constructedSignals[k].data() +
+                    (outFrame + i - rowStart) * HOP_SIZE;
+      for (size_t j = 0; j < WINDOW_SIZE; j++) {
+        out[j] += (x[j].real() * sqrtWeights[j]) / denominator;
+      }
+    }
+  }
+}
+
+/**
+ * @brief Reconstruct the time domain signal of a spectrum in either layout.
+ */
+template <typename Spectrum>
+static void reconstruct(const Spectrum& complexSpectrum,
+                        std::vector<double>& output) {
   const size_t r = complexSpectrum.getNumRows();
 
   const size_t signalSize = (r - 1) * HOP_SIZE + WINDOW_SIZE;
   const size_t paddedSignalSize = signalSize + PADDING_SIZE * 2;
 
-  std::vector<double> constructedSignal(paddedSignalSize, 0.0);
+  AlignedVector<double> constructedSignal(paddedSignalSize, 0.0);
   output.resize(signalSize);
 
-  // Temporary store window weights. Allows for faster access when
-  // reconstructing signal.
-  std::vector<double> sqrtWeights(WINDOW_SIZE);
-  for (size_t i = 0; i < WINDOW_SIZE; i++) {
-    sqrtWeights[i] = getSqrtHanningWindowWeight(i, WINDOW_SIZE);
-  }
+  // Synthesis window, shared with the analysis side through the table cache.
+  const AlignedVector<double>& sqrtWeights =
+      getWindowTable(WindowType::SqrtHann, WINDOW_SIZE);
 
   // Use threads to speed up computation.
-  runSignalReconctructionThread(complexSpectrum, sqrtWeights,
-                                constructedSignal);
+  overlapAddAllFrames(complexSpectrum, sqrtWeights, constructedSignal,
+                      getThreadPool());
 
   // Remove intially added zero padding.
   std::copy(constructedSignal.begin() + PADDING_SIZE,
@@ -40,50 +193,147 @@ void reconstructSignal(Matrix<std::complex<double>>& complexSpectrum,
             output.begin());
 }
 
+void reconstructSignal(Matrix<std::complex<double>>& complexSpectrum,
+                       std::vector<double>& output) {
+  reconstruct(complexSpectrum, output);
+}
+
+void reconstructSignal(const SplitComplexMatrix& complexSpectrum,
+                       std::vector<double>& output) {
+  reconstruct(complexSpectrum, output);
+}
+
 void runSignalReconctructionThread(
     Matrix<std::complex<double>>& complexSpectrum,
-    std::vector<double>& sqrtWeights, std::vector<double>& constructedSignal) {
+    const AlignedVector<double>& sqrtWeights,
+    AlignedVector<double>& constructedSignal, ThreadPool& pool) {
+  overlapAddAllFrames(complexSpectrum, sqrtWeights, constructedSignal, pool);
+}
+
+void complexSpectrumRowToSignal(Matrix<std::complex<double>>& complexSpectrum,
+                                const AlignedVector<double>& sqrtWeights,
+                                AlignedVector<double>& constructedSignal,
+                                size_t rowStart, size_t rowEnd) {
+  overlapAddFrames(complexSpectrum, sqrtWeights, constructedSignal, rowStart,
+                   rowEnd);
+}
+
+void reconstructStems(const SplitComplexMatrix& complexSpectrum,
+                      const std::vector<const Matrix<double>*>& masks,
+                      const std::vector<StemBlend>& blends,
+                      std::vector<std::vector<double>>& outputs) {
   const size_t r = complexSpectrum.getNumRows();
-  const size_t NUM_THREADS = std::min<size_t>(BASE_NUM_THREADS, r);
-  std::vector<std::thread> threads;
-  threads.reserve(NUM_THREADS);
 
-  size_t base = r / NUM_THREADS;
-  size_t rem = r % NUM_THREADS;
+  // One pass over the frames for every stem.
+  StemSynthesizer synthesizer(r, masks.size(), blends, outputs);
+  synthesizer.addFrames(complexSpectrum, masks, 0, r);
+  synthesizer.finish();
+}
+
+StemSynthesizer::StemSynthesizer(size_t numFrames, size_t numStems,
+                                 const std::vector<StemBlend>& blends,
+                                 std::vector<std::vector<double>>& outputs)
+    : blends(blends), outputs(outputs), numFrames(numFrames) {
+  const size_t signalSize = (numFrames - 1) * HOP_SIZE + WINDOW_SIZE;
+
+  // Samples past the last frame are never emitted and stay zero.
+  outputs.resize(numStems + blends.size());
+  for (std::vector<double>& output : outputs) {
+    output.assign(signalSize, 0.0);
+  }
+#ifndef NDEBUG
+  for (const StemBlend& blend : blends) {
+    assert(blend.weights.size() == numStems &&
+           "Stem blend needs one weight per stem.");
+  }
+#endif
+
+  constructedSignals.resize(numStems);
+  for (AlignedVector<double>& signal : constructedSignals) {
+    signal.assign(OLA_CARRY_SIZE, 0.0);
+  }
+}
 
-  size_t start = 0;
-  size_t end = 0;
+void StemSynthesizer::addFrames(
+    const SplitComplexMatrix& complexSpectrum,
+    const std::vector<const Matrix<double>*>& masks, size_t rowStart,
+    size_t rowEnd) {
+  assert(masks.size() == constructedSignals.size() &&
+         "Need one mask per stem.");
+  assert(nextFrame + rowEnd - rowStart <= numFrames &&
+         "More frames than the signal has.");
+#ifndef NDEBUG
+  for (const Matrix<double>* mask : masks) {
+    assert(mask->size() == complexSpectrum.size() &&
+           "Stem mask has incorrect dimensions.");
+  }
+#endif
 
-  for (size_t i = 0; i < NUM_THREADS; i++) {
-    start = i * base + std::min(i, rem);
-    end = start + base + (i < rem ? 1 : 0);
+  const size_t count = rowEnd - rowStart;
+  const size_t finished = count * HOP_SIZE;
+  if (count == 0) {
+    return;
+  }
 
-    threads.emplace_back(std::thread(
-        complexSpectrumRowToSignal, std::ref(complexSpectrum),
-        std::ref(sqrtWeights), std::ref(constructedSignal), start, end));
+  // The carried samples of the previous range, then zeros for the new frames.
+  for (AlignedVector<double>& signal : constructedSignals) {
+    signal.resize(finished + OLA_CARRY_SIZE);
+    std::fill(signal.begin() + OLA_CARRY_SIZE, signal.end(), 0.0);
   }
 
-  for (std::thread& thread : threads) {
-    thread.join();
+  const AlignedVector<double>& sqrtWeights =
+      getWindowTable(WindowType::SqrtHann, WINDOW_SIZE);
+
+  runOverlapAddPasses(count, getThreadPool(), [&](size_t first, size_t last) {
+    overlapAddStemFrames(complexSpectrum, masks, sqrtWeights,
+                         constructedSignals, rowStart + first, rowStart + last,
+                         first);
+  });
+
+  // Later frames start past the samples of this range, so those are final.
+  emit(finished);
+  for (AlignedVector<double>& signal : constructedSignals) {
+    std::copy(signal.begin() + finished, signal.end(), signal.begin());
+    signal.resize(OLA_CARRY_SIZE);
   }
+
+  nextFrame += count;
+  bufferStart += finished;
 }
 
-void complexSpectrumRowToSignal(Matrix<std::complex<double>>& complexSpectrum,
-                                std::vector<double>& sqrtWeights,
-                                std::vector<double>& constructedSignal,
-                                size_t rowStart, size_t rowEnd) {
-  // Reconstruct signal while considering the window weights initially applied
-  // when computing the fourier transform.
-  const size_t c = complexSpectrum.getNumCols();
-  double denominator = HALF_WINDOW_SIZE / HOP_SIZE;
+void StemSynthesizer::finish() {
+  assert(nextFrame == numFrames && "Every frame must be added.");
+  emit(OLA_CARRY_SIZE);
+}
 
-  std::vector<std::complex<double>> x;
+void StemSynthesizer::emit(size_t count) {
+  const size_t numStems = constructedSignals.size();
+  const size_t signalSize = outputs[0].size();
 
-  for (size_t i = rowStart; i < rowEnd; i++) {
-    runIFFT(complexSpectrum.getRowPtr(i), c, x);
-    for (size_t j = 0; j < WINDOW_SIZE; j++) {
-      size_t pos = i * HOP_SIZE + j;
-      constructedSignal[pos] += (x[j].real() * sqrtWeights[j]) / denominator;
+  // Remove intially added zero padding.
+  const size_t first = std::max<size_t>(bufferStart, PADDING_SIZE);
+  const size_t last = std::min<size_t>(bufferStart + count,
+                                       PADDING_SIZE + signalSize);
+  if (first >= last) {
+    return;
+  }
+
+  for (size_t k = 0; k < numStems; k++) {
+    std::copy(constructedSignals[k].begin() + (first - bufferStart),
+              constructedSignals[k].begin() + (last - bufferStart),
+              outputs[k].begin() + (first - PADDING_SIZE));
+  }
+
+  // The inverse STFT is linear, so a blend of masked spectra is the same blend
+  // of their signals.
+  for (size_t b = 0; b < blends.size(); b++) {
+    std::vector<double>& blended = outputs[numStems + b];
+
+    for (size_t k = 0; k < numStems; k++) {
+      const double weight = blends[b].weights[k];
+      for (size_t n = first - PADDING_SIZE; n < last - PADDING_SIZE; n++) {
+        blended[n] += weight * outputs[k][n];
+      }
     }
   }
 }
@@ -8,8 +8,12 @@
 #pragma once
 #include <complex>
 #include <cstdint>
+#include <vector>
 
+#include "constants.h"
 #include "matrix.hpp"
+#include "splitComplexMatrix.hpp"
+#include "threadPool.h"
 
 /**
  * @brief Reconstruction signal from complex spectrum
@@ -19,20 +23,129 @@
  */
 void reconstructSignal(Matrix<std::complex<double>>& complexSpectrum,
                        std::vector<double>& output);
+
+/**
+ * @brief Reconstruction signal from a split complex spectrum.
+ *
+ * @param[in] complexSpectrum Complex spectrum.
+ * @param[out] output reconstructed signal.
+ */
+void reconstructSignal(const SplitComplexMatrix& complexSpectrum,
+                       std::vector<double>& output);
+
+/** @brief A stem built as a weighted sum of masked stems. */
+struct StemBlend {
+  /** @brief Weight of each masked stem, in mask order. */
+  std::vector<double> weights{};
+};
+
+/**
+ * @brief Reconstruct several stems of one spectrum in a single pass over its
+ * frames. Stem k is the spectrum with masks[k] applied. Every stem shares the
+ * cached IFFT plan and window table, and the masked spectra are never stored.
+ * Blends are weighted sums of the stem signals, which equals reconstructing
+ * the blended spectrum since the inverse STFT is linear, so they need no IFFT
+ * of their own.
+ *
+ * @param[in] complexSpectrum Complex spectrum shared by every stem.
+ * @param[in] masks Real mask of each stem, same size as the spectrum.
+ * @param[in] blends Stems to build as weighted sums of the masked stems.
+ * @param[out] outputs One signal per mask, followed by one per blend.
+ */
+void reconstructStems(const SplitComplexMatrix& complexSpectrum,
+                      const std::vector<const Matrix<double>*>& masks,
+                      const std::vector<StemBlend>& blends,
+                      std::vector<std::vector<double>>& outputs);
+
+/**
+ * @brief Overlap-add synthesis of stems that is fed one range of frames at a
+ * time, in order.
+ *
+ * A sample is final once every frame that covers it has been added, so after
+ * each range the synthesizer copies the finished samples into the outputs and
+ * carries only the last WINDOW_SIZE - HOP_SIZE samples over to the next range.
+ * The overlap-add buffers therefore scale with the range instead of the whole
+ * track. How the frames are split into ranges only changes the stems by
+ * rounding.
+ */
+class StemSynthesizer {
+ public:
+  /**
+   * @brief Construct a new StemSynthesizer object and allocate the zeroed
+   * outputs.
+   *
+   * @param[in] numFrames The number of frames of the whole signal.
+   * @param[in] numStems The number of masked stems.
+   * @param[in] blends Stems to build as weighted sums of the masked stems.
+   * @param[out] outputs One signal per masked stem, followed by one per blend.
+   * Filled in as frames are added, and complete after finish().
+   */
+  StemSynthesizer(size_t numFrames, size_t numStems,
+                  const std::vector<StemBlend>& blends,
+                  std::vector<std::vector<double>>& outputs);
+
+  /**
+   * @brief Overlap-add rows rowStart to rowEnd (non-inclusive) of a spectrum
+   * as the next frames of the signal, and emit the samples they finish.
+   *
+   * @param[in] complexSpectrum Complex spectrum shared by every stem.
+   * @param[in] masks Real mask of each stem, same size as the spectrum.
+   * @param[in] rowStart First row to add.
+   * @param[in] rowEnd Last row to add (non-inclusive).
+   */
+  void addFrames(const SplitComplexMatrix& complexSpectrum,
+                 const std::vector<const Matrix<double>*>& masks,
+                 size_t rowStart, size_t rowEnd);
+
+  /** @brief Emit the samples of the last frames. Every frame must be added. */
+  void finish();
+
+ private:
+  /**
+   * @brief Copy the first count samples of the overlap-add buffers to the
+   * outputs and blends, dropping the padding.
+   */
+  void emit(size_t count);
+
+  /** @brief Blends of the masked stems. */
+  const std::vector<StemBlend>& blends;
+
+  /** @brief Masked stems, followed by the blends. */
+  std::vector<std::vector<double>>& outputs;
+
+  /** @brief Overlap-add buffer of each masked stem. */
+  std::vector<AlignedVector<double>> constructedSignals{};
+
+  /** @brief The number of frames of the whole signal. */
+  size_t numFrames;
+
+  /** @brief The number of frames added so far. */
+  size_t nextFrame{0};
+
+  /** @brief Padded position of the first sample of the buffers. */
+  size_t bufferStart{0};
+};
+
 /**
- * @brief Creates threads to do signal reconstruction.
+ * @brief Run signal reconstruction on a thread pool. The result does not
+ * depend on the number of threads in the pool.
  *
  * @param complexSpectrum Complex spectrum.
  * @param sqrtWeights Weights pre computed from square Hanning window.
  * @param constructedSignal Constructed signal where output signal will be
  * stored.
+ * @param pool Thread pool to run on.
  */
 void runSignalReconctructionThread(
     Matrix<std::complex<double>>& complexSpectrum,
-    std::vector<double>& sqrtWeights, std::vector<double>& constructedSignal);
+    const AlignedVector<double>& sqrtWeights,
+    AlignedVector<double>& constructedSignal,
+    ThreadPool& pool = getThreadPool());
 
 /**
- * @brief Convert specific rows from power spectrum to output signal.
+ * @brief Convert specific rows from power spectrum to output signal. Not safe
+ * to run concurrently on row ranges less than WINDOW_SIZE / HOP_SIZE frames
+ * apart, since their output samples overlap.
  *
  * @param complexSpectrum Complex spectrum.
  * @param sqrtWeights Weights pre computed from square Hanning window.
@@ -43,6 +156,6 @@ void runSignalReconctructionThread(
  * output signal.
  */
 void complexSpectrumRowToSignal(Matrix<std::complex<double>>& complexSpectrum,
-                                std::vector<double>& sqrtWeights,
-                                std::vector<double>& constructedSignal,
+                                const AlignedVector<double>& sqrtWeights,
+                                AlignedVector<double>& constructedSignal,
                                 size_t rowStart, size_t rowEnd);
@@ -8,62 +8,256 @@
 #include "spectrum.h"
 
 #include <algorithm>
-#include <thread>
+#include <atomic>
+#include <memory>
 #include <vector>
 
+#include "complexKernels.h"
 #include "constants.h"
 #include "fft.h"
+#include "fft_helper.hpp"
 #include "frequencyDomain.h"
 #include "logging.h"
-#include "windowingFunctions.hpp"
+#include "scratchArena.h"
+#include "threadPool.h"
+#include "windowTable.h"
 
-void createComplexSpectrum(std::vector<double>& in,
-                           Matrix<std::complex<double>>& complexSpectrum) {
-  const size_t r = complexSpectrum.getNumRows();
-
-  // Use threads to speed up computation.
-  const size_t NUM_THREADS = std::min<size_t>(BASE_NUM_THREADS, r);
-  std::vector<std::thread> threads;
-  threads.reserve(NUM_THREADS);
+/** @brief Samples requested from a source at a time when streaming. */
+static const size_t STREAM_BLOCK_SIZE = 32 * HOP_SIZE;
 
-  size_t base = r / NUM_THREADS;
-  size_t rem = r % NUM_THREADS;
+/** @brief Completed frames collected before they are handed to the pool. */
+static const size_t STREAM_BATCH_FRAMES = 32;
 
-  size_t start = 0;
-  size_t end = 0;
+/**
+ * @brief Compute the FFT of frame i of the input. The analysis window is
+ * applied as the frame is loaded into the FFT buffer.
+ */
+static void transformFrame(const AlignedVector<double>& in, size_t i,
+                           const AlignedVector<double>& window,
+                           frequencyDomain& X) {
+  runFFT(in.data() + i * HOP_SIZE, window.data(), WINDOW_SIZE, X);
+}
 
-  for (size_t i = 0; i < NUM_THREADS; i++) {
-    start = i * base + std::min(i, rem);
-    end = start + base + (i < rem ? 1 : 0);
+/** @brief Resize the requested spectra to numFrames rows. */
+static void resizeSpectra(const SpectrumOutputs& outputs, size_t numFrames) {
+  const size_t c = getNyquistSize(WINDOW_SIZE);
 
-    threads.emplace_back(std::thread(createComplexSpectrumCols, std::ref(in),
-                                     std::ref(complexSpectrum), start, end));
+  // Only touch the outputs that were asked for.
+  if (outputs.complexSpectrum != nullptr) {
+    outputs.complexSpectrum->resize({numFrames, c});
+  }
+  if (outputs.powerSpectrum != nullptr) {
+    outputs.powerSpectrum->resize({numFrames, c});
   }
+  if (outputs.magnitudeSpectrum != nullptr) {
+    outputs.magnitudeSpectrum->resize({numFrames, c});
+  }
+}
+
+/**
+ * @brief Compute the requested spectra of rows [rowStart, rowEnd). Row i is
+ * transformed from the samples at frames + (i - rowStart) * HOP_SIZE.
+ */
+static void computeSpectraRows(const double* frames,
+                               const SpectrumOutputs& outputs, size_t rowStart,
+                               size_t rowEnd) {
+  const size_t c = getNyquistSize(WINDOW_SIZE);
+
+  frequencyDomain X;
+  initFrequncyDomain(WINDOW_SIZE, X);
+  const AlignedVector<double>& window =
+      getWindowTable(WindowType::SqrtHann, WINDOW_SIZE);
+
+  // Frame sized scratch planes for when the complex spectrum itself is not
+  // requested. Power is kept for the magnitude when only that is requested.
+  // They come from the thread's arena, so batches take no pool lock.
+  ScratchScope scratch;
+  double* reScratch = scratch.allocate<double>(c);
+  double* imScratch = scratch.allocate<double>(c);
+  double* powerScratch = scratch.allocate<double>(c);
 
-  for (std::thread& thread : threads) {
-    thread.join();
+  for (size_t i = rowStart; i < rowEnd; i++) {
+    runFFT(frames + (i - rowStart) * HOP_SIZE, window.data(), WINDOW_SIZE, X);
+
+    double* re = reScratch;
+    double* im = imScratch;
+    if (outputs.complexSpectrum != nullptr) {
+      re = outputs.complexSpectrum->real().getRowPtr(i);
+      im = outputs.complexSpectrum->imag().getRowPtr(i);
+    }
+
+    // Store fourier transform values into the complex spectrum.
+    for (size_t j = 0; j < c; j++) {
+      re[j] = X.frequency[j].real();
+      im[j] = X.frequency[j].imag();
+    }
+
+    if (outputs.powerSpectrum == nullptr &&
+        outputs.magnitudeSpectrum == nullptr) {
+      continue;
+    }
+
+    // Derive power, then magnitude as its square root, while the frame is
+    // still in cache.
+    double* power = outputs.powerSpectrum != nullptr
+                        ? outputs.powerSpectrum->getRowPtr(i)
+                        : powerScratch;
+    complexNorm(re, im, power, c);
+
+    if (outputs.magnitudeSpectrum != nullptr) {
+      squareRoot(power, outputs.magnitudeSpectrum->getRowPtr(i), c);
+    }
   }
 }
 
-void createComplexSpectrumCols(std::vector<double>& in,
+void createComplexSpectrum(AlignedVector<double>& in,
+                           Matrix<std::complex<double>>& complexSpectrum) {
+  parallelFor(0, complexSpectrum.getNumRows(),
+              [&](size_t rowStart, size_t rowEnd) {
+                createComplexSpectrumCols(in, complexSpectrum, rowStart,
+                                          rowEnd);
+              });
+}
+
+void createComplexSpectrumCols(AlignedVector<double>& in,
                                Matrix<std::complex<double>>& complexSpectrum,
                                size_t rowStart, size_t rowEnd) {
   frequencyDomain X;
   initFrequncyDomain(WINDOW_SIZE, X);
-  std::vector<double> x(WINDOW_SIZE);
+  const AlignedVector<double>& window =
+      getWindowTable(WindowType::SqrtHann, WINDOW_SIZE);
 
   for (size_t i = rowStart; i < rowEnd; i++) {
-    std::copy(in.begin() + i * HOP_SIZE,
-              in.begin() + i * HOP_SIZE + WINDOW_SIZE, x.begin());
-
-    applySqrtHanningWindow(x.data(), WINDOW_SIZE);
-    runFFT(x.data(), WINDOW_SIZE, X);
+    transformFrame(in, i, window, X);
 
     // Store fourier transform values into the complex spectrum.
-    complexSpectrum.setRow(i, X.frequency);
+    std::copy(X.frequency.begin(), X.frequency.end(),
+              complexSpectrum.row(i).begin());
   }
 }
 
+void createComplexSpectrum(AlignedVector<double>& in,
+                           SplitComplexMatrix& complexSpectrum) {
+  createSpectra(in, complexSpectrum.getNumRows(), {&complexSpectrum});
+}
+
+void createComplexSpectrumCols(AlignedVector<double>& in,
+                               SplitComplexMatrix& complexSpectrum,
+                               size_t rowStart, size_t rowEnd) {
+  createSpectraCols(in, {&complexSpectrum}, rowStart, rowEnd);
+}
+
+void createSpectra(AlignedVector<double>& in, size_t numFrames,
+                   const SpectrumOutputs& outputs) {
+  resizeSpectra(outputs, numFrames);
+
+  parallelFor(0, numFrames, [&](size_t rowStart, size_t rowEnd) {
+    createSpectraCols(in, outputs, rowStart, rowEnd);
+  });
+}
+
+void createStereoSpectra(AlignedVector<double>& left,
+                         AlignedVector<double>& right, size_t numFrames,
+                         SplitComplexMatrix& leftSpectrum,
+                         SplitComplexMatrix& rightSpectrum,
+                         Matrix<double>& powerSpectrum) {
+  const SpectrumOutputs leftOutputs{&leftSpectrum, &powerSpectrum};
+  const SpectrumOutputs rightOutputs{&rightSpectrum};
+  resizeSpectra(leftOutputs, numFrames);
+  resizeSpectra(rightOutputs, numFrames);
+  const size_t c = getNyquistSize(WINDOW_SIZE);
+
+  parallelFor(0, numFrames, [&](size_t rowStart, size_t rowEnd) {
+    // The left pass fills the power rows, which the right power is then
+    // averaged into while the rows are still in cache.
+    createSpectraCols(left, {&leftSpectrum, &powerSpectrum}, rowStart, rowEnd);
+    createSpectraCols(right, rightOutputs, rowStart, rowEnd);
+
+    ScratchScope scratch;
+    double* rightPower = scratch.allocate<double>(c);
+    for (size_t i = rowStart; i < rowEnd; i++) {
+      double* power = powerSpectrum.getRowPtr(i);
+      complexNorm(rightSpectrum.real().getRowPtr(i),
+                  rightSpectrum.imag().getRowPtr(i), rightPower, c);
+      for (size_t j = 0; j < c; j++) {
+        power[j] = 0.5 * (power[j] + rightPower[j]);
+      }
+    }
+  });
+}
+
+void createSpectraStreamed(size_t numSamples, const SpectrumOutputs& outputs,
+                           const SampleSource& source) {
+  const size_t numFrames = numSamples / HOP_SIZE + 1;
+  resizeSpectra(outputs, numFrames);
+
+  ThreadPool& pool = getThreadPool();
+  const size_t maxPending = 2 * pool.getNumThreads();
+  std::atomic<size_t> numPending{0};
+
+  // Samples not yet handed out, starting at the first sample of nextFrame.
+  // Begins with the leading padding.
+  AlignedVector<double> pending(PADDING_SIZE, 0.0);
+  size_t nextFrame = 0;
+  size_t numDecoded = 0;
+
+  // Hand out the frames whose window is complete. Each batch gets its own
+  // copy of its samples, so the pending buffer can keep sliding.
+  auto dispatch = [&](size_t minBatch) {
+    while (nextFrame < numFrames && pending.size() >= WINDOW_SIZE) {
+      const size_t numReady = std::min(
+          {(pending.size() - WINDOW_SIZE) / HOP_SIZE + 1,
+           numFrames - nextFrame, STREAM_BATCH_FRAMES});
+      if (numReady < minBatch) {
+        break;
+      }
+
+      const size_t batchSize = (numReady - 1) * HOP_SIZE + WINDOW_SIZE;
+      auto batch = std::make_shared<AlignedVector<double>>(
+          pending.begin(), pending.begin() + batchSize);
+      numPending++;
+      pool.submit([&, batch, rowStart = nextFrame, numReady]() {
+        computeSpectraRows(batch->data(), outputs, rowStart,
+                           rowStart + numReady);
+        numPending--;
+      });
+
+      pending.erase(pending.begin(), pending.begin() + numReady * HOP_SIZE);
+      nextFrame += numReady;
+
+      // Help with the transforms rather than decode far ahead of them.
+      pool.helpUntil([&]() { return numPending < maxPending; });
+    }
+  };
+
+  while (numDecoded < numSamples) {
+    const size_t wanted = std::min(STREAM_BLOCK_SIZE, numSamples - numDecoded);
+    const size_t offset = pending.size();
+    pending.resize(offset + wanted);
+    const size_t numRead = source(pending.data() + offset, wanted);
+    pending.resize(offset + numRead);
+    numDecoded += numRead;
+
+    if (numRead == 0) {
+      break;
+    }
+    dispatch(STREAM_BATCH_FRAMES);
+  }
+
+  // Zeros for a source that ended early, then the trailing padding.
+  pending.resize(pending.size() + (numSamples - numDecoded) + PADDING_SIZE,
+                 0.0);
+  dispatch(1);
+  pool.helpUntil([&]() { return numPending == 0; });
+}
+
+void createSpectraCols(AlignedVector<double>& in,
+                       const SpectrumOutputs& outputs, size_t rowStart,
+                       size_t rowEnd) {
+  computeSpectraRows(in.data() + rowStart * HOP_SIZE, outputs, rowStart,
+                     rowEnd);
+}
+
 void createPowerSpectrum(const Matrix<std::complex<double>>& complexSpectrum,
                          Matrix<double>& powerSpectrum) {
   const size_t numOps = powerSpectrum.getNumRows() * powerSpectrum.getNumCols();
@@ -82,4 +276,14 @@ void createMagnitudeSpectrum(
   for (size_t i = 0; i < numOps; i++) {
     magnitudeSpectrum(i) = std::abs(complexSpectrum(i));
   }
-}
\ No newline at end of file
+}
+
+void createPowerSpectrum(const SplitComplexMatrix& complexSpectrum,
+                         Matrix<double>& powerSpectrum) {
+  complexNorm(complexSpectrum, powerSpectrum);
+}
+
+void createMagnitudeSpectrum(const SplitComplexMatrix& complexSpectrum,
+                             Matrix<double>& magnitudeSpectrum) {
+  complexAbs(complexSpectrum, magnitudeSpectrum);
+}
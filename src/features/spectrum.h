@@ -9,8 +9,25 @@
 
 #include <complex>
 #include <cstdint>
+#include <functional>
 
 #include "matrix.hpp"
+#include "splitComplexMatrix.hpp"
+
+/**
+ * @brief Spectra produced by a single STFT pass. Outputs left as nullptr are
+ * not computed, so callers only allocate the representations they use.
+ */
+struct SpectrumOutputs {
+  /** @brief Complex spectrum (X). */
+  SplitComplexMatrix* complexSpectrum = nullptr;
+
+  /** @brief Power spectrum, |X|^2. */
+  Matrix<double>* powerSpectrum = nullptr;
+
+  /** @brief Magnitude spectrum, |X|. Taken as the square root of the power. */
+  Matrix<double>* magnitudeSpectrum = nullptr;
+};
 
 /**
  * @brief Create a complex spectrum of input signal.
@@ -18,7 +35,7 @@
  * @param[in] in Input signal.
  * @param[out] complexSpectrum Complex spectrum of the input.
  */
-void createComplexSpectrum(std::vector<double>& in,
+void createComplexSpectrum(AlignedVector<double>& in,
                            Matrix<std::complex<double>>& complexSpectrum);
 
 /**
@@ -29,10 +46,101 @@ void createComplexSpectrum(std::vector<double>& in,
  * @param rowStart First row to convert to complex spectrum.
  * @param rowEnd Last row (non-inclusive) to convert to complex spectrum.
  */
-void createComplexSpectrumCols(std::vector<double>& in,
+void createComplexSpectrumCols(AlignedVector<double>& in,
                                Matrix<std::complex<double>>& complexSpectrum,
                                size_t rowStart, size_t rowEnd);
 
+/**
+ * @brief Create a complex spectrum of input signal in split layout.
+ *
+ * @param[in] in Input signal.
+ * @param[out] complexSpectrum Complex spectrum of the input.
+ */
+void createComplexSpectrum(AlignedVector<double>& in,
+                           SplitComplexMatrix& complexSpectrum);
+
+/**
+ * @brief Create a complex spectrum of input singal in split layout from
+ * specific rows.
+ *
+ * @param in Input signal.
+ * @param complexSpectrum Complex spectrum of the input.
+ * @param rowStart First row to convert to complex spectrum.
+ * @param rowEnd Last row (non-inclusive) to convert to complex spectrum.
+ */
+void createComplexSpectrumCols(AlignedVector<double>& in,
+                               SplitComplexMatrix& complexSpectrum,
+                               size_t rowStart, size_t rowEnd);
+
+/**
+ * @brief Compute the STFT of the input and derive every requested spectrum
+ * from each frame while it is still in cache.
+ *
+ * @param[in] in Padded input signal.
+ * @param[in] numFrames The number of STFT frames.
+ * @param[out] outputs Spectra to fill. Each requested matrix is resized to
+ * numFrames by the number of frequency bins.
+ */
+void createSpectra(AlignedVector<double>& in, size_t numFrames,
+                   const SpectrumOutputs& outputs);
+
+/**
+ * @brief Compute the complex spectrum of each channel of a stereo signal, and
+ * one power spectrum for both, from which masks shared by the channels are
+ * computed. The power is the mean of the channel powers, so a
+ * track with identical channels gets the spectra of its mono signal.
+ *
+ * @param[in] left Padded left channel.
+ * @param[in] right Padded right channel.
+ * @param[in] numFrames The number of STFT frames.
+ * @param[out] leftSpectrum Complex spectrum of the left channel.
+ * @param[out] rightSpectrum Complex spectrum of the right channel.
+ * @param[out] powerSpectrum Mean power spectrum of both channels.
+ */
+void createStereoSpectra(AlignedVector<double>& left,
+                         AlignedVector<double>& right, size_t numFrames,
+                         SplitComplexMatrix& leftSpectrum,
+                         SplitComplexMatrix& rightSpectrum,
+                         Matrix<double>& powerSpectrum);
+
+/**
+ * @brief Produces the next samples of a signal.
+ *
+ * @param[out] out Destination of the samples.
+ * @param[in] maxSamples The number of samples wanted.
+ * @return size_t The number of samples written. 0 once the signal has ended.
+ */
+using SampleSource = std::function<size_t(double* out, size_t maxSamples)>;
+
+/**
+ * @brief Compute the requested spectra of a signal pulled from a source in
+ * blocks. Frames go to the thread pool as soon as their window is complete, so
+ * producing the signal (e.g. decoding) overlaps the STFT. Only a window of
+ * pending samples is kept rather than the whole padded signal. The result
+ * matches createSpectra on the padded signal.
+ *
+ * @param[in] numSamples The number of samples of the signal.
+ * @param[out] outputs Spectra to fill. Each requested matrix is resized to
+ * numSamples / HOP_SIZE + 1 frames by the number of frequency bins.
+ * @param[in] source Producer of the signal. Called on the calling thread only.
+ * If it ends early the rest of the signal is taken as zeros.
+ */
+void createSpectraStreamed(size_t numSamples, const SpectrumOutputs& outputs,
+                           const SampleSource& source);
+
+/**
+ * @brief Compute the requested spectra for specific rows. Requested matrices
+ * must already have their final size.
+ *
+ * @param in Padded input signal.
+ * @param outputs Spectra to fill.
+ * @param rowStart First row to compute.
+ * @param rowEnd Last row (non-inclusive) to compute.
+ */
+void createSpectraCols(AlignedVector<double>& in,
+                       const SpectrumOutputs& outputs, size_t rowStart,
+                       size_t rowEnd);
+
 /**
  * @brief Create a power spectrum from the complex spectrum.
  *
@@ -51,3 +159,21 @@ void createPowerSpectrum(const Matrix<std::complex<double>>& complexSpectrum,
 void createMagnitudeSpectrum(
     const Matrix<std::complex<double>>& complexSpectrum,
     Matrix<double>& magnitudeSpectrum);
+
+/**
+ * @brief Create a power spectrum from a split complex spectrum.
+ *
+ * @param[in] complexSpectrum Complex spectrum.
+ * @param[out] powerSpectrum Power spectrum
+ */
+void createPowerSpectrum(const SplitComplexMatrix& complexSpectrum,
+                         Matrix<double>& powerSpectrum);
+
+/**
+ * @brief Create a magnitude spectrum from a split complex spectrum.
+ *
+ * @param[in] complexSpectrum Complex spectrum.
+ * @param[out] magnitudeSpectrum Magnitude spectrum
+ */
+void createMagnitudeSpectrum(const SplitComplexMatrix& complexSpectrum,
+                             Matrix<double>& magnitudeSpectrum);
@@ -8,47 +8,52 @@
 #include "fft.h"
 
 #include "constants.h"
+#include "fftPlan.h"
 #include "fft_helper.hpp"
 #include "logging.h"
 #include "powers.hpp"
 
+/**
+ * @brief Run the radix-2 stages on input already loaded into X.
+ *
+ * @param[in] N Size of input signal. Must be a power of 2.
+ * @param[in,out] X Frequency domain structure holding N input values.
+ */
+static void transformLoadedInput(uint32_t N, frequencyDomain& X);
+
 void runFFT(double* x, uint32_t N, frequencyDomain& X) {
   if (!checkPower2(N)) {
     LOG_ERROR("N is not a power of 2. N = " << N);
     return;
   }
 
-  // Run radix sort.
   X.frequency.resize(N);
-  for (int i = 0; i < N; i++) {
+  for (uint32_t i = 0; i < N; i++) {
     X.frequency[i] = doubleComplex(x[i], 0.0);
   }
 
-  size_t numStages = static_cast<size_t>(log2(N));
-  swapInput(X.frequency.data(), N, numStages);
-
-  // Run butterfly staging to compute fourier transform.
-  std::vector<doubleComplex> weight(N / 2);
-  for (size_t s = 1; s <= numStages; s++) {
-    size_t stageN = 1 << s;
-    size_t half = stageN >> 1;
-    double angle = -2.0 * PI / static_cast<double>(stageN);
-
-    for (size_t l = 0; l < half; l++) {
-      weight[l] = std::polar(1.0, angle * l);
-    }
-
-    for (size_t k = 0; k < N; k += stageN) {
-      doubleComplex* base = X.frequency.data() + k;
-      for (size_t j = 0; j < half; j++) {
-        doubleComplex u = base[j];
-        doubleComplex t = weight[j] * base[j + half];
-        base[j] = u + t;
-        base[j + half] = u - t;
-      }
-    }
+  transformLoadedInput(N, X);
+}
+
+void runFFT(const double* x, const double* window, uint32_t N,
+            frequencyDomain& X) {
+  if (!checkPower2(N)) {
+    LOG_ERROR("N is not a power of 2. N = " << N);
+    return;
+  }
+
+  // Apply the window while loading the input.
+  X.frequency.resize(N);
+  for (uint32_t i = 0; i < N; i++) {
+    X.frequency[i] = doubleComplex(x[i] * window[i], 0.0);
   }
 
+  transformLoadedInput(N, X);
+}
+
+static void transformLoadedInput(uint32_t N, frequencyDomain& X) {
+  getFFTPlan(N, false).execute(X.frequency.data());
+
   // From Nyquist thereom, we can discard the last half elements as they repeat.
   resizeFrequncyDomain(getNyquistSize(N), X);
 }
@@ -21,3 +21,15 @@ typedef std::complex<double> doubleComplex;
  * @param[in,out] X Frequency domain structure.
  */
 void runFFT(double* x, uint32_t N, frequencyDomain& X);
+
+/**
+ * @brief Run FFT on a windowed input signal. The window is applied while the
+ * input is loaded, so the caller does not need a windowed copy of the signal.
+ *
+ * @param[in] x Input signal. Left unmodified.
+ * @param[in] window Window weights, N values.
+ * @param[in] N Size of input signal.
+ * @param[in,out] X Frequency domain structure.
+ */
+void runFFT(const double* x, const double* window, uint32_t N,
+            frequencyDomain& X);
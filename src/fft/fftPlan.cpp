@@ -0,0 +1,98 @@
+/**
+ *******************************************************************************
+ * @file    fftPlan.cpp
+ * @brief   Precomputed radix-2 FFT plans source.
+ *******************************************************************************
+ */
+
+#include "fftPlan.h"
+
+#include <cmath>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <utility>
+
+#include "bit_reversal.h"
+#include "constants.h"
+
+FFTPlan::FFTPlan(uint32_t N, bool inverse) : N(N) {
+  const size_t numStages = static_cast<size_t>(log2(N));
+
+  // Input reordering, same order as swapInput.
+  for (uint32_t i = 0; i < N; i++) {
+    uint32_t reversedBits = bitReversal32(i) >> (32 - numStages);
+    if (reversedBits > i) {
+      swaps.emplace_back(i, reversedBits);
+    }
+  }
+
+  // Twiddle factors, computed exactly as the butterfly stages used to.
+  const double sign = inverse ? 1.0 : -1.0;
+  twiddles.reserve(N > 0 ? N - 1 : 0);
+  for (size_t s = 1; s <= numStages; s++) {
+    size_t stageN = 1 << s;
+    size_t half = stageN >> 1;
+    double angle = sign * 2.0 * PI / static_cast<double>(stageN);
+
+    for (size_t l = 0; l < half; l++) {
+      twiddles.push_back(std::polar(1.0, angle * l));
+    }
+  }
+}
+
+void FFTPlan::execute(std::complex<double>* x) const {
+  for (const std::pair<uint32_t, uint32_t>& swap : swaps) {
+    std::swap(x[swap.first], x[swap.second]);
+  }
+
+  // Run butterfly staging.
+  for (size_t half = 1; half < N; half <<= 1) {
+    const size_t stageN = half << 1;
+    const std::complex<double>* weight = twiddles.data() + half - 1;
+
+    for (size_t k = 0; k < N; k += stageN) {
+      std::complex<double>* base = x + k;
+      for (size_t j = 0; j < half; j++) {
+        std::complex<double> u = base[j];
+        std::complex<double> t = weight[j] * base[j + half];
+        base[j] = u + t;
+        base[j + half] = u - t;
+      }
+    }
+  }
+}
+
+const FFTPlan& getFFTPlan(uint32_t N, bool inverse) {
+  // Each thread remembers its last plan per direction, so repeated lookups of
+  // the same size from the per frame loops take no lock at all.
+  thread_local const FFTPlan* lastPlan[2] = {nullptr, nullptr};
+  const FFTPlan*& last = lastPlan[inverse ? 1 : 0];
+  if (last != nullptr && last->size() == N) {
+    return *last;
+  }
+
+  static std::shared_mutex registryMutex;
+  static std::map<std::pair<uint32_t, bool>, std::unique_ptr<FFTPlan>>
+      registry;
+  const std::pair<uint32_t, bool> key{N, inverse};
+
+  {
+    std::shared_lock<std::shared_mutex> lock(registryMutex);
+    auto it = registry.find(key);
+    if (it != registry.end()) {
+      last = it->second.get();
+      return *last;
+    }
+  }
+
+  std::unique_lock<std::shared_mutex> lock(registryMutex);
+  std::unique_ptr<FFTPlan>& plan = registry[key];
+  if (!plan) {
+    plan = std::make_unique<FFTPlan>(N, inverse);
+  }
+
+  last = plan.get();
+  return *last;
+}
@@ -0,0 +1,65 @@
+/**
+ *******************************************************************************
+ * @file    fftPlan.h
+ * @brief   Precomputed radix-2 FFT plans.
+ *******************************************************************************
+ */
+
+#pragma once
+
+#include <complex>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Everything about a radix-2 transform that depends only on its size
+ * and direction: the bit reversed input order and the twiddle factors of each
+ * butterfly stage. A plan is read-only once built, so one plan can be shared
+ * by every thread and every signal of that size.
+ */
+class FFTPlan {
+ public:
+  /**
+   * @brief Construct a new FFTPlan object.
+   *
+   * @param[in] N Transform size. Must be a power of 2.
+   * @param[in] inverse True for the inverse transform.
+   */
+  FFTPlan(uint32_t N, bool inverse);
+
+  /**
+   * @brief Run the transform in place. The inverse transform is not
+   * normalized.
+   *
+   * @param[in,out] x N values, replaced by their transform.
+   */
+  void execute(std::complex<double>* x) const;
+
+  /** @brief Transform size. */
+  inline uint32_t size() const { return N; }
+
+ private:
+  /** @brief Transform size. */
+  uint32_t N;
+
+  /** @brief Pairs of positions to swap for the bit reversed input order. */
+  std::vector<std::pair<uint32_t, uint32_t>> swaps{};
+
+  /**
+   * @brief Twiddle factors of every stage, back to back. The stage of size
+   * 2 * half starts at offset half - 1.
+   */
+  std::vector<std::complex<double>> twiddles{};
+};
+
+/**
+ * @brief Get the cached plan for a transform size and direction. Built on
+ * first use and valid for the life of the program. Safe to call from several
+ * threads. Looking up the same size again from a thread takes no lock, so the
+ * per frame loops may call it for every frame.
+ *
+ * @param[in] N Transform size. Must be a power of 2.
+ * @param[in] inverse True for the inverse transform.
+ * @return const FFTPlan& Shared plan.
+ */
+const FFTPlan& getFFTPlan(uint32_t N, bool inverse);
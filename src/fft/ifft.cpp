@@ -8,6 +8,7 @@
 #include "ifft.h"
 
 #include "constants.h"
+#include "fftPlan.h"
 #include "fft_helper.hpp"
 #include "logging.h"
 #include "powers.hpp"
@@ -27,35 +28,11 @@ void runIFFT(const doubleComplex* X, uint32_t N, std::vector<doubleComplex>& x,
     return;
   }
 
-  // Run radix sort.
-  size_t numStages = static_cast<size_t>(log2(N));
-  swapInput(x.data(), N, numStages);
-
-  // Run butterfly staging to compute fourier transform.
-  std::vector<doubleComplex> weight(N / 2);
-  for (size_t s = 1; s <= numStages; s++) {
-    size_t stageN = 1 << s;
-    size_t half = stageN >> 1;
-    double angle = 2.0 * PI / static_cast<double>(stageN);
-
-    for (size_t l = 0; l < half; l++) {
-      weight[l] = std::polar(1.0, angle * l);
-    }
-
-    for (size_t k = 0; k < N; k += stageN) {
-      doubleComplex* base = x.data() + k;
-      for (size_t j = 0; j < half; j++) {
-        doubleComplex u = base[j];
-        doubleComplex t = weight[j] * base[j + half];
-        base[j] = u + t;
-        base[j + half] = u - t;
-      }
-    }
-  }
+  getFFTPlan(N, true).execute(x.data());
 
   // Normalize the signal.
   double invN = 1.0 / static_cast<double>(N);
-  for (int i = 0; i < N; i++) {
+  for (uint32_t i = 0; i < N; i++) {
     x[i] *= invN;
   }
 }
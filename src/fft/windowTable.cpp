@@ -0,0 +1,117 @@
+/**
+ *******************************************************************************
+ * @file    windowTable.cpp
+ * @brief   Precomputed window function tables source.
+ *******************************************************************************
+ */
+
+#include "windowTable.h"
+
+#include <cmath>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <utility>
+
+#include "constants.h"
+#include "windowingFunctions.hpp"
+
+/**
+ * @brief Zeroth order modified Bessel function of the first kind, summed as a
+ * power series until terms stop contributing.
+ */
+static double besselI0(double x) {
+  const double halfX = x / 2.0;
+  double term = 1.0;
+  double sum = 1.0;
+
+  for (int k = 1; k < 64; k++) {
+    term *= (halfX / k) * (halfX / k);
+    sum += term;
+    if (term < sum * DOUBLE_EPS) {
+      break;
+    }
+  }
+
+  return sum;
+}
+
+void computeWindow(WindowType type, uint32_t N, double* w, double beta) {
+  if (N == 1) {
+    w[0] = 1.0;
+    return;
+  }
+
+  const int size = static_cast<int>(N);
+  const double denominator = static_cast<double>(N - 1);
+
+  for (int n = 0; n < size; n++) {
+    const double phase = 2.0 * PI * n / denominator;
+
+    switch (type) {
+      case WindowType::Hann:
+        w[n] = getHanningWindowWeight(n, size);
+        break;
+
+      case WindowType::SqrtHann:
+        w[n] = getSqrtHanningWindowWeight(n, size);
+        break;
+
+      case WindowType::Hamming:
+        w[n] = 0.54 - 0.46 * std::cos(phase);
+        break;
+
+      case WindowType::BlackmanHarris:
+        w[n] = 0.35875 - 0.48829 * std::cos(phase) +
+               0.14128 * std::cos(2.0 * phase) -
+               0.01168 * std::cos(3.0 * phase);
+        break;
+
+      case WindowType::Kaiser: {
+        const double ratio = 2.0 * n / denominator - 1.0;
+        w[n] = besselI0(beta * std::sqrt(1.0 - ratio * ratio)) /
+               besselI0(beta);
+        break;
+      }
+    }
+  }
+}
+
+const AlignedVector<double>& getWindowTable(WindowType type, uint32_t N) {
+  // Each thread remembers its last table, so repeated lookups take no lock.
+  thread_local const AlignedVector<double>* lastTable = nullptr;
+  thread_local WindowType lastType = WindowType::Hann;
+  if (lastTable != nullptr && lastType == type && lastTable->size() == N) {
+    return *lastTable;
+  }
+
+  static std::shared_mutex registryMutex;
+  static std::map<std::pair<WindowType, uint32_t>,
+                  std::unique_ptr<AlignedVector<double>>>
+      registry;
+  const std::pair<WindowType, uint32_t> key{type, N};
+
+  const AlignedVector<double>* found = nullptr;
+  {
+    std::shared_lock<std::shared_mutex> lock(registryMutex);
+    auto it = registry.find(key);
+    if (it != registry.end()) {
+      found = it->second.get();
+    }
+  }
+
+  if (found == nullptr) {
+    std::unique_lock<std::shared_mutex> lock(registryMutex);
+    std::unique_ptr<AlignedVector<double>>& table = registry[key];
+    if (!table) {
+      table = std::make_unique<AlignedVector<double>>(N);
+      computeWindow(type, N, table->data());
+    }
+    found = table.get();
+  }
+
+  lastTable = found;
+  lastType = type;
+  return *found;
+}
@@ -0,0 +1,48 @@
+/**
+ *******************************************************************************
+ * @file    windowTable.h
+ * @brief   Precomputed window function tables.
+ *******************************************************************************
+ */
+
+#pragma once
+
+#include <cstdint>
+
+#include "alignedAllocator.hpp"
+
+/** @brief Supported window functions. All windows are symmetric. */
+enum class WindowType {
+  Hann,
+  SqrtHann,
+  Hamming,
+  BlackmanHarris,
+  Kaiser,
+};
+
+/** @brief Shape parameter used for cached Kaiser windows. */
+inline constexpr double KAISER_BETA = 8.6;
+
+/**
+ * @brief Evaluate a window function into a buffer.
+ *
+ * @param[in] type Window function.
+ * @param[in] N Window size.
+ * @param[out] w Window weights. Must hold N values.
+ * @param[in] beta Kaiser shape parameter. Ignored by other windows.
+ */
+void computeWindow(WindowType type, uint32_t N, double* w,
+                   double beta = KAISER_BETA);
+
+/**
+ * @brief Get the cached weights for a window function and size. The table is
+ * computed on first use and shared by every caller afterwards; it is never
+ * modified or freed, so the returned reference stays valid for the life of the
+ * program. Safe to call from several threads. Looking up the same table again
+ * from a thread takes no lock.
+ *
+ * @param[in] type Window function.
+ * @param[in] N Window size.
+ * @return const AlignedVector<double>& Window weights.
+ */
+const AlignedVector<double>& getWindowTable(WindowType type, uint32_t N);
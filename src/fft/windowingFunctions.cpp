@@ -8,19 +8,18 @@
 #include "windowingFunctions.hpp"
 
 #include "constants.h"
+#include "windowTable.h"
 
 void applyHanningWindow(double* x, int N) {
+  const AlignedVector<double>& w = getWindowTable(WindowType::Hann, N);
   for (int n = 0; n < N; n++) {
-    double w = std::sin(PI * n / (N - 1)) * std::sin(PI * n / (N - 1));
-    double xn = x[n] * w;
-    x[n] = xn;
+    x[n] *= w[n];
   }
 }
 
 void applySqrtHanningWindow(double* x, int N) {
+  const AlignedVector<double>& w = getWindowTable(WindowType::SqrtHann, N);
   for (int n = 0; n < N; n++) {
-    double w = std::sin(PI * n / (N - 1));
-    double xn = x[n] * w;
-    x[n] = xn;
+    x[n] *= w[n];
   }
-}
\ No newline at end of file
+}
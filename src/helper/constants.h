@@ -11,6 +11,7 @@
 
 #include <math.h>
 
+#include <cstddef>
 #include <cstdint>
 #include <limits>
 
@@ -21,6 +22,8 @@ inline constexpr uint32_t BYTE_SIZE = 8U;
 
 inline constexpr uint32_t BASE_NUM_THREADS = 5U;
 
+inline constexpr size_t MEMORY_ALIGNMENT = 64U;
+
 inline constexpr double DOUBLE_EPS = std::numeric_limits<double>::epsilon();
 
 inline constexpr double MAX_DOUBLE = std::numeric_limits<double>::max();
@@ -0,0 +1,231 @@
+/**
+ *******************************************************************************
+ * @file    resampler.cpp
+ * @brief   Polyphase sample rate converter source.
+ *******************************************************************************
+ */
+
+#include "resampler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+#include "constants.h"
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+/** @brief Filter design of a quality preset. */
+struct ResampleFilter {
+  /** @brief Zero crossings of the sinc on each side of the center. */
+  double zeroCrossings;
+
+  /** @brief Kaiser window shape. Sets the stop band attenuation. */
+  double beta;
+
+  /**
+   * @brief Cutoff relative to the lower Nyquist rate. Puts the end of the
+   * transition band at the Nyquist rate.
+   */
+  double cutoff;
+};
+
+/** @brief Filter design of each preset. */
+static ResampleFilter getFilter(ResampleQuality quality) {
+  switch (quality) {
+    case ResampleQuality::Fast:
+      return {16.0, 5.65, 0.89};
+    case ResampleQuality::Best:
+      return {64.0, 12.26, 0.94};
+    case ResampleQuality::Balanced:
+    default:
+      return {32.0, 8.96, 0.91};
+  }
+}
+
+/** @brief Zeroth order modified Bessel function of the first kind. */
+static double besselI0(double x) {
+  double sum = 1.0;
+  double term = 1.0;
+  for (int k = 1; term > sum * 1e-21; k++) {
+    const double factor = x / (2.0 * k);
+    term *= factor * factor;
+    sum += term;
+  }
+  return sum;
+}
+
+/**
+ * @brief Dot product of n doubles, n a multiple of 4.
+ *
+ * @param[in] a Aligned first operand.
+ * @param[in] b Second operand.
+ * @param[in] n The number of elements.
+ * @return double Sum of the products.
+ */
+static double dot(const double* a, const double* b, size_t n) {
+  size_t i = 0;
+  double sum = 0.0;
+
+#if defined(__AVX__)
+  // Two accumulators hide the latency of the adds.
+  __m256d acc0 = _mm256_setzero_pd();
+  __m256d acc1 = _mm256_setzero_pd();
+  for (; i + 8 <= n; i += 8) {
+    acc0 = _mm256_add_pd(
+        acc0, _mm256_mul_pd(_mm256_load_pd(a + i), _mm256_loadu_pd(b + i)));
+    acc1 = _mm256_add_pd(acc1, _mm256_mul_pd(_mm256_load_pd(a + i + 4),
+                                             _mm256_loadu_pd(b + i + 4)));
+  }
+  for (; i + 4 <= n; i += 4) {
+    acc0 = _mm256_add_pd(
+        acc0, _mm256_mul_pd(_mm256_load_pd(a + i), _mm256_loadu_pd(b + i)));
+  }
+  acc0 = _mm256_add_pd(acc0, acc1);
+  __m128d half = _mm_add_pd(_mm256_castpd256_pd128(acc0),
+                            _mm256_extractf128_pd(acc0, 1));
+  sum = _mm_cvtsd_f64(_mm_add_sd(half, _mm_unpackhi_pd(half, half)));
+#elif defined(__SSE2__) || defined(_M_X64)
+  __m128d acc0 = _mm_setzero_pd();
+  __m128d acc1 = _mm_setzero_pd();
+  for (; i + 4 <= n; i += 4) {
+    acc0 =
+        _mm_add_pd(acc0, _mm_mul_pd(_mm_load_pd(a + i), _mm_loadu_pd(b + i)));
+    acc1 = _mm_add_pd(
+        acc1, _mm_mul_pd(_mm_load_pd(a + i + 2), _mm_loadu_pd(b + i + 2)));
+  }
+  acc0 = _mm_add_pd(acc0, acc1);
+  sum = _mm_cvtsd_f64(_mm_add_sd(acc0, _mm_unpackhi_pd(acc0, acc0)));
+#endif
+
+  for (; i < n; i++) {
+    sum += a[i] * b[i];
+  }
+  return sum;
+}
+
+Resampler::Resampler(uint32_t inRate, uint32_t outRate,
+                     ResampleQuality quality)
+    : inRate(inRate), outRate(outRate) {
+  const uint64_t divisor = std::gcd(inRate, outRate);
+  if (divisor == 0 || inRate == outRate) {
+    return;
+  }
+  up = outRate / divisor;
+  down = inRate / divisor;
+  numPhases = std::min(up, MAX_RESAMPLE_PHASES);
+
+  // Cut off below the lower Nyquist rate. Downsampling stretches the sinc,
+  // and the window with it, over more input samples.
+  const ResampleFilter design = getFilter(quality);
+  const double scale =
+      design.cutoff * std::min(1.0, static_cast<double>(outRate) / inRate);
+  const double halfWidth = design.zeroCrossings / scale;
+  numTapsBefore = static_cast<int64_t>(std::ceil(halfWidth));
+  numTaps = (2 * static_cast<size_t>(numTapsBefore) + 3) / 4 * 4;
+
+  // Row p holds the taps for an output p / numPhases of a sample after the
+  // input sample before it. Tap k is the input sample numTapsBefore - 1 - k
+  // samples before that one.
+  const double windowNorm = besselI0(design.beta);
+  bank.assign((numPhases + 1) * numTaps, 0.0);
+  for (uint64_t p = 0; p <= numPhases; p++) {
+    double* row = bank.data() + p * numTaps;
+    const double frac = static_cast<double>(p) / numPhases;
+    double gain = 0.0;
+
+    for (size_t k = 0; k < numTaps; k++) {
+      const double t = frac + static_cast<double>(numTapsBefore - 1) -
+                       static_cast<double>(k);
+      const double x = t / halfWidth;
+      if (std::abs(x) >= 1.0) {
+        continue;
+      }
+
+      const double arg = PI * scale * t;
+      const double sinc = t == 0.0 ? 1.0 : std::sin(arg) / arg;
+      const double window =
+          besselI0(design.beta * std::sqrt(1.0 - x * x)) / windowNorm;
+      row[k] = scale * sinc * window;
+      gain += row[k];
+    }
+
+    for (size_t k = 0; k < numTaps; k++) {
+      row[k] /= gain;
+    }
+  }
+}
+
+size_t Resampler::getOutputSize(size_t numIn) const {
+  return static_cast<size_t>((numIn * up + down - 1) / down);
+}
+
+int64_t Resampler::getFirstInput(uint64_t first) const {
+  return static_cast<int64_t>(first * down / up) - numTapsBefore + 1;
+}
+
+int64_t Resampler::getEndInput(uint64_t end) const {
+  if (up == down) {
+    return static_cast<int64_t>(end);
+  }
+  if (end == 0) {
+    return getFirstInput(0);
+  }
+  return getFirstInput(end - 1) + static_cast<int64_t>(numTaps);
+}
+
+void Resampler::process(const double* in, int64_t inFirst, size_t numIn,
+                        uint64_t first, size_t count, double* out) const {
+  const int64_t inEnd = inFirst + static_cast<int64_t>(numIn);
+  auto getInput = [&](int64_t j) {
+    return j >= inFirst && j < inEnd ? in[j - inFirst] : 0.0;
+  };
+
+  if (up == down) {
+    for (size_t k = 0; k < count; k++) {
+      out[k] = getInput(static_cast<int64_t>(first + k));
+    }
+    return;
+  }
+
+  // Windows that run past either end of the input are copied with zeros.
+  AlignedVector<double> edge{};
+  for (size_t k = 0; k < count; k++) {
+    const uint64_t time = (first + k) * down;
+    const int64_t start =
+        static_cast<int64_t>(time / up) - numTapsBefore + 1;
+    const uint64_t phaseTime = time % up;
+
+    if (start >= inFirst && start + static_cast<int64_t>(numTaps) <= inEnd) {
+      out[k] = filter(in + (start - inFirst), phaseTime);
+    } else {
+      edge.resize(numTaps);
+      for (size_t t = 0; t < numTaps; t++) {
+        edge[t] = getInput(start + static_cast<int64_t>(t));
+      }
+      out[k] = filter(edge.data(), phaseTime);
+    }
+  }
+}
+
+double Resampler::filter(const double* window, uint64_t phaseTime) const {
+  // Exact when every phase is in the bank. Otherwise the output lies between
+  // two phases.
+  const uint64_t position = phaseTime * numPhases;
+  const uint64_t phase = position / up;
+  const uint64_t remainder = position % up;
+
+  const double* row = bank.data() + phase * numTaps;
+  const double sample = dot(row, window, numTaps);
+  if (remainder == 0) {
+    return sample;
+  }
+
+  const double weight = static_cast<double>(remainder) / up;
+  const double next = dot(row + numTaps, window, numTaps);
+  return sample + weight * (next - sample);
+}
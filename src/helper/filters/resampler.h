@@ -0,0 +1,149 @@
+/**
+ *******************************************************************************
+ * @file    resampler.h
+ * @brief   Polyphase sample rate converter header.
+ *******************************************************************************
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "alignedAllocator.hpp"
+
+/** @brief Most phases of a resampler filter bank. */
+inline constexpr uint64_t MAX_RESAMPLE_PHASES = 4096;
+
+/** @brief Trade-off between speed and accuracy of the resampler. */
+enum class ResampleQuality {
+  /**
+   * @brief 16 zero crossings each side, about 60 dB of stop band. For runs
+   * that only need the analysis.
+   */
+  Fast,
+
+  /** @brief 32 zero crossings each side, about 90 dB of stop band. */
+  Balanced,
+
+  /** @brief 64 zero crossings each side, about 120 dB of stop band. */
+  Best,
+};
+
+/**
+ * @brief Converts a signal between two sample rates with a Kaiser windowed
+ * sinc filter.
+ *
+ * The rate ratio is reduced to L / M, and the filter is stored as a bank of
+ * phases, one per output position between two input samples, so each output
+ * sample is a single dot product of one phase with the input. The filter cuts
+ * off below the lower of both Nyquist rates, and its taps are widened when
+ * downsampling so the stop band stays the same. Each phase is normalized to a
+ * gain of 1 at DC.
+ *
+ * Ratios needing more than MAX_RESAMPLE_PHASES phases, i.e. unusual rate
+ * pairs, keep that many phases and interpolate between the two nearest.
+ * Output sample n sits at input time n * inRate / outRate, and samples outside
+ * the input are zeros. Equal rates copy the input.
+ */
+class Resampler {
+ public:
+  /**
+   * @brief Construct a new Resampler object and build its filter bank.
+   *
+   * @param[in] inRate Sample rate of the input.
+   * @param[in] outRate Sample rate of the output.
+   * @param[in] quality Filter length and stop band.
+   */
+  Resampler(uint32_t inRate, uint32_t outRate,
+            ResampleQuality quality = ResampleQuality::Balanced);
+
+  /**
+   * @brief The number of output samples of an input of numIn samples.
+   *
+   * @param[in] numIn The number of input samples.
+   * @return size_t ceil(numIn * outRate / inRate).
+   */
+  size_t getOutputSize(size_t numIn) const;
+
+  /**
+   * @brief The first input sample the output samples from first on need.
+   *
+   * @param[in] first Index of the first output sample.
+   * @return int64_t Index of the input sample. Negative before the input.
+   */
+  int64_t getFirstInput(uint64_t first) const;
+
+  /**
+   * @brief The input sample after the last one that the output samples before
+   * end need.
+   *
+   * @param[in] end Index after the last output sample.
+   * @return int64_t Index of the input sample.
+   */
+  int64_t getEndInput(uint64_t end) const;
+
+  /**
+   * @brief Compute output samples [first, first + count) from a window of the
+   * input. Output ranges are independent, so a signal can be resampled in
+   * blocks or on several threads with the same result.
+   *
+   * @param[in] in Input samples from index inFirst on.
+   * @param[in] inFirst Index of the first sample of in.
+   * @param[in] numIn The number of samples in in. Samples outside the window
+   * are taken as zeros.
+   * @param[in] first Index of the first output sample.
+   * @param[in] count The number of output samples.
+   * @param[out] out Destination of count samples.
+   */
+  void process(const double* in, int64_t inFirst, size_t numIn, uint64_t first,
+               size_t count, double* out) const;
+
+  /** @brief Sample rate of the input. */
+  inline uint32_t getInputRate() const { return inRate; }
+
+  /** @brief Sample rate of the output. */
+  inline uint32_t getOutputRate() const { return outRate; }
+
+  /** @brief Taps of each phase, padded to a multiple of 4. */
+  inline size_t getNumTaps() const { return numTaps; }
+
+ private:
+  /**
+   * @brief Compute one output sample.
+   *
+   * @param[in] window numTaps input samples around the output position.
+   * @param[in] phaseTime Position after the input sample before it, in units
+   * of 1 / L input samples.
+   * @return double Output sample.
+   */
+  double filter(const double* window, uint64_t phaseTime) const;
+
+  /** @brief Sample rate of the input. */
+  const uint32_t inRate;
+
+  /** @brief Sample rate of the output. */
+  const uint32_t outRate;
+
+  /** @brief Interpolation factor L of the reduced ratio. */
+  uint64_t up{1};
+
+  /** @brief Decimation factor M of the reduced ratio. */
+  uint64_t down{1};
+
+  /** @brief The number of phases in the bank. L unless capped. */
+  uint64_t numPhases{1};
+
+  /** @brief Taps before the output position, including the sample at it. */
+  int64_t numTapsBefore{0};
+
+  /** @brief Taps of each phase, padded to a multiple of 4. */
+  size_t numTaps{0};
+
+  /**
+   * @brief Filter bank: numPhases + 1 rows of numTaps coefficients. The last
+   * row is the first phase one input sample later, so interpolation between
+   * phases never wraps.
+   */
+  AlignedVector<double> bank{};
+};
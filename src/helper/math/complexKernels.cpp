@@ -0,0 +1,130 @@
+/**
+ *******************************************************************************
+ * @file    complexKernels.cpp
+ * @brief   Element-wise kernels over split real/imaginary arrays.
+ *******************************************************************************
+ */
+
+#include "complexKernels.h"
+
+#include <cmath>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+void complexNorm(const double* re, const double* im, double* out, size_t n) {
+  size_t i = 0;
+
+#if defined(__AVX__)
+  for (; i + 4 <= n; i += 4) {
+    __m256d a = _mm256_loadu_pd(re + i);
+    __m256d b = _mm256_loadu_pd(im + i);
+    __m256d sum = _mm256_add_pd(_mm256_mul_pd(a, a), _mm256_mul_pd(b, b));
+    _mm256_storeu_pd(out + i, sum);
+  }
+#elif defined(__SSE2__) || defined(_M_X64)
+  for (; i + 2 <= n; i += 2) {
+    __m128d a = _mm_loadu_pd(re + i);
+    __m128d b = _mm_loadu_pd(im + i);
+    __m128d sum = _mm_add_pd(_mm_mul_pd(a, a), _mm_mul_pd(b, b));
+    _mm_storeu_pd(out + i, sum);
+  }
+#endif
+
+  for (; i < n; i++) {
+    out[i] = re[i] * re[i] + im[i] * im[i];
+  }
+}
+
+void complexAbs(const double* re, const double* im, double* out, size_t n) {
+  size_t i = 0;
+
+#if defined(__AVX__)
+  for (; i + 4 <= n; i += 4) {
+    __m256d a = _mm256_loadu_pd(re + i);
+    __m256d b = _mm256_loadu_pd(im + i);
+    __m256d sum = _mm256_add_pd(_mm256_mul_pd(a, a), _mm256_mul_pd(b, b));
+    _mm256_storeu_pd(out + i, _mm256_sqrt_pd(sum));
+  }
+#elif defined(__SSE2__) || defined(_M_X64)
+  for (; i + 2 <= n; i += 2) {
+    __m128d a = _mm_loadu_pd(re + i);
+    __m128d b = _mm_loadu_pd(im + i);
+    __m128d sum = _mm_add_pd(_mm_mul_pd(a, a), _mm_mul_pd(b, b));
+    _mm_storeu_pd(out + i, _mm_sqrt_pd(sum));
+  }
+#endif
+
+  for (; i < n; i++) {
+    out[i] = std::sqrt(re[i] * re[i] + im[i] * im[i]);
+  }
+}
+
+void squareRoot(const double* in, double* out, size_t n) {
+  size_t i = 0;
+
+#if defined(__AVX__)
+  for (; i + 4 <= n; i += 4) {
+    _mm256_storeu_pd(out + i, _mm256_sqrt_pd(_mm256_loadu_pd(in + i)));
+  }
+#elif defined(__SSE2__) || defined(_M_X64)
+  for (; i + 2 <= n; i += 2) {
+    _mm_storeu_pd(out + i, _mm_sqrt_pd(_mm_loadu_pd(in + i)));
+  }
+#endif
+
+  for (; i < n; i++) {
+    out[i] = std::sqrt(in[i]);
+  }
+}
+
+void complexScale(const double* re, const double* im, const double* weights,
+                  double* outRe, double* outIm, size_t n) {
+  size_t i = 0;
+
+#if defined(__AVX__)
+  for (; i + 4 <= n; i += 4) {
+    __m256d w = _mm256_loadu_pd(weights + i);
+    _mm256_storeu_pd(outRe + i, _mm256_mul_pd(_mm256_loadu_pd(re + i), w));
+    _mm256_storeu_pd(outIm + i, _mm256_mul_pd(_mm256_loadu_pd(im + i), w));
+  }
+#elif defined(__SSE2__) || defined(_M_X64)
+  for (; i + 2 <= n; i += 2) {
+    __m128d w = _mm_loadu_pd(weights + i);
+    _mm_storeu_pd(outRe + i, _mm_mul_pd(_mm_loadu_pd(re + i), w));
+    _mm_storeu_pd(outIm + i, _mm_mul_pd(_mm_loadu_pd(im + i), w));
+  }
+#endif
+
+  for (; i < n; i++) {
+    outRe[i] = re[i] * weights[i];
+    outIm[i] = im[i] * weights[i];
+  }
+}
+
+void complexScale(const double* re, const double* im, double scalar,
+                  double* outRe, double* outIm, size_t n) {
+  size_t i = 0;
+
+#if defined(__AVX__)
+  const __m256d s = _mm256_set1_pd(scalar);
+  for (; i + 4 <= n; i += 4) {
+    _mm256_storeu_pd(outRe + i, _mm256_mul_pd(_mm256_loadu_pd(re + i), s));
+    _mm256_storeu_pd(outIm + i, _mm256_mul_pd(_mm256_loadu_pd(im + i), s));
+  }
+#elif defined(__SSE2__) || defined(_M_X64)
+  const __m128d s = _mm_set1_pd(scalar);
+  for (; i + 2 <= n; i += 2) {
+    _mm_storeu_pd(outRe + i, _mm_mul_pd(_mm_loadu_pd(re + i), s));
+    _mm_storeu_pd(outIm + i, _mm_mul_pd(_mm_loadu_pd(im + i), s));
+  }
+#endif
+
+  for (; i < n; i++) {
+    outRe[i] = re[i] * scalar;
+    outIm[i] = im[i] * scalar;
+  }
+}
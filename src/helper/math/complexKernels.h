@@ -0,0 +1,70 @@
+/**
+ *******************************************************************************
+ * @file    complexKernels.h
+ * @brief   Element-wise kernels over split real/imaginary arrays.
+ *
+ * Each kernel walks the real and imaginary planes with SIMD registers (AVX
+ * when the compiler targets it, SSE2 otherwise) and finishes any remainder
+ * with scalar code. Output arrays may alias the inputs.
+ *******************************************************************************
+ */
+
+#pragma once
+
+#include <cstddef>
+
+/**
+ * @brief Squared magnitude of each element. out[i] = re[i]^2 + im[i]^2
+ *
+ * @param[in] re Real parts.
+ * @param[in] im Imaginary parts.
+ * @param[out] out Squared magnitudes.
+ * @param[in] n The number of elements.
+ */
+void complexNorm(const double* re, const double* im, double* out, size_t n);
+
+/**
+ * @brief Magnitude of each element. out[i] = sqrt(re[i]^2 + im[i]^2)
+ *
+ * @param[in] re Real parts.
+ * @param[in] im Imaginary parts.
+ * @param[out] out Magnitudes.
+ * @param[in] n The number of elements.
+ */
+void complexAbs(const double* re, const double* im, double* out, size_t n);
+
+/**
+ * @brief Square root of each element. Turns squared magnitudes from
+ * complexNorm into magnitudes without touching the complex data again.
+ *
+ * @param[in] in Input values.
+ * @param[out] out Square roots.
+ * @param[in] n The number of elements.
+ */
+void squareRoot(const double* in, double* out, size_t n);
+
+/**
+ * @brief Multiply each element by its own real weight, e.g. a spectral mask.
+ *
+ * @param[in] re Real parts.
+ * @param[in] im Imaginary parts.
+ * @param[in] weights Real weights.
+ * @param[out] outRe Real parts of the result.
+ * @param[out] outIm Imaginary parts of the result.
+ * @param[in] n The number of elements.
+ */
+void complexScale(const double* re, const double* im, const double* weights,
+                  double* outRe, double* outIm, size_t n);
+
+/**
+ * @brief Multiply every element by the same real scalar.
+ *
+ * @param[in] re Real parts.
+ * @param[in] im Imaginary parts.
+ * @param[in] scalar Real multiplier.
+ * @param[out] outRe Real parts of the result.
+ * @param[out] outIm Imaginary parts of the result.
+ * @param[in] n The number of elements.
+ */
+void complexScale(const double* re, const double* im, double scalar,
+                  double* outRe, double* outIm, size_t n);
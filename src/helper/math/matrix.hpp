@@ -10,12 +10,28 @@
 #include <cassert>
 #include <vector>
 
+#include "alignedAllocator.hpp"
 #include "logging.h"
+#include "matrix_expr.hpp"
+#include "matrix_view.hpp"
 
-/** @brief Matrix class. */
-template <typename T>
-class Matrix {
+/**
+ * @brief Matrix class.
+ *
+ * @tparam T Element type.
+ * @tparam Allocator Storage allocator. Defaults to 64 byte aligned blocks from
+ * the shared MemoryPool, so buffers freed by one pipeline stage are recycled by
+ * the next.
+ */
+template <typename T, typename Allocator = AlignedAllocator<T>>
+class Matrix : public MatrixExpr<Matrix<T, Allocator>> {
  public:
+  using value_type = T;
+  using allocator_type = Allocator;
+
+  /** @brief Matrices are leaves of an expression and held by reference. */
+  static constexpr bool isLeaf = true;
+
   /** @brief Construct a new Matrix object. */
   Matrix() {
     rows = 1;
@@ -41,7 +57,7 @@ class Matrix {
    * @param[in] data Data to initialize matrix to.
    */
   Matrix(size_t rows, size_t cols, std::vector<T> data)
-      : rows(rows), cols(cols), data(data) {
+      : rows(rows), cols(cols), data(data.begin(), data.end()) {
     if (data.size() != rows * cols) {
       // Set to vector is matrix dimension does not make sense.
       rows = data.size();
@@ -50,6 +66,33 @@ class Matrix {
     }
   }
 
+  /**
+   * @brief Construct a new Matrix object by evaluating an element-wise
+   * expression in a single pass.
+   *
+   * @param[in] expr Expression to evaluate.
+   */
+  template <typename E>
+  Matrix(const MatrixExpr<E>& expr)
+      : rows(expr.derived().getNumRows()), cols(expr.derived().getNumCols()) {
+    data.resize(rows * cols);
+    assign(expr.derived());
+  }
+
+  /**
+   * @brief Evaluate an element-wise expression into this matrix in a single
+   * pass. The matrix is resized to the expression dimensions.
+   *
+   * @param[in] expr Expression to evaluate.
+   * @return Matrix<T>& This matrix.
+   */
+  template <typename E>
+  Matrix& operator=(const MatrixExpr<E>& expr) {
+    resize(expr.derived().size());
+    assign(expr.derived());
+    return *this;
+  }
+
   /**
    * @brief Single cell access.
    *
@@ -91,16 +134,17 @@ class Matrix {
   /**
    * @brief Matrix element-wise addition. A += B
    *
-   * @param b matrix to add with B.
+   * @param b matrix or expression to add with B.
    * @return Matrix<T>& Result A.
    */
-  template <typename U>
-  Matrix<T>& operator+=(const Matrix<U>& b) {
-    assert(this->size() == b.size() &&
+  template <typename E>
+  Matrix& operator+=(const MatrixExpr<E>& b) {
+    const E& e = b.derived();
+    assert(this->size() == e.size() &&
            "Matrix elementwise addition have incorrect dimensions.");
 
     for (size_t i = 0; i < data.size(); i++) {
-      data[i] += b(i);
+      data[i] += e(i);
     }
     return *this;
   }
@@ -108,16 +152,17 @@ class Matrix {
   /**
    * @brief Matrix element-wise multiplication. A *= B
    *
-   * @param b multiplier matrix B.
+   * @param b multiplier matrix or expression B.
    * @return Matrix<T>& Result A.
    */
-  template <typename U>
-  Matrix<T>& operator*=(const Matrix<U>& b) {
-    assert(this->size() == b.size() &&
+  template <typename E>
+  Matrix& operator*=(const MatrixExpr<E>& b) {
+    const E& e = b.derived();
+    assert(this->size() == e.size() &&
            "Matrix elementwise multiplication have incorrect dimensions.");
 
     for (size_t i = 0; i < data.size(); i++) {
-      data[i] *= b(i);
+      data[i] *= e(i);
     }
     return *this;
   }
@@ -125,27 +170,29 @@ class Matrix {
   /**
    * @brief Matrix element-wise division. A /= B
    *
-   * @param b divisor matrix B.
+   * @param b divisor matrix or expression B.
    * @return Matrix<T>& Result A.
    */
-  template <typename U>
-  Matrix<T>& operator/=(const Matrix<U>& b) {
-    assert(this->size() == b.size() &&
+  template <typename E>
+  Matrix& operator/=(const MatrixExpr<E>& b) {
+    const E& e = b.derived();
+    assert(this->size() == e.size() &&
            "Matrix elementwise division have incorrect dimensions.");
 
     for (size_t i = 0; i < data.size(); i++) {
-      data[i] /= b(i);
+      data[i] /= e(i);
     }
     return *this;
   }
 
   /**
-   * @brief Scale a matrix.
+   * @brief Scale a matrix in place. Use `matrix * scalar` for a scaled copy
+   * that leaves this matrix untouched.
    *
    * @param scalar Scalar to multiply with matrix.
    * @return Matrix<T>& Resultant matrix.
    */
-  const Matrix<T>& scale(const T& scalar) {
+  const Matrix& scale(const T& scalar) {
     for (T& val : data) {
       val *= scalar;
     }
@@ -198,6 +245,13 @@ class Matrix {
    */
   inline size_t getNumElements() const { return rows * cols; }
 
+  /**
+   * @brief Get the allocator used for the matrix storage.
+   *
+   * @return Allocator Storage allocator.
+   */
+  Allocator getAllocator() const { return data.get_allocator(); }
+
   /**
    * @brief Get a copy of the entire row.
    *
@@ -226,13 +280,25 @@ class Matrix {
     return data.data() + r * cols;
   }
 
+  /**
+   * @brief Return a pointer to the start of row r.
+   *
+   * @param[in] r Row number.
+   * @return T* pointer to start of row content.
+   */
+  T* getRowPtr(size_t r) {
+    assert(r < rows);
+
+    return data.data() + r * cols;
+  }
+
   /**
    * @brief Get a copy of the entire column.
    *
    * @param[in] c Column number.
    * @return std::vector<T> Column content.
    */
-  std::vector<T> getCol(size_t c) {
+  std::vector<T> getCol(size_t c) const {
     assert(c < cols);
     std::vector<T> colData(rows);
 
@@ -247,7 +313,7 @@ class Matrix {
    * @param r Row number.
    * @param vec New data.
    */
-  void setRow(size_t r, std::vector<T> vec) {
+  void setRow(size_t r, const std::vector<T>& vec) {
     if (vec.size() != cols) {
       return;
     }
@@ -261,7 +327,7 @@ class Matrix {
    * @param c Column number.
    * @param vec New data.
    */
-  void setCol(size_t c, std::vector<T> vec) {
+  void setCol(size_t c, const std::vector<T>& vec) {
     if (vec.size() != rows) {
       return;
     }
@@ -271,7 +337,101 @@ class Matrix {
     }
   }
 
+  /**
+   * @brief View an entire row without copying.
+   *
+   * @param[in] r Row number.
+   * @return RowView<T> Row view. Valid until the matrix is resized.
+   */
+  RowView<T> row(size_t r) {
+    assert(r < rows);
+    return RowView<T>(data.data() + r * cols, cols);
+  }
+
+  /**
+   * @brief View an entire row without copying.
+   *
+   * @param[in] r Row number.
+   * @return RowView<const T> Read-only row view. Valid until the matrix is
+   * resized.
+   */
+  RowView<const T> row(size_t r) const {
+    assert(r < rows);
+    return RowView<const T>(data.data() + r * cols, cols);
+  }
+
+  /**
+   * @brief View an entire column without copying.
+   *
+   * @param[in] c Column number.
+   * @return ColView<T> Column view. Valid until the matrix is resized.
+   */
+  ColView<T> col(size_t c) {
+    assert(c < cols);
+    return ColView<T>(data.data() + c, rows, cols);
+  }
+
+  /**
+   * @brief View an entire column without copying.
+   *
+   * @param[in] c Column number.
+   * @return ColView<const T> Read-only column view. Valid until the matrix is
+   * resized.
+   */
+  ColView<const T> col(size_t c) const {
+    assert(c < cols);
+    return ColView<const T>(data.data() + c, rows, cols);
+  }
+
+  /**
+   * @brief View a rectangular sub-block without copying.
+   *
+   * @param[in] r First row of the block.
+   * @param[in] c First column of the block.
+   * @param[in] numRows The number of rows in the block.
+   * @param[in] numCols The number of columns in the block.
+   * @return BlockView<T> Block view. Valid until the matrix is resized.
+   */
+  BlockView<T> block(size_t r, size_t c, size_t numRows, size_t numCols) {
+    assert(r + numRows <= rows && c + numCols <= cols);
+    return BlockView<T>(data.data() + r * cols + c, numRows, numCols, cols);
+  }
+
+  /**
+   * @brief View a rectangular sub-block without copying.
+   *
+   * @param[in] r First row of the block.
+   * @param[in] c First column of the block.
+   * @param[in] numRows The number of rows in the block.
+   * @param[in] numCols The number of columns in the block.
+   * @return BlockView<const T> Read-only block view. Valid until the matrix is
+   * resized.
+   */
+  BlockView<const T> block(size_t r, size_t c, size_t numRows,
+                           size_t numCols) const {
+    assert(r + numRows <= rows && c + numCols <= cols);
+    return BlockView<const T>(data.data() + r * cols + c, numRows, numCols,
+                              cols);
+  }
+
  private:
+  /**
+   * @brief Evaluate an expression element by element into the matrix data.
+   * Reads of element i happen before the write to element i, so the matrix may
+   * appear in the expression.
+   *
+   * @param[in] expr Expression with the same dimensions as this matrix.
+   */
+  template <typename E>
+  void assign(const E& expr) {
+    T* out = data.data();
+    const size_t n = data.size();
+
+    for (size_t i = 0; i < n; i++) {
+      out[i] = expr(i);
+    }
+  }
+
   /** @brief The number of rows in the matrix. */
   size_t rows{0};
 
@@ -279,50 +439,11 @@ class Matrix {
   size_t cols{0};
 
   /** @brief Matrix data. Data is stored linearly. Cell (i, j) = i * cols + j */
-  std::vector<T> data{};
+  std::vector<T, Allocator> data{};
 };
 
-/**
- * @brief Matrix element-wise addition. A = C * B
- *
- * @param c original matrix C.
- * @param b matrix to add with B.
- * @return Matrix<T>& Result A.
- */
-template <typename T, typename U>
-Matrix<T> operator+(Matrix<T> c, const Matrix<U>& b) {
-  c += b;
-  return c;
-}
-
-/**
- * @brief Matrix element-wise multiplication. A = C * B
- *
- * @param c original matrix C.
- * @param b multiplier matrix B.
- * @return Matrix<T>& Result A.
- */
-template <typename T, typename U>
-Matrix<T> operator*(Matrix<T> c, const Matrix<U>& b) {
-  c *= b;
-  return c;
-}
-
-/**
- * @brief Matrix element-wise division. A = C / B
- *
- * @param c original matrix C.
- * @param b divisor matrix B.
- * @return Matrix<T>& Result A.
- */
-template <typename T, typename U>
-Matrix<T> operator/(Matrix<T> c, const Matrix<U>& b) {
-  c /= b;
-  return c;
-}
-
-template <typename T>
-Matrix<T> transpose(const Matrix<T>& A) {
+template <typename T, typename Allocator>
+Matrix<T, Allocator> transpose(const Matrix<T, Allocator>& A) {
   const size_t numRows = A.getNumRows();
   const size_t numCols = A.getNumCols();
   const size_t numElements = numRows * numCols;
@@ -335,6 +456,6 @@ Matrix<T> transpose(const Matrix<T>& A) {
     }
   }
 
-  Matrix<T> AT(numRows, numCols, dataT);
+  Matrix<T, Allocator> AT(numRows, numCols, dataT);
   return AT;
 }
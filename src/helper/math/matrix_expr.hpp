@@ -0,0 +1,287 @@
+/**
+ *******************************************************************************
+ * @file    matrix_expr.hpp
+ * @brief   Lazy element-wise matrix expressions.
+ *
+ * Element-wise operators on matrices build a light expression tree instead of
+ * computing a result straight away. The tree is evaluated in one loop when it
+ * is assigned to a Matrix, so chained operations such as `a * 0.8 + b * 0.2`
+ * do not allocate intermediate matrices.
+ *******************************************************************************
+ */
+
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+/**
+ * @brief Base class of every matrix expression, including Matrix itself.
+ *
+ * Derived classes provide value_type, isLeaf, operator()(size_t) for flat
+ * element access, getNumRows(), getNumCols() and size().
+ *
+ * @tparam E Derived expression type.
+ */
+template <typename E>
+class MatrixExpr {
+ public:
+  /** @brief Access the derived expression. */
+  inline const E& derived() const { return static_cast<const E&>(*this); }
+};
+
+/** @brief True if T is a matrix expression. */
+template <typename T>
+inline constexpr bool isMatrixExpr =
+    std::is_base_of_v<MatrixExpr<std::decay_t<T>>, std::decay_t<T>>;
+
+/**
+ * @brief How an operand is held inside an expression node. Matrices are held
+ * by reference, expression nodes are small and held by value so temporaries in
+ * a chain stay alive.
+ */
+template <typename E>
+using ExprOperand = std::conditional_t<E::isLeaf, const E&, const E>;
+
+/** @brief Element-wise addition. */
+struct ExprAdd {
+  template <typename A, typename B>
+  static inline auto apply(const A& a, const B& b) {
+    return a + b;
+  }
+};
+
+/** @brief Element-wise subtraction. */
+struct ExprSub {
+  template <typename A, typename B>
+  static inline auto apply(const A& a, const B& b) {
+    return a - b;
+  }
+};
+
+/** @brief Element-wise multiplication. */
+struct ExprMul {
+  template <typename A, typename B>
+  static inline auto apply(const A& a, const B& b) {
+    return a * b;
+  }
+};
+
+/** @brief Element-wise division. */
+struct ExprDiv {
+  template <typename A, typename B>
+  static inline auto apply(const A& a, const B& b) {
+    return a / b;
+  }
+};
+
+/**
+ * @brief Element-wise operation between two matrix expressions.
+ *
+ * @tparam Op Operation functor.
+ * @tparam L Left operand expression type.
+ * @tparam R Right operand expression type.
+ */
+template <typename Op, typename L, typename R>
+class MatrixBinaryExpr : public MatrixExpr<MatrixBinaryExpr<Op, L, R>> {
+ public:
+  using value_type = decltype(Op::apply(
+      std::declval<typename L::value_type>(),
+      std::declval<typename R::value_type>()));
+
+  static constexpr bool isLeaf = false;
+
+  /**
+   * @brief Construct a new MatrixBinaryExpr object. Operands must have the
+   * same dimensions; this is checked by the operator building the node.
+   *
+   * @param[in] lhs Left operand.
+   * @param[in] rhs Right operand.
+   */
+  MatrixBinaryExpr(const L& lhs, const R& rhs) : lhs(lhs), rhs(rhs) {}
+
+  /**
+   * @brief Evaluate a single element using 1D indexing.
+   *
+   * @param[in] i position.
+   * @return value_type Result at pos i.
+   */
+  inline value_type operator()(size_t i) const {
+    return Op::apply(lhs(i), rhs(i));
+  }
+
+  inline size_t getNumRows() const { return lhs.getNumRows(); }
+  inline size_t getNumCols() const { return lhs.getNumCols(); }
+  inline std::pair<size_t, size_t> size() const { return lhs.size(); }
+
+ private:
+  /** @brief Left operand. */
+  ExprOperand<L> lhs;
+
+  /** @brief Right operand. */
+  ExprOperand<R> rhs;
+};
+
+/**
+ * @brief Element-wise operation between a matrix expression and a scalar.
+ *
+ * @tparam Op Operation functor.
+ * @tparam E Matrix expression type.
+ * @tparam S Scalar type.
+ * @tparam ScalarLeft True if the scalar is the left operand.
+ */
+template <typename Op, typename E, typename S, bool ScalarLeft>
+class MatrixScalarExpr
+    : public MatrixExpr<MatrixScalarExpr<Op, E, S, ScalarLeft>> {
+ public:
+  using value_type = std::conditional_t<
+      ScalarLeft,
+      decltype(Op::apply(std::declval<S>(),
+                         std::declval<typename E::value_type>())),
+      decltype(Op::apply(std::declval<typename E::value_type>(),
+                         std::declval<S>()))>;
+
+  static constexpr bool isLeaf = false;
+
+  /**
+   * @brief Construct a new MatrixScalarExpr object.
+   *
+   * @param[in] expr Matrix operand.
+   * @param[in] scalar Scalar operand.
+   */
+  MatrixScalarExpr(const E& expr, const S& scalar)
+      : expr(expr), scalar(scalar) {}
+
+  /**
+   * @brief Evaluate a single element using 1D indexing.
+   *
+   * @param[in] i position.
+   * @return value_type Result at pos i.
+   */
+  inline value_type operator()(size_t i) const {
+    if constexpr (ScalarLeft) {
+      return Op::apply(scalar, expr(i));
+    } else {
+      return Op::apply(expr(i), scalar);
+    }
+  }
+
+  inline size_t getNumRows() const { return expr.getNumRows(); }
+  inline size_t getNumCols() const { return expr.getNumCols(); }
+  inline std::pair<size_t, size_t> size() const { return expr.size(); }
+
+ private:
+  /** @brief Matrix operand. */
+  ExprOperand<E> expr;
+
+  /** @brief Scalar operand. */
+  S scalar;
+};
+
+/** @brief True if T can be used as the scalar operand of an expression. */
+template <typename T>
+inline constexpr bool isExprScalar = !isMatrixExpr<T>;
+
+/**
+ * @brief Matrix element-wise addition. A = C + B
+ *
+ * @param c original matrix C.
+ * @param b matrix to add with B.
+ * @return Lazy expression evaluated on assignment to a Matrix.
+ */
+template <typename L, typename R>
+MatrixBinaryExpr<ExprAdd, L, R> operator+(const MatrixExpr<L>& c,
+                                          const MatrixExpr<R>& b) {
+  assert(c.derived().size() == b.derived().size() &&
+         "Matrix elementwise addition have incorrect dimensions.");
+  return MatrixBinaryExpr<ExprAdd, L, R>(c.derived(), b.derived());
+}
+
+/**
+ * @brief Matrix element-wise subtraction. A = C - B
+ *
+ * @param c original matrix C.
+ * @param b matrix to subtract from C.
+ * @return Lazy expression evaluated on assignment to a Matrix.
+ */
+template <typename L, typename R>
+MatrixBinaryExpr<ExprSub, L, R> operator-(const MatrixExpr<L>& c,
+                                          const MatrixExpr<R>& b) {
+  assert(c.derived().size() == b.derived().size() &&
+         "Matrix elementwise subtraction have incorrect dimensions.");
+  return MatrixBinaryExpr<ExprSub, L, R>(c.derived(), b.derived());
+}
+
+/**
+ * @brief Matrix element-wise multiplication. A = C * B
+ *
+ * @param c original matrix C.
+ * @param b multiplier matrix B.
+ * @return Lazy expression evaluated on assignment to a Matrix.
+ */
+template <typename L, typename R>
+MatrixBinaryExpr<ExprMul, L, R> operator*(const MatrixExpr<L>& c,
+                                          const MatrixExpr<R>& b) {
+  assert(c.derived().size() == b.derived().size() &&
+         "Matrix elementwise multiplication have incorrect dimensions.");
+  return MatrixBinaryExpr<ExprMul, L, R>(c.derived(), b.derived());
+}
+
+/**
+ * @brief Matrix element-wise division. A = C / B
+ *
+ * @param c original matrix C.
+ * @param b divisor matrix B.
+ * @return Lazy expression evaluated on assignment to a Matrix.
+ */
+template <typename L, typename R>
+MatrixBinaryExpr<ExprDiv, L, R> operator/(const MatrixExpr<L>& c,
+                                          const MatrixExpr<R>& b) {
+  assert(c.derived().size() == b.derived().size() &&
+         "Matrix elementwise division have incorrect dimensions.");
+  return MatrixBinaryExpr<ExprDiv, L, R>(c.derived(), b.derived());
+}
+
+/**
+ * @brief Scale a matrix without modifying it. A = C * s
+ *
+ * @param c original matrix C.
+ * @param s scalar multiplier.
+ * @return Lazy expression evaluated on assignment to a Matrix.
+ */
+template <typename E, typename S,
+          typename = std::enable_if_t<isExprScalar<S>>>
+MatrixScalarExpr<ExprMul, E, S, false> operator*(const MatrixExpr<E>& c,
+                                                 const S& s) {
+  return MatrixScalarExpr<ExprMul, E, S, false>(c.derived(), s);
+}
+
+/**
+ * @brief Scale a matrix without modifying it. A = s * C
+ *
+ * @param s scalar multiplier.
+ * @param c original matrix C.
+ * @return Lazy expression evaluated on assignment to a Matrix.
+ */
+template <typename S, typename E,
+          typename = std::enable_if_t<isExprScalar<S>>>
+MatrixScalarExpr<ExprMul, E, S, true> operator*(const S& s,
+                                                const MatrixExpr<E>& c) {
+  return MatrixScalarExpr<ExprMul, E, S, true>(c.derived(), s);
+}
+
+/**
+ * @brief Divide every element of a matrix by a scalar. A = C / s
+ *
+ * @param c original matrix C.
+ * @param s scalar divisor.
+ * @return Lazy expression evaluated on assignment to a Matrix.
+ */
+template <typename E, typename S,
+          typename = std::enable_if_t<isExprScalar<S>>>
+MatrixScalarExpr<ExprDiv, E, S, false> operator/(const MatrixExpr<E>& c,
+                                                 const S& s) {
+  return MatrixScalarExpr<ExprDiv, E, S, false>(c.derived(), s);
+}
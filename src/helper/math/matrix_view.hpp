@@ -0,0 +1,376 @@
+/**
+ *******************************************************************************
+ * @file    matrix_view.hpp
+ * @brief   Non-owning views over matrix rows, columns and sub-blocks.
+ *******************************************************************************
+ */
+
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+
+/**
+ * @brief Non-owning view over elements spaced a fixed distance apart in
+ * memory. Element i is found at data[i * stride].
+ *
+ * @tparam T Element type. Use a const type for read-only views.
+ */
+template <typename T>
+class StridedSpan {
+ public:
+  /** @brief Random access iterator over a strided span. */
+  class iterator {
+   public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = std::remove_cv_t<T>;
+    using difference_type = std::ptrdiff_t;
+    using pointer = T*;
+    using reference = T&;
+
+    iterator() = default;
+    iterator(T* ptr, size_t step) : ptr(ptr), step(step) {}
+
+    inline reference operator*() const { return *ptr; }
+    inline pointer operator->() const { return ptr; }
+    inline reference operator[](difference_type n) const {
+      return ptr[n * static_cast<difference_type>(step)];
+    }
+
+    inline iterator& operator++() {
+      ptr += step;
+      return *this;
+    }
+    inline iterator operator++(int) {
+      iterator tmp = *this;
+      ptr += step;
+      return tmp;
+    }
+    inline iterator& operator--() {
+      ptr -= step;
+      return *this;
+    }
+    inline iterator operator--(int) {
+      iterator tmp = *this;
+      ptr -= step;
+      return tmp;
+    }
+    inline iterator& operator+=(difference_type n) {
+      ptr += n * static_cast<difference_type>(step);
+      return *this;
+    }
+    inline iterator& operator-=(difference_type n) {
+      ptr -= n * static_cast<difference_type>(step);
+      return *this;
+    }
+    inline iterator operator+(difference_type n) const {
+      return iterator(*this) += n;
+    }
+    inline iterator operator-(difference_type n) const {
+      return iterator(*this) -= n;
+    }
+    friend inline iterator operator+(difference_type n, const iterator& it) {
+      return it + n;
+    }
+    inline difference_type operator-(const iterator& other) const {
+      return (ptr - other.ptr) / static_cast<difference_type>(step);
+    }
+
+    inline bool operator==(const iterator& other) const {
+      return ptr == other.ptr;
+    }
+    inline bool operator!=(const iterator& other) const {
+      return ptr != other.ptr;
+    }
+    inline bool operator<(const iterator& other) const {
+      return ptr < other.ptr;
+    }
+    inline bool operator>(const iterator& other) const {
+      return ptr > other.ptr;
+    }
+    inline bool operator<=(const iterator& other) const {
+      return ptr <= other.ptr;
+    }
+    inline bool operator>=(const iterator& other) const {
+      return ptr >= other.ptr;
+    }
+
+   private:
+    /** @brief Current element. */
+    T* ptr{nullptr};
+
+    /** @brief Distance in elements between consecutive items. */
+    size_t step{1};
+  };
+
+  /** @brief Construct an empty span. */
+  StridedSpan() = default;
+
+  /**
+   * @brief Construct a new StridedSpan object.
+   *
+   * @param[in] data Pointer to the first element.
+   * @param[in] count The number of elements in the span.
+   * @param[in] stride Distance in elements between consecutive items.
+   */
+  StridedSpan(T* data, size_t count, size_t stride = 1)
+      : ptr(data), count(count), step(stride) {}
+
+  /** @brief Allow a mutable span to be used where a const span is expected. */
+  template <typename U,
+            typename = std::enable_if_t<std::is_same_v<const U, T> &&
+                                        !std::is_same_v<U, T>>>
+  StridedSpan(const StridedSpan<U>& other)
+      : ptr(other.data()), count(other.size()), step(other.stride()) {}
+
+  /**
+   * @brief Access element i of the span.
+   *
+   * @param[in] i Position in the span.
+   * @return T& Element at position i.
+   */
+  inline T& operator[](size_t i) const {
+    assert(i < count);
+    return ptr[i * step];
+  }
+
+  /** @brief Pointer to the first element. */
+  inline T* data() const { return ptr; }
+
+  /** @brief The number of elements in the span. */
+  inline size_t size() const { return count; }
+
+  /** @brief Distance in elements between consecutive items. */
+  inline size_t stride() const { return step; }
+
+  /** @brief True if the span holds no elements. */
+  inline bool empty() const { return count == 0; }
+
+  inline iterator begin() const { return iterator(ptr, step); }
+  inline iterator end() const { return iterator(ptr + count * step, step); }
+
+  /**
+   * @brief Get a contiguous sub range of the span.
+   *
+   * @param[in] offset First element of the sub range.
+   * @param[in] n The number of elements in the sub range.
+   * @return StridedSpan<T> Sub range view.
+   */
+  StridedSpan<T> subspan(size_t offset, size_t n) const {
+    assert(offset + n <= count);
+    return StridedSpan<T>(ptr + offset * step, n, step);
+  }
+
+  /**
+   * @brief Get every step-th element of the span, starting at offset.
+   *
+   * @param[in] offset First element of the slice.
+   * @param[in] n The number of elements in the slice.
+   * @param[in] sliceStep Distance between consecutive slice elements, measured
+   * in elements of this span.
+   * @return StridedSpan<T> Slice view.
+   */
+  StridedSpan<T> slice(size_t offset, size_t n, size_t sliceStep) const {
+    assert(n == 0 || offset + (n - 1) * sliceStep < count);
+    return StridedSpan<T>(ptr + offset * step, n, step * sliceStep);
+  }
+
+ private:
+  /** @brief Pointer to the first element. */
+  T* ptr{nullptr};
+
+  /** @brief The number of elements. */
+  size_t count{0};
+
+  /** @brief Distance in elements between consecutive items. */
+  size_t step{1};
+};
+
+/**
+ * @brief Non-owning view over a contiguous matrix row. Exposes a raw pointer so
+ * rows can be handed directly to routines such as the FFT.
+ *
+ * @tparam T Element type. Use a const type for read-only views.
+ */
+template <typename T>
+class RowView {
+ public:
+  using iterator = T*;
+
+  /** @brief Construct an empty view. */
+  RowView() = default;
+
+  /**
+   * @brief Construct a new RowView object.
+   *
+   * @param[in] data Pointer to the first element of the row.
+   * @param[in] count The number of elements in the row.
+   */
+  RowView(T* data, size_t count) : ptr(data), count(count) {}
+
+  /** @brief Allow a mutable view to be used where a const view is expected. */
+  template <typename U,
+            typename = std::enable_if_t<std::is_same_v<const U, T> &&
+                                        !std::is_same_v<U, T>>>
+  RowView(const RowView<U>& other) : ptr(other.data()), count(other.size()) {}
+
+  /**
+   * @brief Access element i of the row.
+   *
+   * @param[in] i Column position.
+   * @return T& Element at position i.
+   */
+  inline T& operator[](size_t i) const {
+    assert(i < count);
+    return ptr[i];
+  }
+
+  /** @brief Pointer to the first element. */
+  inline T* data() const { return ptr; }
+
+  /** @brief The number of elements in the row. */
+  inline size_t size() const { return count; }
+
+  /** @brief True if the row holds no elements. */
+  inline bool empty() const { return count == 0; }
+
+  inline iterator begin() const { return ptr; }
+  inline iterator end() const { return ptr + count; }
+
+  /**
+   * @brief Get a sub range of the row.
+   *
+   * @param[in] offset First element of the sub range.
+   * @param[in] n The number of elements in the sub range.
+   * @return RowView<T> Sub range view.
+   */
+  RowView<T> subspan(size_t offset, size_t n) const {
+    assert(offset + n <= count);
+    return RowView<T>(ptr + offset, n);
+  }
+
+  /** @brief View the row as a strided span with a stride of one. */
+  operator StridedSpan<T>() const { return StridedSpan<T>(ptr, count, 1); }
+
+ private:
+  /** @brief Pointer to the first element. */
+  T* ptr{nullptr};
+
+  /** @brief The number of elements. */
+  size_t count{0};
+};
+
+/** @brief Non-owning view over a matrix column. */
+template <typename T>
+using ColView = StridedSpan<T>;
+
+/**
+ * @brief Non-owning view over a rectangular sub-block of a row major matrix.
+ *
+ * @tparam T Element type. Use a const type for read-only views.
+ */
+template <typename T>
+class BlockView {
+ public:
+  /** @brief Construct an empty view. */
+  BlockView() = default;
+
+  /**
+   * @brief Construct a new BlockView object.
+   *
+   * @param[in] data Pointer to the top left cell of the block.
+   * @param[in] rows The number of rows in the block.
+   * @param[in] cols The number of columns in the block.
+   * @param[in] leadingDim Distance in elements between the start of
+   * consecutive rows. This is the column count of the parent matrix.
+   */
+  BlockView(T* data, size_t rows, size_t cols, size_t leadingDim)
+      : ptr(data), rows(rows), cols(cols), leadingDim(leadingDim) {}
+
+  /** @brief Allow a mutable view to be used where a const view is expected. */
+  template <typename U,
+            typename = std::enable_if_t<std::is_same_v<const U, T> &&
+                                        !std::is_same_v<U, T>>>
+  BlockView(const BlockView<U>& other)
+      : ptr(other.data()),
+        rows(other.getNumRows()),
+        cols(other.getNumCols()),
+        leadingDim(other.getLeadingDim()) {}
+
+  /**
+   * @brief Single cell access.
+   *
+   * @param[in] i row number within the block.
+   * @param[in] j column number within the block.
+   * @return T& value at cell (i, j).
+   */
+  inline T& operator()(size_t i, size_t j) const {
+    assert(i < rows && j < cols);
+    return ptr[i * leadingDim + j];
+  }
+
+  /** @brief Pointer to the top left cell. */
+  inline T* data() const { return ptr; }
+
+  /** @brief Return the number of rows in the block. */
+  inline size_t getNumRows() const { return rows; }
+
+  /** @brief Return the number of columns in the block. */
+  inline size_t getNumCols() const { return cols; }
+
+  /** @brief Distance in elements between the start of consecutive rows. */
+  inline size_t getLeadingDim() const { return leadingDim; }
+
+  /**
+   * @brief View a row of the block.
+   *
+   * @param[in] r Row number within the block.
+   * @return RowView<T> Row view.
+   */
+  RowView<T> row(size_t r) const {
+    assert(r < rows);
+    return RowView<T>(ptr + r * leadingDim, cols);
+  }
+
+  /**
+   * @brief View a column of the block.
+   *
+   * @param[in] c Column number within the block.
+   * @return ColView<T> Column view.
+   */
+  ColView<T> col(size_t c) const {
+    assert(c < cols);
+    return ColView<T>(ptr + c, rows, leadingDim);
+  }
+
+  /**
+   * @brief View a sub-block of this block.
+   *
+   * @param[in] r First row of the sub-block.
+   * @param[in] c First column of the sub-block.
+   * @param[in] numRows The number of rows in the sub-block.
+   * @param[in] numCols The number of columns in the sub-block.
+   * @return BlockView<T> Sub-block view.
+   */
+  BlockView<T> block(size_t r, size_t c, size_t numRows,
+                     size_t numCols) const {
+    assert(r + numRows <= rows && c + numCols <= cols);
+    return BlockView<T>(ptr + r * leadingDim + c, numRows, numCols,
+                        leadingDim);
+  }
+
+ private:
+  /** @brief Pointer to the top left cell. */
+  T* ptr{nullptr};
+
+  /** @brief The number of rows. */
+  size_t rows{0};
+
+  /** @brief The number of columns. */
+  size_t cols{0};
+
+  /** @brief Distance in elements between the start of consecutive rows. */
+  size_t leadingDim{0};
+};
@@ -0,0 +1,462 @@
+/**
+ *******************************************************************************
+ * @file    pcmKernels.cpp
+ * @brief   Conversion kernels between integer or float PCM and doubles.
+ *******************************************************************************
+ */
+
+#include "pcmKernels.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+/** @brief Largest positive 24 bit sample. */
+static const double INT24_MAX_VALUE = 8388607.0;
+
+#if defined(__AVX__) || defined(__SSE2__) || defined(_M_X64)
+#define PCM_KERNELS_SIMD
+
+// Four doubles at a time: one AVX register, or a pair of SSE2 registers. The
+// integer and float lanes are SSE2 registers either way.
+#if defined(__AVX__)
+using Vec4d = __m256d;
+
+static inline Vec4d set4(double v) { return _mm256_set1_pd(v); }
+static inline Vec4d setr4(double a, double b, double c, double d) {
+  return _mm256_setr_pd(a, b, c, d);
+}
+static inline Vec4d load4(const double* in) { return _mm256_loadu_pd(in); }
+static inline void store4(double* out, Vec4d v) { _mm256_storeu_pd(out, v); }
+static inline Vec4d add4(Vec4d a, Vec4d b) { return _mm256_add_pd(a, b); }
+static inline Vec4d mul4(Vec4d a, Vec4d b) { return _mm256_mul_pd(a, b); }
+static inline Vec4d div4(Vec4d a, Vec4d b) { return _mm256_div_pd(a, b); }
+static inline Vec4d min4(Vec4d a, Vec4d b) { return _mm256_min_pd(a, b); }
+static inline Vec4d max4(Vec4d a, Vec4d b) { return _mm256_max_pd(a, b); }
+static inline Vec4d fromInt4(__m128i v) { return _mm256_cvtepi32_pd(v); }
+static inline Vec4d fromFloat4(__m128 v) { return _mm256_cvtps_pd(v); }
+static inline __m128i truncToInt4(Vec4d v) { return _mm256_cvttpd_epi32(v); }
+static inline __m128i roundToInt4(Vec4d v) { return _mm256_cvtpd_epi32(v); }
+static inline __m128 toFloat4(Vec4d v) { return _mm256_cvtpd_ps(v); }
+#else
+struct Vec4d {
+  __m128d lo;
+  __m128d hi;
+};
+
+static inline Vec4d set4(double v) { return {_mm_set1_pd(v), _mm_set1_pd(v)}; }
+static inline Vec4d setr4(double a, double b, double c, double d) {
+  return {_mm_setr_pd(a, b), _mm_setr_pd(c, d)};
+}
+static inline Vec4d load4(const double* in) {
+  return {_mm_loadu_pd(in), _mm_loadu_pd(in + 2)};
+}
+static inline void store4(double* out, Vec4d v) {
+  _mm_storeu_pd(out, v.lo);
+  _mm_storeu_pd(out + 2, v.hi);
+}
+static inline Vec4d add4(Vec4d a, Vec4d b) {
+  return {_mm_add_pd(a.lo, b.lo), _mm_add_pd(a.hi, b.hi)};
+}
+static inline Vec4d mul4(Vec4d a, Vec4d b) {
+  return {_mm_mul_pd(a.lo, b.lo), _mm_mul_pd(a.hi, b.hi)};
+}
+static inline Vec4d div4(Vec4d a, Vec4d b) {
+  return {_mm_div_pd(a.lo, b.lo), _mm_div_pd(a.hi, b.hi)};
+}
+static inline Vec4d min4(Vec4d a, Vec4d b) {
+  return {_mm_min_pd(a.lo, b.lo), _mm_min_pd(a.hi, b.hi)};
+}
+static inline Vec4d max4(Vec4d a, Vec4d b) {
+  return {_mm_max_pd(a.lo, b.lo), _mm_max_pd(a.hi, b.hi)};
+}
+static inline Vec4d fromInt4(__m128i v) {
+  return {_mm_cvtepi32_pd(v), _mm_cvtepi32_pd(_mm_srli_si128(v, 8))};
+}
+static inline Vec4d fromFloat4(__m128 v) {
+  return {_mm_cvtps_pd(v), _mm_cvtps_pd(_mm_movehl_ps(v, v))};
+}
+static inline __m128i truncToInt4(Vec4d v) {
+  return _mm_unpacklo_epi64(_mm_cvttpd_epi32(v.lo), _mm_cvttpd_epi32(v.hi));
+}
+static inline __m128i roundToInt4(Vec4d v) {
+  return _mm_unpacklo_epi64(_mm_cvtpd_epi32(v.lo), _mm_cvtpd_epi32(v.hi));
+}
+static inline __m128 toFloat4(Vec4d v) {
+  return _mm_movelh_ps(_mm_cvtpd_ps(v.lo), _mm_cvtpd_ps(v.hi));
+}
+#endif
+
+/** @brief Four mono int16 samples as doubles. */
+static inline Vec4d loadMono4(const int16_t* in) {
+  __m128i v = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(in));
+  // Sign extend to 32 bits by shifting the duplicated sample down.
+  return fromInt4(_mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16));
+}
+
+/** @brief Four interleaved stereo int16 frames as doubles per channel. */
+static inline void loadStereo4(const int16_t* in, Vec4d& left, Vec4d& right) {
+  // Each 32 bit lane holds a frame with the left sample in the low half.
+  __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in));
+  left = fromInt4(_mm_srai_epi32(_mm_slli_epi32(v, 16), 16));
+  right = fromInt4(_mm_srai_epi32(v, 16));
+}
+
+/** @brief Four mono int32 samples as doubles. */
+static inline Vec4d loadMono4(const int32_t* in) {
+  return fromInt4(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in)));
+}
+
+/** @brief Four interleaved stereo int32 frames as doubles per channel. */
+static inline void loadStereo4(const int32_t* in, Vec4d& left, Vec4d& right) {
+  __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in));
+  __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 4));
+  a = _mm_shuffle_epi32(a, _MM_SHUFFLE(3, 1, 2, 0));
+  b = _mm_shuffle_epi32(b, _MM_SHUFFLE(3, 1, 2, 0));
+  left = fromInt4(_mm_unpacklo_epi64(a, b));
+  right = fromInt4(_mm_unpackhi_epi64(a, b));
+}
+
+/** @brief Four mono float samples as doubles. */
+static inline Vec4d loadMono4(const float* in) {
+  return fromFloat4(_mm_loadu_ps(in));
+}
+
+/** @brief Four interleaved stereo float frames as doubles per channel. */
+static inline void loadStereo4(const float* in, Vec4d& left, Vec4d& right) {
+  __m128 a = _mm_loadu_ps(in);
+  __m128 b = _mm_loadu_ps(in + 4);
+  left = fromFloat4(_mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+  right = fromFloat4(_mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+}
+#endif
+
+/** @brief Normalize interleaved samples into one array per channel. */
+template <typename Sample>
+static void splitChannels(const Sample* in, size_t numChannels,
+                          size_t numFrames, double scale, double* const* out) {
+  size_t i = 0;
+
+#if defined(PCM_KERNELS_SIMD)
+  const Vec4d scale4 = set4(scale);
+  if (numChannels == 1) {
+    for (; i + 4 <= numFrames; i += 4) {
+      store4(out[0] + i, div4(loadMono4(in + i), scale4));
+    }
+  } else if (numChannels == 2) {
+    for (; i + 4 <= numFrames; i += 4) {
+      Vec4d left, right;
+      loadStereo4(in + 2 * i, left, right);
+      store4(out[0] + i, div4(left, scale4));
+      store4(out[1] + i, div4(right, scale4));
+    }
+  }
+#endif
+
+  for (; i < numFrames; i++) {
+    for (size_t c = 0; c < numChannels; c++) {
+      out[c][i] = static_cast<double>(in[i * numChannels + c]) / scale;
+    }
+  }
+}
+
+/** @brief Normalize interleaved samples and average the channels. */
+template <typename Sample>
+static void mixToMono(const Sample* in, size_t numChannels, size_t numFrames,
+                      double scale, double* out) {
+  size_t i = 0;
+
+#if defined(PCM_KERNELS_SIMD)
+  const Vec4d scale4 = set4(scale);
+  if (numChannels == 1) {
+    for (; i + 4 <= numFrames; i += 4) {
+      store4(out + i, div4(loadMono4(in + i), scale4));
+    }
+  } else if (numChannels == 2) {
+    // Halving is exact, so multiplying matches the scalar division by 2.
+    const Vec4d half = set4(0.5);
+    for (; i + 4 <= numFrames; i += 4) {
+      Vec4d left, right;
+      loadStereo4(in + 2 * i, left, right);
+      Vec4d sum = add4(div4(left, scale4), div4(right, scale4));
+      store4(out + i, mul4(sum, half));
+    }
+  }
+#endif
+
+  for (; i < numFrames; i++) {
+    const Sample* frame = in + i * numChannels;
+    double sum = static_cast<double>(frame[0]) / scale;
+    for (size_t c = 1; c < numChannels; c++) {
+      sum += static_cast<double>(frame[c]) / scale;
+    }
+    out[i] = sum / static_cast<double>(numChannels);
+  }
+}
+
+/** @brief Stores quantized samples as interleaved offset binary bytes. */
+struct UInt8Writer {
+  uint8_t* out;
+
+  void scalar(size_t index, int32_t value) {
+    out[index] = static_cast<uint8_t>(value + 128);
+  }
+
+#if defined(PCM_KERNELS_SIMD)
+  void mono4(size_t frame, __m128i v) {
+    const int32_t bytes = _mm_cvtsi128_si32(toBytes(_mm_packs_epi32(v, v)));
+    std::memcpy(out + frame, &bytes, sizeof(bytes));
+  }
+
+  void stereo4(size_t frame, __m128i left, __m128i right) {
+    __m128i samples = _mm_packs_epi32(_mm_unpacklo_epi32(left, right),
+                                      _mm_unpackhi_epi32(left, right));
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(out + 2 * frame),
+                     toBytes(samples));
+  }
+
+  /** @brief Offset eight int16 samples by 128 and narrow them to bytes. */
+  static __m128i toBytes(__m128i samples) {
+    samples = _mm_add_epi16(samples, _mm_set1_epi16(128));
+    return _mm_packus_epi16(samples, samples);
+  }
+#endif
+};
+
+/** @brief Stores quantized samples as interleaved int16. */
+struct Int16Writer {
+  int16_t* out;
+
+  void scalar(size_t index, int32_t value) {
+    out[index] = static_cast<int16_t>(value);
+  }
+
+#if defined(PCM_KERNELS_SIMD)
+  void mono4(size_t frame, __m128i v) {
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(out + frame),
+                     _mm_packs_epi32(v, v));
+  }
+
+  void stereo4(size_t frame, __m128i left, __m128i right) {
+    __m128i first = _mm_unpacklo_epi32(left, right);
+    __m128i second = _mm_unpackhi_epi32(left, right);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 2 * frame),
+                     _mm_packs_epi32(first, second));
+  }
+#endif
+};
+
+/** @brief Stores quantized samples as interleaved, packed 24 bit bytes. */
+struct Int24Writer {
+  uint8_t* out;
+
+  void scalar(size_t index, int32_t value) {
+    const uint32_t bits = static_cast<uint32_t>(value);
+    out[3 * index] = static_cast<uint8_t>(bits);
+    out[3 * index + 1] = static_cast<uint8_t>(bits >> 8);
+    out[3 * index + 2] = static_cast<uint8_t>(bits >> 16);
+  }
+
+#if defined(PCM_KERNELS_SIMD)
+  void mono4(size_t frame, __m128i v) {
+    int32_t values[4];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(values), v);
+    for (size_t k = 0; k < 4; k++) {
+      scalar(frame + k, values[k]);
+    }
+  }
+
+  void stereo4(size_t frame, __m128i left, __m128i right) {
+    int32_t values[8];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(values),
+                     _mm_unpacklo_epi32(left, right));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(values + 4),
+                     _mm_unpackhi_epi32(left, right));
+    for (size_t k = 0; k < 8; k++) {
+      scalar(2 * frame + k, values[k]);
+    }
+  }
+#endif
+};
+
+/** @brief Stores quantized samples as interleaved int32. */
+struct Int32Writer {
+  int32_t* out;
+
+  void scalar(size_t index, int32_t value) { out[index] = value; }
+
+#if defined(PCM_KERNELS_SIMD)
+  void mono4(size_t frame, __m128i v) {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + frame), v);
+  }
+
+  void stereo4(size_t frame, __m128i left, __m128i right) {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 2 * frame),
+                     _mm_unpacklo_epi32(left, right));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 2 * frame + 4),
+                     _mm_unpackhi_epi32(left, right));
+  }
+#endif
+};
+
+/**
+ * @brief Clamp, scale, dither and quantize samples, then hand them to the
+ * writer in interleaved order. Dither noise is drawn in interleaved order on
+ * every path.
+ */
+template <typename Writer>
+static void quantize(const double* const* in, size_t numChannels,
+                     size_t numFrames, double scale, TPDFDither* dither,
+                     Writer writer) {
+  // Dithered samples may reach one LSB past full scale.
+  const double low = -scale - 1.0;
+  size_t i = 0;
+
+#if defined(PCM_KERNELS_SIMD)
+  if (numChannels == 1 || numChannels == 2) {
+    const Vec4d one = set4(1.0);
+    const Vec4d minusOne = set4(-1.0);
+    const Vec4d scale4 = set4(scale);
+    const Vec4d low4 = set4(low);
+
+    for (; i + 4 <= numFrames; i += 4) {
+      double noise[8];
+      if (dither != nullptr) {
+        for (size_t k = 0; k < 4 * numChannels; k++) {
+          noise[k] = dither->next();
+        }
+      }
+
+      __m128i lanes[2];
+      for (size_t c = 0; c < numChannels; c++) {
+        Vec4d x = max4(load4(in[c] + i), minusOne);
+        x = mul4(min4(x, one), scale4);
+        if (dither != nullptr) {
+          const double* n = noise + c;
+          x = add4(x, setr4(n[0], n[numChannels], n[2 * numChannels],
+                            n[3 * numChannels]));
+          lanes[c] = roundToInt4(min4(max4(x, low4), scale4));
+        } else {
+          lanes[c] = truncToInt4(x);
+        }
+      }
+
+      if (numChannels == 1) {
+        writer.mono4(i, lanes[0]);
+      } else {
+        writer.stereo4(i, lanes[0], lanes[1]);
+      }
+    }
+  }
+#endif
+
+  for (; i < numFrames; i++) {
+    for (size_t c = 0; c < numChannels; c++) {
+      double x = std::clamp(in[c][i], -1.0, 1.0) * scale;
+      int32_t value;
+      if (dither != nullptr) {
+        x = std::clamp(x + dither->next(), low, scale);
+        value = static_cast<int32_t>(std::nearbyint(x));
+      } else {
+        value = static_cast<int32_t>(x);
+      }
+      writer.scalar(i * numChannels + c, value);
+    }
+  }
+}
+
+TPDFDither::TPDFDither(uint64_t seed) : state(seed == 0 ? 1 : seed) {}
+
+double TPDFDither::next() { return uniform() - uniform(); }
+
+double TPDFDither::uniform() {
+  // xorshift64*, keeping the top 53 bits.
+  state ^= state >> 12;
+  state ^= state << 25;
+  state ^= state >> 27;
+  const uint64_t bits = (state * 0x2545F4914F6CDD1DULL) >> 11;
+  return static_cast<double>(bits) / 9007199254740992.0;
+}
+
+void int16ToDouble(const int16_t* in, size_t numChannels, size_t numFrames,
+                   double* const* out) {
+  splitChannels(in, numChannels, numFrames, INT16_MAX, out);
+}
+
+void int32ToDouble(const int32_t* in, size_t numChannels, size_t numFrames,
+                   double* const* out) {
+  splitChannels(in, numChannels, numFrames, INT32_MAX, out);
+}
+
+void floatToDouble(const float* in, size_t numChannels, size_t numFrames,
+                   double* const* out) {
+  splitChannels(in, numChannels, numFrames, 1.0, out);
+}
+
+void int16ToMono(const int16_t* in, size_t numChannels, size_t numFrames,
+                 double* out) {
+  mixToMono(in, numChannels, numFrames, INT16_MAX, out);
+}
+
+void int32ToMono(const int32_t* in, size_t numChannels, size_t numFrames,
+                 double* out) {
+  mixToMono(in, numChannels, numFrames, INT32_MAX, out);
+}
+
+void floatToMono(const float* in, size_t numChannels, size_t numFrames,
+                 double* out) {
+  mixToMono(in, numChannels, numFrames, 1.0, out);
+}
+
+void doubleToUInt8(const double* const* in, size_t numChannels,
+                   size_t numFrames, uint8_t* out, TPDFDither* dither) {
+  quantize(in, numChannels, numFrames, INT8_MAX, dither, UInt8Writer{out});
+}
+
+void doubleToInt16(const double* const* in, size_t numChannels,
+                   size_t numFrames, int16_t* out, TPDFDither* dither) {
+  quantize(in, numChannels, numFrames, INT16_MAX, dither, Int16Writer{out});
+}
+
+void doubleToInt24(const double* const* in, size_t numChannels,
+                   size_t numFrames, uint8_t* out, TPDFDither* dither) {
+  quantize(in, numChannels, numFrames, INT24_MAX_VALUE, dither,
+           Int24Writer{out});
+}
+
+void doubleToInt32(const double* const* in, size_t numChannels,
+                   size_t numFrames, int32_t* out, TPDFDither* dither) {
+  quantize(in, numChannels, numFrames, INT32_MAX, dither, Int32Writer{out});
+}
+
+void doubleToFloat(const double* const* in, size_t numChannels,
+                   size_t numFrames, float* out) {
+  size_t i = 0;
+
+#if defined(PCM_KERNELS_SIMD)
+  if (numChannels == 1) {
+    for (; i + 4 <= numFrames; i += 4) {
+      _mm_storeu_ps(out + i, toFloat4(load4(in[0] + i)));
+    }
+  } else if (numChannels == 2) {
+    for (; i + 4 <= numFrames; i += 4) {
+      __m128 left = toFloat4(load4(in[0] + i));
+      __m128 right = toFloat4(load4(in[1] + i));
+      _mm_storeu_ps(out + 2 * i, _mm_unpacklo_ps(left, right));
+      _mm_storeu_ps(out + 2 * i + 4, _mm_unpackhi_ps(left, right));
+    }
+  }
+#endif
+
+  for (; i < numFrames; i++) {
+    for (size_t c = 0; c < numChannels; c++) {
+      out[i * numChannels + c] = static_cast<float>(in[c][i]);
+    }
+  }
+}
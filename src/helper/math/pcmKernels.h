@@ -0,0 +1,189 @@
+/**
+ *******************************************************************************
+ * @file    pcmKernels.h
+ * @brief   Conversion kernels between integer or float PCM and doubles.
+ *
+ * Decoding kernels normalize interleaved int16, int32 or float samples to
+ * doubles, either split into one array per channel or down mixed to mono.
+ * Encoding kernels clamp doubles to [-1, 1], scale them to the target format,
+ * optionally add TPDF dither and interleave the channels. Mono and stereo
+ * run with SIMD registers (AVX when the compiler targets it, SSE2 otherwise)
+ * and any remainder or other channel count with scalar code. Both give the
+ * same result as the scalar formulas documented on each kernel.
+ *******************************************************************************
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Triangular probability density (TPDF) dither noise.
+ *
+ * Each value is the difference of two uniform values in [0, 1), so it lies in
+ * (-1, 1) LSB with a triangular distribution. The generator is seeded, so a
+ * given seed always gives the same output file.
+ */
+class TPDFDither {
+ public:
+  /**
+   * @brief Construct a new TPDFDither object.
+   *
+   * @param[in] seed Seed of the generator. Zero is replaced by one.
+   */
+  explicit TPDFDither(uint64_t seed = 1);
+
+  /** @brief The next noise value in LSB. */
+  double next();
+
+ private:
+  /** @brief Next uniform value in [0, 1). */
+  double uniform();
+
+  /** @brief Generator state. Never zero. */
+  uint64_t state;
+};
+
+/**
+ * @brief Normalize interleaved int16 samples and split the channels.
+ * out[c][i] = in[i * numChannels + c] / INT16_MAX
+ *
+ * @param[in] in Interleaved samples.
+ * @param[in] numChannels The number of channels.
+ * @param[in] numFrames The number of samples per channel.
+ * @param[out] out One destination per channel.
+ */
+void int16ToDouble(const int16_t* in, size_t numChannels, size_t numFrames,
+                   double* const* out);
+
+/**
+ * @brief Normalize interleaved int32 samples and split the channels.
+ * out[c][i] = in[i * numChannels + c] / INT32_MAX
+ *
+ * @param[in] in Interleaved samples.
+ * @param[in] numChannels The number of channels.
+ * @param[in] numFrames The number of samples per channel.
+ * @param[out] out One destination per channel.
+ */
+void int32ToDouble(const int32_t* in, size_t numChannels, size_t numFrames,
+                   double* const* out);
+
+/**
+ * @brief Widen interleaved float samples and split the channels.
+ *
+ * @param[in] in Interleaved samples.
+ * @param[in] numChannels The number of channels.
+ * @param[in] numFrames The number of samples per channel.
+ * @param[out] out One destination per channel.
+ */
+void floatToDouble(const float* in, size_t numChannels, size_t numFrames,
+                   double* const* out);
+
+/**
+ * @brief Normalize interleaved int16 samples and down mix them to mono.
+ * Stereo gives out[i] = (l / INT16_MAX + r / INT16_MAX) / 2.
+ *
+ * @param[in] in Interleaved samples.
+ * @param[in] numChannels The number of channels.
+ * @param[in] numFrames The number of samples per channel.
+ * @param[out] out Destination of numFrames samples.
+ */
+void int16ToMono(const int16_t* in, size_t numChannels, size_t numFrames,
+                 double* out);
+
+/**
+ * @brief Normalize interleaved int32 samples and down mix them to mono.
+ * Stereo gives out[i] = (l / INT32_MAX + r / INT32_MAX) / 2.
+ *
+ * @param[in] in Interleaved samples.
+ * @param[in] numChannels The number of channels.
+ * @param[in] numFrames The number of samples per channel.
+ * @param[out] out Destination of numFrames samples.
+ */
+void int32ToMono(const int32_t* in, size_t numChannels, size_t numFrames,
+                 double* out);
+
+/**
+ * @brief Widen interleaved float samples and down mix them to mono.
+ * Stereo gives out[i] = (l + r) / 2.
+ *
+ * @param[in] in Interleaved samples.
+ * @param[in] numChannels The number of channels.
+ * @param[in] numFrames The number of samples per channel.
+ * @param[out] out Destination of numFrames samples.
+ */
+void floatToMono(const float* in, size_t numChannels, size_t numFrames,
+                 double* out);
+
+/**
+ * @brief Quantize doubles to interleaved unsigned 8 bit samples, with 128 as
+ * silence. Same rules as doubleToInt16 with a scale of INT8_MAX, then offset
+ * by 128.
+ *
+ * @param[in] in One source per channel.
+ * @param[in] numChannels The number of channels.
+ * @param[in] numFrames The number of samples per channel.
+ * @param[out] out numChannels * numFrames interleaved samples.
+ * @param[in,out] dither Dither noise source, or nullptr for no dither.
+ */
+void doubleToUInt8(const double* const* in, size_t numChannels,
+                   size_t numFrames, uint8_t* out,
+                   TPDFDither* dither = nullptr);
+
+/**
+ * @brief Quantize doubles to interleaved int16 samples.
+ *
+ * Without dither a sample is trunc(clamp(x, -1, 1) * INT16_MAX). With dither
+ * the noise is added after scaling and the result is rounded to the nearest
+ * integer and clamped to the int16 range.
+ *
+ * @param[in] in One source per channel.
+ * @param[in] numChannels The number of channels.
+ * @param[in] numFrames The number of samples per channel.
+ * @param[out] out numChannels * numFrames interleaved samples.
+ * @param[in,out] dither Dither noise source, or nullptr for no dither.
+ */
+void doubleToInt16(const double* const* in, size_t numChannels,
+                   size_t numFrames, int16_t* out,
+                   TPDFDither* dither = nullptr);
+
+/**
+ * @brief Quantize doubles to interleaved, packed little endian 24 bit
+ * samples. Same rules as doubleToInt16 with a scale of 2^23 - 1.
+ *
+ * @param[in] in One source per channel.
+ * @param[in] numChannels The number of channels.
+ * @param[in] numFrames The number of samples per channel.
+ * @param[out] out 3 * numChannels * numFrames bytes.
+ * @param[in,out] dither Dither noise source, or nullptr for no dither.
+ */
+void doubleToInt24(const double* const* in, size_t numChannels,
+                   size_t numFrames, uint8_t* out,
+                   TPDFDither* dither = nullptr);
+
+/**
+ * @brief Quantize doubles to interleaved int32 samples. Same rules as
+ * doubleToInt16 with a scale of INT32_MAX.
+ *
+ * @param[in] in One source per channel.
+ * @param[in] numChannels The number of channels.
+ * @param[in] numFrames The number of samples per channel.
+ * @param[out] out numChannels * numFrames interleaved samples.
+ * @param[in,out] dither Dither noise source, or nullptr for no dither.
+ */
+void doubleToInt32(const double* const* in, size_t numChannels,
+                   size_t numFrames, int32_t* out,
+                   TPDFDither* dither = nullptr);
+
+/**
+ * @brief Narrow doubles to interleaved float samples. Float keeps headroom
+ * above full scale, so samples are not clamped.
+ *
+ * @param[in] in One source per channel.
+ * @param[in] numChannels The number of channels.
+ * @param[in] numFrames The number of samples per channel.
+ * @param[out] out numChannels * numFrames interleaved samples.
+ */
+void doubleToFloat(const double* const* in, size_t numChannels,
+                   size_t numFrames, float* out);
@@ -0,0 +1,221 @@
+/**
+ *******************************************************************************
+ * @file    splitComplexMatrix.hpp
+ * @brief   Complex matrix with separate real and imaginary planes.
+ *
+ * Matrix<std::complex<double>> stores each element as an interleaved
+ * (real, imag) pair, so element-wise math such as magnitudes and masking has
+ * to shuffle lanes before it can vectorize. SplitComplexMatrix keeps the real
+ * and imaginary parts in two aligned matrices of the same shape, which lets
+ * the kernels in complexKernels.h process several elements per instruction.
+ *******************************************************************************
+ */
+
+#pragma once
+
+#include <cassert>
+#include <complex>
+
+#include "complexKernels.h"
+#include "matrix.hpp"
+
+/** @brief Complex matrix stored as separate real and imaginary planes. */
+class SplitComplexMatrix {
+ public:
+  /** @brief Construct a new SplitComplexMatrix object. */
+  SplitComplexMatrix() = default;
+
+  /**
+   * @brief Construct a new SplitComplexMatrix object filled with zeros.
+   *
+   * @param[in] rows The number of rows.
+   * @param[in] cols The number of columns.
+   */
+  SplitComplexMatrix(size_t rows, size_t cols)
+      : re(rows, cols), im(rows, cols) {}
+
+  /**
+   * @brief Read a single cell.
+   *
+   * @param[in] i row number.
+   * @param[in] j column number.
+   * @return std::complex<double> value at cell (i, j).
+   */
+  inline std::complex<double> operator()(size_t i, size_t j) const {
+    return {re(i, j), im(i, j)};
+  }
+
+  /**
+   * @brief Read a single cell using 1D indexing.
+   *
+   * @param[in] i position.
+   * @return std::complex<double> value at pos i.
+   */
+  inline std::complex<double> operator()(size_t i) const {
+    return {re(i), im(i)};
+  }
+
+  /**
+   * @brief Write a single cell.
+   *
+   * @param[in] i row number.
+   * @param[in] j column number.
+   * @param[in] value New value.
+   */
+  inline void set(size_t i, size_t j, const std::complex<double>& value) {
+    re(i, j) = value.real();
+    im(i, j) = value.imag();
+  }
+
+  /**
+   * @brief Write a single cell using 1D indexing.
+   *
+   * @param[in] i position.
+   * @param[in] value New value.
+   */
+  inline void set(size_t i, const std::complex<double>& value) {
+    re(i) = value.real();
+    im(i) = value.imag();
+  }
+
+  /** @brief Real plane. */
+  inline Matrix<double>& real() { return re; }
+  inline const Matrix<double>& real() const { return re; }
+
+  /** @brief Imaginary plane. */
+  inline Matrix<double>& imag() { return im; }
+  inline const Matrix<double>& imag() const { return im; }
+
+  /**
+   * @brief Returns the size of the matrix.
+   *
+   * @return std::pair<size_t, size_t> Pair where first item is number of rows
+   * and second item is number of columns.
+   */
+  inline std::pair<size_t, size_t> size() const { return re.size(); }
+
+  /**
+   * @brief Resizes both planes.
+   *
+   * @param[in] newSize Pair where the first item is number of rows and second
+   * item is number of columns.
+   */
+  void resize(std::pair<size_t, size_t> newSize) {
+    re.resize(newSize);
+    im.resize(newSize);
+  }
+
+  /** @brief Return the number of rows in the matrix. */
+  inline size_t getNumRows() const { return re.getNumRows(); }
+
+  /** @brief Return the number of columns in the matrix. */
+  inline size_t getNumCols() const { return re.getNumCols(); }
+
+  /** @brief Get the number of elements in the matrix. */
+  inline size_t getNumElements() const { return re.getNumElements(); }
+
+ private:
+  /** @brief Real parts. */
+  Matrix<double> re{};
+
+  /** @brief Imaginary parts. */
+  Matrix<double> im{};
+};
+
+/**
+ * @brief Convert an interleaved complex matrix to split layout.
+ *
+ * @param[in] in Interleaved complex matrix.
+ * @param[out] out Split complex matrix. Resized to match @ref in.
+ */
+template <typename Allocator>
+void toSplitComplex(const Matrix<std::complex<double>, Allocator>& in,
+                    SplitComplexMatrix& out) {
+  out.resize(in.size());
+  const size_t n = in.getNumElements();
+
+  for (size_t i = 0; i < n; i++) {
+    out.set(i, in(i));
+  }
+}
+
+/**
+ * @brief Convert a split complex matrix to interleaved layout.
+ *
+ * @param[in] in Split complex matrix.
+ * @param[out] out Interleaved complex matrix. Resized to match @ref in.
+ */
+template <typename Allocator>
+void toInterleaved(const SplitComplexMatrix& in,
+                   Matrix<std::complex<double>, Allocator>& out) {
+  out.resize(in.size());
+  const size_t n = in.getNumElements();
+
+  for (size_t i = 0; i < n; i++) {
+    out(i) = in(i);
+  }
+}
+
+/**
+ * @brief Squared magnitude of every element, i.e. a power spectrum.
+ *
+ * @param[in] X Split complex matrix.
+ * @param[out] out Squared magnitudes. Resized to match @ref X.
+ */
+inline void complexNorm(const SplitComplexMatrix& X, Matrix<double>& out) {
+  out.resize(X.size());
+  if (X.getNumElements() == 0) return;
+
+  complexNorm(X.real().getRowPtr(0), X.imag().getRowPtr(0), out.getRowPtr(0),
+              X.getNumElements());
+}
+
+/**
+ * @brief Magnitude of every element, i.e. a magnitude spectrum.
+ *
+ * @param[in] X Split complex matrix.
+ * @param[out] out Magnitudes. Resized to match @ref X.
+ */
+inline void complexAbs(const SplitComplexMatrix& X, Matrix<double>& out) {
+  out.resize(X.size());
+  if (X.getNumElements() == 0) return;
+
+  complexAbs(X.real().getRowPtr(0), X.imag().getRowPtr(0), out.getRowPtr(0),
+             X.getNumElements());
+}
+
+/**
+ * @brief Apply a real mask to a complex matrix. out = X * mask
+ *
+ * @param[in] X Split complex matrix.
+ * @param[in] mask Real weights with the same dimensions as @ref X.
+ * @param[out] out Masked matrix. Resized to match @ref X. May be @ref X.
+ */
+inline void complexScale(const SplitComplexMatrix& X,
+                         const Matrix<double>& mask, SplitComplexMatrix& out) {
+  assert(X.size() == mask.size() &&
+         "Matrix elementwise multiplication have incorrect dimensions.");
+  out.resize(X.size());
+  if (X.getNumElements() == 0) return;
+
+  complexScale(X.real().getRowPtr(0), X.imag().getRowPtr(0),
+               mask.getRowPtr(0), out.real().getRowPtr(0),
+               out.imag().getRowPtr(0), X.getNumElements());
+}
+
+/**
+ * @brief Scale a complex matrix by a real scalar. out = X * scalar
+ *
+ * @param[in] X Split complex matrix.
+ * @param[in] scalar Real multiplier.
+ * @param[out] out Scaled matrix. Resized to match @ref X. May be @ref X.
+ */
+inline void complexScale(const SplitComplexMatrix& X, double scalar,
+                         SplitComplexMatrix& out) {
+  out.resize(X.size());
+  if (X.getNumElements() == 0) return;
+
+  complexScale(X.real().getRowPtr(0), X.imag().getRowPtr(0), scalar,
+               out.real().getRowPtr(0), out.imag().getRowPtr(0),
+               X.getNumElements());
+}
@@ -32,6 +32,35 @@ T median(std::vector<T>& vec) {
   }
 }
 
+/**
+ * @brief Computes the median of a range without modifying it. The range is
+ * copied into a caller owned scratch buffer so repeated calls, such as a
+ * sliding median filter, do not allocate.
+ *
+ * @tparam T Type of the values.
+ * @tparam View Any range with size() and begin(), e.g. RowView or StridedSpan.
+ * @param[in] view Values to compute the median on.
+ * @param[in,out] scratch Reusable buffer. Contents are overwritten.
+ * @return T The median of the range.
+ */
+template <typename T, typename View>
+T median(const View& view, std::vector<T>& scratch) {
+  assert(view.size() > 0);
+  scratch.assign(view.begin(), view.end());
+
+  size_t midPos = scratch.size() / 2;
+  auto mid = scratch.begin() + midPos;
+  std::nth_element(scratch.begin(), mid, scratch.end());
+
+  if (scratch.size() % 2 == 0) {
+    // Lower middle value is the largest value left of the upper middle value.
+    T lower = *std::max_element(scratch.begin(), mid);
+    return (*mid + lower) / 2;
+  } else {
+    return *mid;
+  }
+}
+
 /**
  * @brief Return the index of the maximum value within a specified range of a
  * vector.
@@ -0,0 +1,71 @@
+/**
+ *******************************************************************************
+ * @file    alignedAllocator.hpp
+ * @brief   Aligned standard allocator backed by a memory resource.
+ *******************************************************************************
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+#include "memoryResource.h"
+
+/**
+ * @brief Standard allocator that draws MEMORY_ALIGNMENT aligned blocks from
+ * the shared MemoryPool. It holds no state, so every instance is equal and
+ * containers can swap or move storage freely.
+ *
+ * @tparam T Element type.
+ */
+template <typename T>
+class AlignedAllocator {
+ public:
+  using value_type = T;
+  using is_always_equal = std::true_type;
+
+  /** @brief Construct an allocator using the default memory resource. */
+  AlignedAllocator() noexcept = default;
+
+  template <typename U>
+  AlignedAllocator(const AlignedAllocator<U>& /*other*/) noexcept {}
+
+  /**
+   * @brief Allocate storage for n elements.
+   *
+   * @param[in] n Number of elements.
+   * @return T* Aligned storage.
+   */
+  T* allocate(size_t n) {
+    return static_cast<T*>(getResource()->allocate(n * sizeof(T)));
+  }
+
+  /**
+   * @brief Release storage for n elements.
+   *
+   * @param[in] ptr Storage returned by allocate().
+   * @param[in] n Number of elements.
+   */
+  void deallocate(T* ptr, size_t n) {
+    getResource()->deallocate(ptr, n * sizeof(T));
+  }
+
+  /** @brief Get the memory resource in use. */
+  MemoryResource* getResource() const { return getDefaultMemoryResource(); }
+
+  template <typename U>
+  bool operator==(const AlignedAllocator<U>& /*other*/) const {
+    return true;
+  }
+
+  template <typename U>
+  bool operator!=(const AlignedAllocator<U>& /*other*/) const {
+    return false;
+  }
+};
+
+/** @brief Vector with aligned, pooled storage. */
+template <typename T>
+using AlignedVector = std::vector<T, AlignedAllocator<T>>;
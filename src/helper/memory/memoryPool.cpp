@@ -0,0 +1,144 @@
+/**
+ *******************************************************************************
+ * @file    memoryPool.cpp
+ * @brief   Size-class memory pool source.
+ *******************************************************************************
+ */
+
+#include "memoryPool.h"
+
+#include <algorithm>
+#include <new>
+
+#include "constants.h"
+
+/** @brief Smallest size class. */
+static constexpr size_t MIN_SIZE_CLASS = MEMORY_ALIGNMENT;
+
+/** @brief Classes up to this size are powers of two. */
+static constexpr size_t POWER_OF_TWO_CLASS_LIMIT = 4 * MEMORY_ALIGNMENT;
+
+static void* systemAllocate(size_t bytes) {
+  return ::operator new(bytes, std::align_val_t{MEMORY_ALIGNMENT});
+}
+
+static void systemDeallocate(void* ptr) {
+  ::operator delete(ptr, std::align_val_t{MEMORY_ALIGNMENT});
+}
+
+MemoryPool::MemoryPool(size_t cacheLimit) : cacheLimit(cacheLimit) {}
+
+MemoryPool::~MemoryPool() { trim(); }
+
+void* MemoryPool::allocate(size_t bytes) {
+  const size_t sizeClass = getSizeClass(bytes);
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stats.numAllocations++;
+    stats.bytesInUse += sizeClass;
+    stats.peakBytesInUse = std::max(stats.peakBytesInUse, stats.bytesInUse);
+
+    // Reuse a cached block of the same class if one is available.
+    auto it = freeLists.find(sizeClass);
+    if (it != freeLists.end() && !it->second.empty()) {
+      void* ptr = it->second.back();
+      it->second.pop_back();
+      stats.numReused++;
+      stats.bytesCached -= sizeClass;
+      return ptr;
+    }
+
+    stats.numSystemAllocations++;
+  }
+
+  try {
+    return systemAllocate(sizeClass);
+  } catch (...) {
+    std::lock_guard<std::mutex> lock(mutex);
+    stats.bytesInUse -= sizeClass;
+    throw;
+  }
+}
+
+void MemoryPool::deallocate(void* ptr, size_t bytes) {
+  if (ptr == nullptr) {
+    return;
+  }
+
+  const size_t sizeClass = getSizeClass(bytes);
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stats.bytesInUse -= sizeClass;
+
+    if (stats.bytesCached + sizeClass <= cacheLimit) {
+      freeLists[sizeClass].push_back(ptr);
+      stats.bytesCached += sizeClass;
+      return;
+    }
+  }
+
+  // Cache is full, give the block back to the system.
+  systemDeallocate(ptr);
+}
+
+MemoryStats MemoryPool::getStats() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  return stats;
+}
+
+void MemoryPool::resetPeak() {
+  std::lock_guard<std::mutex> lock(mutex);
+  stats.peakBytesInUse = stats.bytesInUse;
+}
+
+void MemoryPool::trim() {
+  std::unordered_map<size_t, std::vector<void*>> released;
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    released.swap(freeLists);
+    stats.bytesCached = 0;
+  }
+
+  for (auto& [sizeClass, blocks] : released) {
+    for (void* ptr : blocks) {
+      systemDeallocate(ptr);
+    }
+  }
+}
+
+void MemoryPool::setCacheLimit(size_t bytes) {
+  std::lock_guard<std::mutex> lock(mutex);
+  cacheLimit = bytes;
+}
+
+size_t MemoryPool::getSizeClass(size_t bytes) {
+  if (bytes <= MIN_SIZE_CLASS) {
+    return MIN_SIZE_CLASS;
+  }
+
+  // Find the power of two just below the request.
+  size_t base = MIN_SIZE_CLASS;
+  while (base * 2 < bytes) {
+    base <<= 1;
+  }
+
+  if (base * 2 <= POWER_OF_TWO_CLASS_LIMIT) {
+    return base * 2;
+  }
+
+  // Quarter steps between base and 2 * base.
+  const size_t step = base / 4;
+  return base + ((bytes - base + step - 1) / step) * step;
+}
+
+MemoryPool& getMemoryPool() {
+  // Intentionally never destroyed so containers with static storage duration
+  // can still release their memory at exit.
+  static MemoryPool* pool = new MemoryPool();
+  return *pool;
+}
+
+MemoryResource* getDefaultMemoryResource() { return &getMemoryPool(); }
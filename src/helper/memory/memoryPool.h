@@ -0,0 +1,119 @@
+/**
+ *******************************************************************************
+ * @file    memoryPool.h
+ * @brief   Size-class memory pool header.
+ *******************************************************************************
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "memoryResource.h"
+
+/** @brief Allocation counters of a memory pool. */
+struct MemoryStats {
+  /** @brief Number of allocation requests. */
+  uint64_t numAllocations{0};
+
+  /** @brief Number of requests served from a cached block. */
+  uint64_t numReused{0};
+
+  /** @brief Number of blocks requested from the system. */
+  uint64_t numSystemAllocations{0};
+
+  /** @brief Bytes currently handed out, rounded up to the size class. */
+  size_t bytesInUse{0};
+
+  /** @brief Highest value of bytesInUse since the last peak reset. */
+  size_t peakBytesInUse{0};
+
+  /** @brief Bytes held in free lists waiting to be reused. */
+  size_t bytesCached{0};
+};
+
+/**
+ * @brief Thread safe pool that recycles aligned blocks by size class.
+ *
+ * Requests are rounded up to a size class. Small requests use power of two
+ * classes, larger ones use quarter steps between powers of two so that
+ * spectrogram sized blocks waste at most 25%. Freed blocks are kept in a free
+ * list for their class and handed to the next request of the same class, so
+ * buffers released by one pipeline stage are picked up by the next stage or
+ * the next file.
+ */
+class MemoryPool : public MemoryResource {
+ public:
+  /**
+   * @brief Construct a new MemoryPool object.
+   *
+   * @param[in] cacheLimit Maximum number of bytes kept in free lists. Blocks
+   * freed beyond this limit are returned to the system.
+   */
+  explicit MemoryPool(size_t cacheLimit = DEFAULT_CACHE_LIMIT);
+
+  /** @brief Destroy the MemoryPool object and release all cached blocks. */
+  ~MemoryPool() override;
+
+  MemoryPool(const MemoryPool&) = delete;
+  MemoryPool& operator=(const MemoryPool&) = delete;
+
+  void* allocate(size_t bytes) override;
+
+  void deallocate(void* ptr, size_t bytes) override;
+
+  /**
+   * @brief Get a snapshot of the pool counters.
+   *
+   * @return MemoryStats Pool counters.
+   */
+  MemoryStats getStats() const;
+
+  /** @brief Restart peak tracking from the current number of bytes in use. */
+  void resetPeak();
+
+  /** @brief Return every cached block to the system. */
+  void trim();
+
+  /**
+   * @brief Change the maximum number of bytes kept in free lists.
+   *
+   * @param[in] bytes New cache limit.
+   */
+  void setCacheLimit(size_t bytes);
+
+  /**
+   * @brief Round a request up to its size class.
+   *
+   * @param[in] bytes Number of bytes requested.
+   * @return size_t Size of the block that serves the request.
+   */
+  static size_t getSizeClass(size_t bytes);
+
+  /** @brief Default maximum number of cached bytes. (1 GiB) */
+  static constexpr size_t DEFAULT_CACHE_LIMIT = size_t(1) << 30;
+
+ private:
+  /** @brief Protects the free lists and counters. */
+  mutable std::mutex mutex;
+
+  /** @brief Cached blocks keyed by size class. */
+  std::unordered_map<size_t, std::vector<void*>> freeLists;
+
+  /** @brief Pool counters. */
+  MemoryStats stats{};
+
+  /** @brief Maximum number of cached bytes. */
+  size_t cacheLimit;
+};
+
+/**
+ * @brief Get the process wide memory pool used by Matrix storage by default.
+ *
+ * @return MemoryPool& Shared memory pool.
+ */
+MemoryPool& getMemoryPool();
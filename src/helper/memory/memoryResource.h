@@ -0,0 +1,43 @@
+/**
+ *******************************************************************************
+ * @file    memoryResource.h
+ * @brief   Memory resource interface header.
+ *******************************************************************************
+ */
+
+#pragma once
+
+#include <cstddef>
+
+/**
+ * @brief Source of raw memory for containers. Every block handed out is
+ * aligned to MEMORY_ALIGNMENT bytes so it can be used with wide SIMD loads.
+ */
+class MemoryResource {
+ public:
+  virtual ~MemoryResource() = default;
+
+  /**
+   * @brief Allocate a block of memory.
+   *
+   * @param[in] bytes Number of bytes requested.
+   * @return void* Pointer to a MEMORY_ALIGNMENT aligned block.
+   */
+  virtual void* allocate(size_t bytes) = 0;
+
+  /**
+   * @brief Return a block of memory.
+   *
+   * @param[in] ptr Pointer previously returned by allocate().
+   * @param[in] bytes Number of bytes that was requested for the block.
+   */
+  virtual void deallocate(void* ptr, size_t bytes) = 0;
+};
+
+/**
+ * @brief Get the process wide default memory resource. This is the shared
+ * MemoryPool.
+ *
+ * @return MemoryResource* Default memory resource.
+ */
+MemoryResource* getDefaultMemoryResource();
@@ -0,0 +1,77 @@
+/**
+ *******************************************************************************
+ * @file    scratchArena.cpp
+ * @brief   Per-thread bump allocator for task scratch buffers source.
+ *******************************************************************************
+ */
+
+#include "scratchArena.h"
+
+#include <algorithm>
+#include <new>
+
+#include "constants.h"
+
+/** @brief Round a request up to a whole number of alignment units. */
+static inline size_t alignUp(size_t bytes) {
+  return (std::max<size_t>(bytes, 1) + MEMORY_ALIGNMENT - 1) &
+         ~(MEMORY_ALIGNMENT - 1);
+}
+
+ScratchArena::ScratchArena(size_t blockBytes)
+    : blockBytes(alignUp(blockBytes)) {}
+
+ScratchArena::~ScratchArena() {
+  for (const Block& block : blocks) {
+    ::operator delete(block.data, std::align_val_t{MEMORY_ALIGNMENT});
+  }
+}
+
+void* ScratchArena::allocate(size_t bytes) {
+  bytes = alignUp(bytes);
+
+  // Move on through the blocks kept from earlier use until one has room.
+  while (current < blocks.size()) {
+    Block& block = blocks[current];
+    if (offset + bytes <= block.size) {
+      void* ptr = static_cast<char*>(block.data) + offset;
+      offset += bytes;
+      return ptr;
+    }
+    current++;
+    offset = 0;
+  }
+
+  const size_t size = std::max(blockBytes, bytes);
+  blocks.push_back(
+      {::operator new(size, std::align_val_t{MEMORY_ALIGNMENT}), size});
+  current = blocks.size() - 1;
+  offset = bytes;
+  return blocks.back().data;
+}
+
+void ScratchArena::release(const Marker& marker) {
+  current = marker.block;
+  offset = marker.offset;
+}
+
+size_t ScratchArena::getBytesInUse() const {
+  size_t bytes = offset;
+  for (size_t i = 0; i < current && i < blocks.size(); i++) {
+    bytes += blocks[i].size;
+  }
+  return bytes;
+}
+
+size_t ScratchArena::getCapacity() const {
+  size_t bytes = 0;
+  for (const Block& block : blocks) {
+    bytes += block.size;
+  }
+  return bytes;
+}
+
+ScratchArena& getScratchArena() {
+  static thread_local ScratchArena arena;
+  return arena;
+}
@@ -0,0 +1,157 @@
+/**
+ *******************************************************************************
+ * @file    scratchArena.h
+ * @brief   Per-thread bump allocator for task scratch buffers header.
+ *******************************************************************************
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * @brief Bump allocator for short lived scratch buffers of one thread.
+ *
+ * Allocation moves an offset within a block and never takes a lock, so worker
+ * threads do not contend on the shared MemoryPool for the buffers of each
+ * task. Memory is given back in stack order by rolling back to a Marker,
+ * usually through a ScratchScope. Blocks are kept after a roll back, so a
+ * thread that runs the same tasks again allocates nothing new. A request
+ * larger than a block gets a block of its own.
+ *
+ * Every block handed out is aligned to MEMORY_ALIGNMENT bytes. The memory is
+ * not zeroed.
+ */
+class ScratchArena {
+ public:
+  /** @brief Position to roll the arena back to. */
+  struct Marker {
+    /** @brief Index of the block in use. */
+    size_t block{0};
+
+    /** @brief Bytes used in that block. */
+    size_t offset{0};
+  };
+
+  /**
+   * @brief Construct a new ScratchArena object. No memory is reserved until
+   * the first allocation.
+   *
+   * @param[in] blockBytes Size of each block taken from the system.
+   */
+  explicit ScratchArena(size_t blockBytes = DEFAULT_BLOCK_BYTES);
+
+  /** @brief Destroy the ScratchArena object and free every block. */
+  ~ScratchArena();
+
+  ScratchArena(const ScratchArena&) = delete;
+  ScratchArena& operator=(const ScratchArena&) = delete;
+
+  /**
+   * @brief Allocate a block of memory.
+   *
+   * @param[in] bytes Number of bytes requested.
+   * @return void* Pointer to a MEMORY_ALIGNMENT aligned block, valid until
+   * the arena is rolled back past it.
+   */
+  void* allocate(size_t bytes);
+
+  /**
+   * @brief Allocate uninitialized storage for n values.
+   *
+   * @tparam T Trivial value type.
+   * @param[in] n The number of values.
+   * @return T* Aligned storage.
+   */
+  template <typename T>
+  T* allocate(size_t n) {
+    return static_cast<T*>(allocate(n * sizeof(T)));
+  }
+
+  /** @brief Get the current position, to roll back to later. */
+  inline Marker mark() const { return {current, offset}; }
+
+  /**
+   * @brief Free everything allocated since a marker was taken.
+   *
+   * @param[in] marker Position returned by mark().
+   */
+  void release(const Marker& marker);
+
+  /** @brief Bytes from the start of the arena to the current position. */
+  size_t getBytesInUse() const;
+
+  /** @brief Bytes held in blocks, in use or not. */
+  size_t getCapacity() const;
+
+  /** @brief Default block size. (1 MiB) */
+  static constexpr size_t DEFAULT_BLOCK_BYTES = size_t(1) << 20;
+
+ private:
+  /** @brief Memory taken from the system. */
+  struct Block {
+    void* data;
+    size_t size;
+  };
+
+  /** @brief Blocks in allocation order. */
+  std::vector<Block> blocks{};
+
+  /** @brief Index of the block allocations are taken from. */
+  size_t current{0};
+
+  /** @brief Bytes used in the current block. */
+  size_t offset{0};
+
+  /** @brief Size of each new block. */
+  size_t blockBytes;
+};
+
+/**
+ * @brief Get the scratch arena of the calling thread.
+ *
+ * @return ScratchArena& Arena owned by the calling thread.
+ */
+ScratchArena& getScratchArena();
+
+/**
+ * @brief Scratch allocations that are freed together when the scope ends.
+ * Scopes on one thread must end in the reverse order they began.
+ */
+class ScratchScope {
+ public:
+  /**
+   * @brief Begin a scope on an arena.
+   *
+   * @param[in,out] arena Arena to allocate from. Defaults to the arena of the
+   * calling thread.
+   */
+  explicit ScratchScope(ScratchArena& arena = getScratchArena())
+      : arena(arena), marker(arena.mark()) {}
+
+  /** @brief Free every allocation made in the scope. */
+  ~ScratchScope() { arena.release(marker); }
+
+  ScratchScope(const ScratchScope&) = delete;
+  ScratchScope& operator=(const ScratchScope&) = delete;
+
+  /**
+   * @brief Allocate uninitialized storage for n values.
+   *
+   * @tparam T Trivial value type.
+   * @param[in] n The number of values.
+   * @return T* Aligned storage, valid until the scope ends.
+   */
+  template <typename T>
+  T* allocate(size_t n) {
+    return arena.allocate<T>(n);
+  }
+
+ private:
+  /** @brief Arena the scope allocates from. */
+  ScratchArena& arena;
+
+  /** @brief Position of the arena when the scope began. */
+  ScratchArena::Marker marker;
+};
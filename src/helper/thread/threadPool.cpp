@@ -0,0 +1,223 @@
+/**
+ *******************************************************************************
+ * @file    threadPool.cpp
+ * @brief   Work-stealing thread pool source.
+ *******************************************************************************
+ */
+
+#include "threadPool.h"
+
+#include <algorithm>
+
+#include "constants.h"
+#include "logging.h"
+
+/** @brief Chunks per thread when parallelFor picks the grain. */
+static const size_t CHUNKS_PER_THREAD = 8;
+
+/** @brief Index of the current worker in its pool, if it is a worker. */
+static thread_local const ThreadPool* currentPool = nullptr;
+static thread_local size_t currentWorker = 0;
+
+ThreadPool::ThreadPool(size_t numThreads) {
+  const size_t numWorkers = numThreads > 1 ? numThreads - 1 : 0;
+
+  workers.reserve(numWorkers);
+  for (size_t i = 0; i < numWorkers; i++) {
+    workers.emplace_back(std::make_unique<Worker>());
+  }
+
+  threads.reserve(numWorkers);
+  for (size_t i = 0; i < numWorkers; i++) {
+    threads.emplace_back(&ThreadPool::workerLoop, this, i);
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(sleepMutex);
+    stopping = true;
+  }
+  wake.notify_all();
+
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+}
+
+void ThreadPool::submit(Task task) {
+  if (workers.empty()) {
+    task();
+    return;
+  }
+
+  // Workers push onto their own deque; anyone else deals round robin.
+  size_t i = currentPool == this
+                 ? currentWorker
+                 : nextWorker.fetch_add(1) % workers.size();
+  {
+    // Counted under the deque lock so a thief never sees the task uncounted.
+    std::lock_guard<std::mutex> lock(workers[i]->mutex);
+    workers[i]->tasks.push_back(std::move(task));
+    numQueued++;
+  }
+
+  // Taking the sleep lock orders this with a worker about to wait.
+  { std::lock_guard<std::mutex> lock(sleepMutex); }
+  wake.notify_one();
+  if (numHelping > 0) {
+    progress.notify_one();
+  }
+}
+
+bool ThreadPool::tryTake(size_t self, Task& task) {
+  const size_t numWorkers = workers.size();
+
+  // Newest task of our own deque first, while its data is still warm.
+  if (self < numWorkers) {
+    Worker& own = *workers[self];
+    std::lock_guard<std::mutex> lock(own.mutex);
+    if (!own.tasks.empty()) {
+      task = std::move(own.tasks.back());
+      own.tasks.pop_back();
+      numQueued--;
+      return true;
+    }
+  }
+
+  // Otherwise steal the oldest task of another worker.
+  for (size_t k = 1; k <= numWorkers; k++) {
+    Worker& victim = *workers[(self + k) % numWorkers];
+    std::lock_guard<std::mutex> lock(victim.mutex);
+    if (!victim.tasks.empty()) {
+      task = std::move(victim.tasks.front());
+      victim.tasks.pop_front();
+      numQueued--;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+void ThreadPool::workerLoop(size_t i) {
+  currentPool = this;
+  currentWorker = i;
+
+  Task task;
+  while (true) {
+    if (tryTake(i, task)) {
+      runTask(task);
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(sleepMutex);
+    wake.wait(lock, [this] { return stopping || numQueued > 0; });
+    if (stopping && numQueued == 0) {
+      return;
+    }
+  }
+}
+
+void ThreadPool::parallelFor(size_t begin, size_t end, const RangeBody& body,
+                             size_t grain) {
+  if (begin >= end) {
+    return;
+  }
+
+  const size_t count = end - begin;
+  if (grain == 0) {
+    grain = std::max<size_t>(1, count / (getNumThreads() * CHUNKS_PER_THREAD));
+  }
+  const size_t numChunks = (count + grain - 1) / grain;
+
+  // Chunks are claimed from a shared counter by whoever is free.
+  std::atomic<size_t> nextChunk{0};
+  auto runChunks = [&]() {
+    size_t chunk;
+    while ((chunk = nextChunk.fetch_add(1)) < numChunks) {
+      size_t start = begin + chunk * grain;
+      body(start, std::min(end, start + grain));
+    }
+  };
+
+  const size_t numHelpers = std::min(workers.size(), numChunks - 1);
+  std::atomic<size_t> numActive{numHelpers};
+  for (size_t i = 0; i < numHelpers; i++) {
+    submit([&]() {
+      runChunks();
+      numActive--;
+    });
+  }
+
+  runChunks();
+
+  // Help with queued work, including our own helpers that have not started,
+  // until every helper is done.
+  helpUntil([&]() { return numActive == 0; });
+}
+
+void ThreadPool::runTask(Task& task) {
+  task();
+  task = nullptr;
+
+  // Waiters count themselves under the sleep lock before checking done, so
+  // either they see what the task changed or this sees them waiting.
+  if (numHelping > 0) {
+    { std::lock_guard<std::mutex> lock(sleepMutex); }
+    progress.notify_all();
+  }
+}
+
+void ThreadPool::helpUntil(const std::function<bool()>& done) {
+  const size_t self = currentPool == this ? currentWorker : workers.size();
+  Task task;
+  while (!done()) {
+    if (tryTake(self, task)) {
+      runTask(task);
+      continue;
+    }
+
+    // Nothing to take. Only a new task or a finished one can change done, so
+    // sleep until one of them happens rather than spin.
+    std::unique_lock<std::mutex> lock(sleepMutex);
+    numHelping++;
+    progress.wait(lock, [&]() { return numQueued > 0 || done(); });
+    numHelping--;
+  }
+}
+
+/** @brief Requested size of the process wide pool. */
+static size_t requestedPoolSize = 0;
+
+/** @brief Set once the process wide pool exists. */
+static std::atomic<bool> poolStarted{false};
+
+bool setThreadPoolSize(size_t numThreads) {
+  if (poolStarted) {
+    LOG_WARNING("Thread pool already running. Size is not changed.");
+    return false;
+  }
+
+  requestedPoolSize = numThreads;
+  return true;
+}
+
+size_t getDefaultNumThreads() {
+  size_t numThreads = std::thread::hardware_concurrency();
+  return numThreads > 0 ? numThreads : BASE_NUM_THREADS;
+}
+
+ThreadPool& getThreadPool() {
+  static ThreadPool* pool = [] {
+    size_t numThreads = requestedPoolSize;
+    if (numThreads == 0) {
+      numThreads = getDefaultNumThreads();
+    }
+    poolStarted = true;
+    LOG_INFO("Starting thread pool with " << numThreads << " threads.");
+    return new ThreadPool(numThreads);
+  }();
+
+  return *pool;
+}
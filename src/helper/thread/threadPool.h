@@ -0,0 +1,180 @@
+/**
+ *******************************************************************************
+ * @file    threadPool.h
+ * @brief   Work-stealing thread pool header.
+ *******************************************************************************
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Persistent pool of worker threads shared by every pipeline stage.
+ *
+ * Each worker owns a task deque. Workers take their own newest task first and
+ * steal the oldest task of another worker when they run out, so work spreads
+ * evenly without a single contended queue. Tasks submitted from outside the
+ * pool are dealt round robin across the worker deques.
+ *
+ * A thread waiting on parallelFor runs queued tasks while it waits, so
+ * parallelFor may be nested inside another parallelFor.
+ */
+class ThreadPool {
+ public:
+  /** @brief A unit of work. */
+  using Task = std::function<void()>;
+
+  /** @brief Loop body, called with a half open chunk [start, end). */
+  using RangeBody = std::function<void(size_t start, size_t end)>;
+
+  /**
+   * @brief Construct a new ThreadPool object.
+   *
+   * @param[in] numThreads Total number of threads working on a parallelFor,
+   * including the calling thread. A pool of one thread runs everything on the
+   * caller.
+   */
+  explicit ThreadPool(size_t numThreads);
+
+  /** @brief Finish queued tasks and join every worker. */
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  /** @brief Total number of threads, including the calling thread. */
+  inline size_t getNumThreads() const { return workers.size() + 1; }
+
+  /**
+   * @brief Queue a task for any worker.
+   *
+   * @param[in] task Task to run.
+   */
+  void submit(Task task);
+
+  /**
+   * @brief Run body over [begin, end) split into chunks handed out on demand,
+   * so threads that finish early take more chunks. Returns once every chunk
+   * has run. The caller works on chunks too.
+   *
+   * @param[in] begin First index.
+   * @param[in] end Last index (non-inclusive).
+   * @param[in] body Called once per chunk.
+   * @param[in] grain Chunk size. 0 picks one that gives each thread several
+   * chunks.
+   */
+  void parallelFor(size_t begin, size_t end, const RangeBody& body,
+                   size_t grain = 0);
+
+  /**
+   * @brief Run queued tasks on the calling thread until done returns true.
+   * Used to wait on work submitted to the pool without idling a thread. When
+   * there is nothing to take the thread sleeps until a task is queued or a
+   * task finishes, so done must only become true through atomics set by pool
+   * tasks.
+   *
+   * @param[in] done Completion check. Called between tasks.
+   */
+  void helpUntil(const std::function<bool()>& done);
+
+ private:
+  /** @brief Task deque of one worker. */
+  struct Worker {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+  };
+
+  /** @brief Main loop of worker i. */
+  void workerLoop(size_t i);
+
+  /**
+   * @brief Run a task taken from a deque, then wake any thread in helpUntil,
+   * since the task may be what it waits for.
+   *
+   * @param[in,out] task Task to run. Cleared afterwards.
+   */
+  void runTask(Task& task);
+
+  /**
+   * @brief Take a task, preferring the newest task of worker `self` and
+   * otherwise stealing the oldest task of another worker.
+   *
+   * @param[in] self Index of the calling worker, or the number of workers for
+   * a thread outside the pool.
+   * @param[out] task Task taken.
+   * @return true if a task was taken.
+   */
+  bool tryTake(size_t self, Task& task);
+
+  /** @brief Per worker task deques. */
+  std::vector<std::unique_ptr<Worker>> workers{};
+
+  /** @brief Worker threads. */
+  std::vector<std::thread> threads{};
+
+  /** @brief Number of queued tasks not yet taken. */
+  std::atomic<size_t> numQueued{0};
+
+  /** @brief Round robin position for tasks submitted from outside. */
+  std::atomic<size_t> nextWorker{0};
+
+  /** @brief Guards sleeping and shutdown. */
+  std::mutex sleepMutex{};
+
+  /** @brief Wakes sleeping workers. */
+  std::condition_variable wake{};
+
+  /** @brief Wakes threads sleeping in helpUntil. */
+  std::condition_variable progress{};
+
+  /** @brief Number of threads sleeping in helpUntil. */
+  std::atomic<size_t> numHelping{0};
+
+  /** @brief Set when the pool is shutting down. */
+  bool stopping{false};
+};
+
+/**
+ * @brief Number of threads used when no size is requested: the hardware
+ * concurrency, or BASE_NUM_THREADS if that is unknown.
+ */
+size_t getDefaultNumThreads();
+
+/**
+ * @brief Set the size of the process wide pool. Must be called before the
+ * first call to getThreadPool, e.g. while parsing arguments.
+ *
+ * @param[in] numThreads Total number of threads. 0 uses the hardware
+ * concurrency.
+ * @return true if applied, false if the pool was already running.
+ */
+bool setThreadPoolSize(size_t numThreads);
+
+/**
+ * @brief Get the process wide pool, creating it on first use.
+ *
+ * @return ThreadPool& Shared pool.
+ */
+ThreadPool& getThreadPool();
+
+/**
+ * @brief Run body over [begin, end) on the process wide pool.
+ *
+ * @param[in] begin First index.
+ * @param[in] end Last index (non-inclusive).
+ * @param[in] body Called with each chunk [start, end).
+ * @param[in] grain Chunk size. 0 picks one automatically.
+ */
+inline void parallelFor(size_t begin, size_t end,
+                        const ThreadPool::RangeBody& body, size_t grain = 0) {
+  getThreadPool().parallelFor(begin, end, body, grain);
+}
@@ -5,19 +5,24 @@
  *******************************************************************************
  */
 
-#include <QtWidgets/QApplication>
-
 #include "argParser.h"
+#include "batch.h"
 #include "coreLogic.h"
 #include "logging.h"
 #include "sampleData.h"
+#include "threadPool.h"
+
+#ifdef ENABLE_VIZ
+#include <QtWidgets/QApplication>
+#include <filesystem>
+
+#include "plot.h"
+#endif
 
 int main(int argc, char* argv[]) {
   LOG_INFO("Hello! I am Swara Tone!");
   LOG_INFO("We will need a lot of coffee for this fun project!");
 
-  QApplication app(argc, argv);
-
   // Parse arguments.
   Arguments arguments = parseArgumnets(argc, argv);
   switch (arguments.action) {
@@ -34,8 +39,63 @@ int main(int argc, char* argv[]) {
       break;
   }
 
-  // Run main code.
-  runCore(arguments.filePath);
+  // Process many files in one process.
+  if (!arguments.batchSpec.empty()) {
+    BatchOptions options{};
+    options.numJobs = arguments.numJobs;
+    options.numThreads = arguments.numThreads;
+    options.maxMemoryBytes = arguments.maxMemory_mib << 20;
+    options.stereo = arguments.stereo;
+    options.analysisRate = arguments.analysisRate_hz;
+    options.resampleQuality = arguments.resampleQuality;
+    options.start_s = arguments.start_s;
+    options.duration_s = arguments.duration_s;
+
+    std::vector<std::string> files = collectBatchInputs(arguments.batchSpec);
+    return runBatch(files, options) ? 0 : 1;
+  }
+
+  // Size the shared thread pool before any stage starts it.
+  setThreadPoolSize(arguments.numThreads);
+
+  CoreOptions options{};
+  options.maxMemoryBytes = arguments.maxMemory_mib << 20;
+  options.stereo = arguments.stereo;
+  options.analysisRate = arguments.analysisRate_hz;
+  options.resampleQuality = arguments.resampleQuality;
+  options.start_s = arguments.start_s;
+  options.duration_s = arguments.duration_s;
 
-  return 0;
+  if (!arguments.plot) {
+    // Run main code.
+    return runCore(arguments.filePath, nullptr, options) ? 0 : 1;
+  }
+
+#ifdef ENABLE_VIZ
+  // Qt is only started when a plot is requested. Plots are only saved to
+  // files, so no display is needed.
+  if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+    qputenv("QT_QPA_PLATFORM", "offscreen");
+  }
+  QApplication app(argc, argv);
+
+  // Keep a copy of the spectrum. Qt paints on the main thread only.
+  Matrix<std::complex<double>> spectrogram{};
+  bool ok = runCore(arguments.filePath, nullptr, options,
+                    [&](const SplitComplexMatrix& X) {
+                      toInterleaved(X, spectrogram);
+                    });
+
+  if (ok && spectrogram.getNumElements() > 0) {
+    const std::string fileName =
+        "spectrogram_" +
+        std::filesystem::path(arguments.filePath).stem().string();
+    LOG_INFO("Saving " << fileName << ".png");
+    plotFrequencySpectrogram(spectrogram, true, fileName);
+  }
+  return ok ? 0 : 1;
+#else
+  LOG_ERROR("Plotting is not available. Rebuild with BUILD_VIZ=ON.");
+  return 1;
+#endif
 }
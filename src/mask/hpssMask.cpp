@@ -8,7 +8,8 @@
 #include "hpssMask.hpp"
 
 #include <algorithm>
-#include <thread>
+
+#include "threadPool.h"
 
 void applyBinaryMask(const Matrix<double>& yH, const Matrix<double>& yP,
                      Matrix<double>& mH, Matrix<double>& mP) {
@@ -42,28 +43,9 @@ void applySoftMask(const Matrix<double>& yH, const Matrix<double>& yP,
 
   // Use threads to speed up computation.
   const size_t numOps = yH.getNumRows() * yH.getNumCols();
-  const size_t NUM_THREADS = std::min<size_t>(BASE_NUM_THREADS, numOps);
-  std::vector<std::thread> threads;
-  threads.reserve(NUM_THREADS);
-
-  size_t base = numOps / NUM_THREADS;
-  size_t rem = numOps % NUM_THREADS;
-
-  size_t start = 0;
-  size_t end = 0;
-
-  for (size_t i = 0; i < NUM_THREADS; i++) {
-    start = i * base + std::min(i, rem);
-    end = start + base + (i < rem ? 1 : 0);
-
-    threads.emplace_back(std::thread(applySoftMaskSubset, std::ref(yH),
-                                     std::ref(yP), std::ref(mH), std::ref(mP),
-                                     start, end));
-  }
-
-  for (std::thread& thread : threads) {
-    thread.join();
-  }
+  parallelFor(0, numOps, [&](size_t start, size_t end) {
+    applySoftMaskSubset(yH, yP, mH, mP, start, end);
+  });
 }
 
 void applySoftMaskSubset(const Matrix<double>& yH, const Matrix<double>& yP,
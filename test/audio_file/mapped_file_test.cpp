@@ -0,0 +1,65 @@
+/**
+ ******************************************************************************
+ * @file    mapped_file_test.cpp
+ * @brief   Unit tests for the memory mapped input file.
+ ******************************************************************************
+ */
+
+#include "mappedFile.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <vector>
+
+#include "test_mp3.h"
+
+namespace fs = std::filesystem;
+
+/** @brief Temporary input files. */
+class MappedFileTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    dir = fs::temp_directory_path() / "swaratone_mapped_file_test";
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+  }
+
+  void TearDown() override { fs::remove_all(dir); }
+
+  fs::path dir{};
+};
+
+TEST_F(MappedFileTest, MatchesFileContents) {
+  std::vector<uint8_t> bytes(100000);
+  for (size_t i = 0; i < bytes.size(); i++) {
+    bytes[i] = static_cast<uint8_t>((i * 31) ^ (i >> 8));
+  }
+  const std::string path = (dir / "data.bin").string();
+  ASSERT_TRUE(writeTestFile(path, bytes));
+
+  MappedFile file{};
+  ASSERT_TRUE(file.open(path));
+  ASSERT_EQ(file.size(), bytes.size());
+  EXPECT_TRUE(std::equal(bytes.begin(), bytes.end(), file.data()));
+
+  file.close();
+  EXPECT_EQ(file.data(), nullptr);
+  EXPECT_EQ(file.size(), 0u);
+}
+
+TEST_F(MappedFileTest, EmptyFile) {
+  const std::string path = (dir / "empty.bin").string();
+  ASSERT_TRUE(writeTestFile(path, {}));
+
+  MappedFile file{};
+  ASSERT_TRUE(file.open(path));
+  EXPECT_EQ(file.size(), 0u);
+}
+
+TEST_F(MappedFileTest, MissingFile) {
+  MappedFile file{};
+  EXPECT_FALSE(file.open((dir / "missing.bin").string()));
+  EXPECT_EQ(file.data(), nullptr);
+}
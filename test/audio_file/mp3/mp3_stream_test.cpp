@@ -0,0 +1,173 @@
+/**
+ ******************************************************************************
+ * @file    mp3_stream_test.cpp
+ * @brief   Unit tests for the streaming MP3 decoder.
+ ******************************************************************************
+ */
+
+#include "mp3Stream.h"
+
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <vector>
+
+#include "mp3.h"
+#include "test_mp3.h"
+
+namespace fs = std::filesystem;
+
+/** @brief Number of frames in the test streams. */
+static const size_t NUM_FRAMES = 40;
+
+/** @brief Temporary MP3 files. */
+class MP3StreamTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    dir = fs::temp_directory_path() / "swaratone_mp3_stream_test";
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+  }
+
+  void TearDown() override { fs::remove_all(dir); }
+
+  /** @brief Write a test stream and return its path. */
+  std::string createFile(bool stereo) {
+    std::string path = (dir / (stereo ? "stereo.mp3" : "mono.mp3")).string();
+    writeTestFile(path, createTestMP3(NUM_FRAMES, stereo));
+    return path;
+  }
+
+  /** @brief Down mix a whole file decode the way the pipeline input does. */
+  static std::vector<double> decodeWholeFile(const std::string& path) {
+    MP3Data data = readMP3File(path);
+    std::vector<double> mono(data.numSamples);
+    for (size_t n = 0; n < data.numSamples; n++) {
+      mono[n] = data.channel == Channel::Stereo
+                    ? (data.channel1[n] + data.channel2[n]) / 2.0
+                    : data.channel1[n];
+    }
+    return mono;
+  }
+
+  /** @brief Read a whole stream in blocks of blockSize samples. */
+  static std::vector<double> readStream(MP3Stream& stream, size_t blockSize) {
+    std::vector<double> mono(stream.getNumSamples() + blockSize);
+    size_t total = 0;
+    size_t numRead = 0;
+    do {
+      numRead = stream.readMono(mono.data() + total, blockSize);
+      total += numRead;
+    } while (numRead == blockSize);
+
+    mono.resize(total);
+    return mono;
+  }
+
+  fs::path dir{};
+};
+
+/** @brief Stereo blocks match the down mixed whole file decode exactly. */
+TEST_F(MP3StreamTest, StereoMatchesWholeFile) {
+  std::string path = createFile(true);
+
+  MP3Stream stream{};
+  ASSERT_TRUE(stream.open(path));
+  ASSERT_EQ(stream.getChannel(), Channel::Stereo);
+  ASSERT_EQ(stream.getSampleRate(), TEST_MP3_SAMPLE_RATE_HZ);
+  ASSERT_EQ(stream.getNumSamples(), NUM_FRAMES * TEST_MP3_FRAME_SAMPLES);
+
+  // Blocks that do not line up with MP3 frames.
+  ASSERT_EQ(readStream(stream, 1000), decodeWholeFile(path));
+
+  // Both channels, without down mixing.
+  MP3Data data = readMP3File(path);
+  MP3Stream channels{};
+  ASSERT_TRUE(channels.open(path));
+  std::vector<double> left(data.numSamples);
+  std::vector<double> right(data.numSamples);
+  ASSERT_EQ(channels.readStereo(left.data(), right.data(), 1000), 1000u);
+  ASSERT_EQ(channels.readStereo(left.data() + 1000, right.data() + 1000,
+                                data.numSamples),
+            data.numSamples - 1000);
+  for (size_t n = 0; n < data.numSamples; n++) {
+    ASSERT_EQ(left[n], data.channel1[n]);
+    ASSERT_EQ(right[n], data.channel2[n]);
+  }
+}
+
+/** @brief Mono blocks match the whole file decode exactly. */
+TEST_F(MP3StreamTest, MonoMatchesWholeFile) {
+  std::string path = createFile(false);
+
+  MP3Stream stream{};
+  ASSERT_TRUE(stream.open(path));
+  ASSERT_EQ(stream.getChannel(), Channel::Mono);
+  ASSERT_EQ(stream.getNumSamples(), NUM_FRAMES * TEST_MP3_FRAME_SAMPLES);
+  ASSERT_EQ(readStream(stream, 4097), decodeWholeFile(path));
+}
+
+/** @brief Parallel decoding matches serial decoding exactly, for segments
+ * short enough that every warm-up draws on the bit reservoir. */
+TEST_F(MP3StreamTest, ParallelMatchesSerial) {
+  ThreadPool pool{4};
+  for (bool stereo : {true, false}) {
+    std::string path = createFile(stereo);
+
+    MP3Stream serial{};
+    ASSERT_TRUE(serial.open(path));
+    const std::vector<double> expected =
+        readStream(serial, serial.getNumSamples());
+
+    for (size_t segmentFrames : {1, 3, 16}) {
+      MP3Stream stream{};
+      ASSERT_TRUE(stream.open(path));
+
+      std::vector<double> mono(stream.getNumSamples(), 0.0);
+      ASSERT_EQ(stream.readAllMonoParallel(mono.data(), pool, segmentFrames),
+                expected.size());
+      ASSERT_EQ(mono, expected) << "stereo " << stereo << ", segments of "
+                                << segmentFrames << " frames";
+
+      // The whole stream has been read.
+      double sample = 0.0;
+      ASSERT_EQ(stream.readMono(&sample, 1), 0u);
+    }
+  }
+}
+
+/** @brief Seeking decodes from any sample, matching a read from the start. */
+TEST_F(MP3StreamTest, Seek) {
+  for (bool stereo : {true, false}) {
+    std::string path = createFile(stereo);
+    const std::vector<double> expected = decodeWholeFile(path);
+
+    MP3Stream stream{};
+    ASSERT_TRUE(stream.open(path));
+    for (size_t sample : {size_t{0}, 5 * TEST_MP3_FRAME_SAMPLES + 17,
+                          20 * TEST_MP3_FRAME_SAMPLES, size_t{1}}) {
+      ASSERT_TRUE(stream.seek(sample));
+      std::vector<double> mono(3000);
+      ASSERT_EQ(stream.readMono(mono.data(), mono.size()), mono.size());
+      ASSERT_EQ(mono, std::vector<double>(expected.begin() + sample,
+                                          expected.begin() + sample + 3000))
+          << "stereo " << stereo << ", sample " << sample;
+    }
+
+    // The end of the track is a valid position, past it is not.
+    ASSERT_TRUE(stream.seek(stream.getNumSamples()));
+    double sample = 0.0;
+    ASSERT_EQ(stream.readMono(&sample, 1), 0u);
+    ASSERT_FALSE(stream.seek(stream.getNumSamples() + 1));
+  }
+}
+
+/** @brief A missing file fails to open and reads nothing. */
+TEST_F(MP3StreamTest, MissingFile) {
+  MP3Stream stream{};
+  ASSERT_FALSE(stream.open((dir / "missing.mp3").string()));
+  ASSERT_EQ(stream.getNumSamples(), 0u);
+
+  double sample = 0.0;
+  ASSERT_EQ(stream.readMono(&sample, 1), 0u);
+}
@@ -0,0 +1,112 @@
+/**
+ ******************************************************************************
+ * @file    output_writer_test.cpp
+ * @brief   Unit tests for the asynchronous output writer.
+ ******************************************************************************
+ */
+
+#include "outputWriter.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <future>
+#include <thread>
+#include <vector>
+
+#include "wav_decoding.h"
+
+namespace fs = std::filesystem;
+
+/** @brief Temporary output files. */
+class OutputWriterTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    dir = fs::temp_directory_path() / "swaratone_output_writer_test";
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+  }
+
+  void TearDown() override { fs::remove_all(dir); }
+
+  /** @brief A mono file of numFrames samples of value. */
+  OutputFile makeFile(const std::string& name, size_t numFrames,
+                      double value) {
+    OutputFile file{};
+    file.path = (dir / name).string();
+    file.channels.push_back(std::vector<double>(numFrames, value));
+    file.sampleRate = 8000;
+    return file;
+  }
+
+  fs::path dir{};
+};
+
+/** @brief Files are written in order and each reports once. */
+TEST_F(OutputWriterTest, WritesInOrder) {
+  std::vector<int> order{};
+  OutputWriter writer{};
+  for (int i = 0; i < 3; i++) {
+    OutputFile file =
+        makeFile("out" + std::to_string(i) + ".wav", 100, 0.25 * i);
+    file.onWritten = [&order, i](bool ok) {
+      ASSERT_TRUE(ok);
+      order.push_back(i);
+    };
+    writer.submit(std::move(file));
+  }
+  ASSERT_TRUE(writer.wait());
+  ASSERT_EQ(order, (std::vector<int>{0, 1, 2}));
+
+  for (int i = 0; i < 3; i++) {
+    const fs::path path = dir / ("out" + std::to_string(i) + ".wav");
+    WAVFileDecoder decoder{};
+    ASSERT_TRUE(decoder.open(path.string()));
+    ASSERT_EQ(decoder.getNumSamples(), 100u);
+    std::vector<double> mono(100);
+    ASSERT_EQ(decoder.readMono(mono.data(), 100), 100u);
+    ASSERT_NEAR(mono[50], 0.25 * i, 1.0 / 32767);
+  }
+}
+
+/** @brief A full queue blocks submit until earlier files are written. */
+TEST_F(OutputWriterTest, Backpressure) {
+  const size_t numFrames = 1000;
+  OutputWriter writer(numFrames * sizeof(double));
+
+  // The first file is held on the writer thread until released.
+  std::promise<void> release{};
+  std::shared_future<void> released = release.get_future().share();
+  OutputFile first = makeFile("first.wav", numFrames, 0.5);
+  first.onWritten = [released](bool) { released.wait(); };
+  writer.submit(std::move(first));
+
+  std::atomic<bool> submitted{false};
+  std::thread producer([&]() {
+    writer.submit(makeFile("second.wav", numFrames, 0.5));
+    submitted = true;
+  });
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  ASSERT_FALSE(submitted);
+
+  release.set_value();
+  producer.join();
+  ASSERT_TRUE(submitted);
+  ASSERT_TRUE(writer.wait());
+  ASSERT_TRUE(fs::exists(dir / "second.wav"));
+}
+
+/** @brief Failed writes are reported to the callback and by wait. */
+TEST_F(OutputWriterTest, Failure) {
+  std::atomic<bool> reported{true};
+  OutputWriter writer{};
+  OutputFile file = makeFile("missing/out.wav", 10, 0.0);
+  file.onWritten = [&reported](bool ok) { reported = ok; };
+  writer.submit(std::move(file));
+
+  ASSERT_FALSE(writer.wait());
+  ASSERT_FALSE(reported);
+}
@@ -0,0 +1,115 @@
+/**
+ ******************************************************************************
+ * @file    range_stream_test.cpp
+ * @brief   Unit tests for the audio stream over a range of samples.
+ ******************************************************************************
+ */
+
+#include "rangeStream.h"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <filesystem>
+#include <vector>
+
+#include "wav_decoding.h"
+#include "wav_encoding.h"
+
+namespace fs = std::filesystem;
+
+/** @brief Samples per channel of the test file. */
+static const size_t NUM_FRAMES = 20000;
+
+/** @brief A stereo float WAV file and its samples. */
+class RangeStreamTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    path = (fs::temp_directory_path() / "swaratone_range_test.wav").string();
+    std::vector<double> left(NUM_FRAMES);
+    std::vector<double> right(NUM_FRAMES);
+    for (size_t i = 0; i < NUM_FRAMES; i++) {
+      left[i] = 0.5 * std::sin(0.013 * static_cast<double>(i));
+      right[i] = 0.25 * std::cos(0.21 * static_cast<double>(i));
+    }
+    const double* channels[2] = {left.data(), right.data()};
+    WAVFileEncoder encoder{};
+    ASSERT_TRUE(encoder.write(path, channels, 2, NUM_FRAMES,
+                              WAVSampleFormat::Float32, 44100));
+
+    WAVFileDecoder decoder{};
+    ASSERT_TRUE(decoder.open(path));
+    mono.resize(NUM_FRAMES);
+    ASSERT_EQ(decoder.readMono(mono.data(), NUM_FRAMES), NUM_FRAMES);
+  }
+
+  void TearDown() override { fs::remove(path); }
+
+  std::string path{};
+  std::vector<double> mono{};
+};
+
+/** @brief Block reads return exactly the samples of the range. */
+TEST_F(RangeStreamTest, MonoBlocks) {
+  WAVFileDecoder decoder{};
+  ASSERT_TRUE(decoder.open(path));
+  RangeStream stream(decoder, 3000, 7000);
+  ASSERT_EQ(stream.getNumSamples(), 7000u);
+  ASSERT_EQ(stream.getSampleRate(), 44100);
+  ASSERT_EQ(stream.getChannel(), Channel::Stereo);
+
+  std::vector<double> out(8000);
+  size_t total = 0;
+  size_t numRead = 0;
+  do {
+    numRead = stream.readMono(out.data() + total, 999);
+    total += numRead;
+  } while (numRead == 999);
+  out.resize(total);
+  ASSERT_EQ(out, std::vector<double>(mono.begin() + 3000,
+                                     mono.begin() + 10000));
+}
+
+/** @brief Ranges past the end of the track are clamped to it. */
+TEST_F(RangeStreamTest, Clamped) {
+  WAVFileDecoder decoder{};
+  ASSERT_TRUE(decoder.open(path));
+  RangeStream stream(decoder, NUM_FRAMES - 500, 2000);
+  ASSERT_EQ(stream.getNumSamples(), 500u);
+
+  ThreadPool pool(2);
+  ASSERT_FALSE(stream.hasParallelRead());
+  std::vector<double> out(500);
+  ASSERT_EQ(stream.readAllMonoParallel(out.data(), pool), 500u);
+  ASSERT_EQ(out, std::vector<double>(mono.end() - 500, mono.end()));
+
+  WAVFileDecoder empty{};
+  ASSERT_TRUE(empty.open(path));
+  ASSERT_EQ(RangeStream(empty, NUM_FRAMES + 1, 10).getNumSamples(), 0u);
+}
+
+/** @brief Stereo reads and seeks stay within the range. */
+TEST_F(RangeStreamTest, StereoSeek) {
+  WAVFileDecoder decoder{};
+  ASSERT_TRUE(decoder.open(path));
+  WAVFileDecoder reference{};
+  ASSERT_TRUE(reference.open(path));
+  RangeStream stream(decoder, 5000, 1000);
+
+  ASSERT_TRUE(stream.seek(600));
+  std::vector<double> left(1000);
+  std::vector<double> right(1000);
+  ASSERT_EQ(stream.readStereo(left.data(), right.data(), 1000), 400u);
+
+  std::vector<double> expectedLeft(400);
+  std::vector<double> expectedRight(400);
+  ASSERT_TRUE(reference.seek(5600));
+  ASSERT_EQ(reference.readStereo(expectedLeft.data(), expectedRight.data(),
+                                 400),
+            400u);
+  left.resize(400);
+  right.resize(400);
+  ASSERT_EQ(left, expectedLeft);
+  ASSERT_EQ(right, expectedRight);
+  ASSERT_FALSE(stream.seek(1001));
+}
@@ -0,0 +1,139 @@
+/**
+ ******************************************************************************
+ * @file    resampled_stream_test.cpp
+ * @brief   Unit tests for the sample rate converting audio stream.
+ ******************************************************************************
+ */
+
+#include "resampledStream.h"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <filesystem>
+#include <vector>
+
+#include "wav_decoding.h"
+#include "wav_encoding.h"
+
+namespace fs = std::filesystem;
+
+/** @brief Samples per channel of the test file. */
+static const size_t NUM_FRAMES = 30000;
+
+/** @brief A stereo float WAV file at 48 kHz and its samples. */
+class ResampledStreamTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    path = (fs::temp_directory_path() / "swaratone_resampled_test.wav")
+               .string();
+    std::vector<double> left(NUM_FRAMES);
+    std::vector<double> right(NUM_FRAMES);
+    for (size_t i = 0; i < NUM_FRAMES; i++) {
+      left[i] = 0.5 * std::sin(0.031 * static_cast<double>(i));
+      right[i] = 0.3 * std::sin(0.17 * static_cast<double>(i) + 1.0);
+    }
+    const double* channels[2] = {left.data(), right.data()};
+    WAVFileEncoder encoder{};
+    ASSERT_TRUE(encoder.write(path, channels, 2, NUM_FRAMES,
+                              WAVSampleFormat::Float32, 48000));
+
+    // Samples as decoded, so only the conversion differs.
+    WAVFileDecoder decoder{};
+    ASSERT_TRUE(decoder.open(path));
+    mono.resize(NUM_FRAMES);
+    ASSERT_EQ(decoder.readMono(mono.data(), NUM_FRAMES), NUM_FRAMES);
+    WAVFileDecoder stereoDecoder{};
+    ASSERT_TRUE(stereoDecoder.open(path));
+    stereo.assign(2, std::vector<double>(NUM_FRAMES));
+    ASSERT_EQ(stereoDecoder.readStereo(stereo[0].data(), stereo[1].data(),
+                                       NUM_FRAMES),
+              NUM_FRAMES);
+  }
+
+  void TearDown() override { fs::remove(path); }
+
+  /** @brief Resample a whole signal to 44.1 kHz. */
+  static std::vector<double> resample(const std::vector<double>& in) {
+    Resampler resampler(48000, 44100);
+    std::vector<double> out(resampler.getOutputSize(in.size()));
+    resampler.process(in.data(), 0, in.size(), 0, out.size(), out.data());
+    return out;
+  }
+
+  std::string path{};
+  std::vector<double> mono{};
+  std::vector<std::vector<double>> stereo{};
+};
+
+/** @brief Mono reads in blocks match resampling the whole signal. */
+TEST_F(ResampledStreamTest, MonoBlocks) {
+  WAVFileDecoder decoder{};
+  ASSERT_TRUE(decoder.open(path));
+  ResampledStream stream(decoder, 44100);
+  const std::vector<double> expected = resample(mono);
+  ASSERT_EQ(stream.getSampleRate(), 44100);
+  ASSERT_EQ(stream.getNumSamples(), expected.size());
+  ASSERT_EQ(stream.getChannel(), Channel::Stereo);
+
+  std::vector<double> out(expected.size());
+  size_t written = 0;
+  while (written < out.size()) {
+    const size_t numRead = stream.readMono(out.data() + written, 1234);
+    ASSERT_GT(numRead, 0u);
+    written += numRead;
+  }
+  ASSERT_EQ(stream.readMono(out.data(), 1), 0u);
+  ASSERT_EQ(out, expected);
+}
+
+/** @brief Stereo reads convert each channel on its own. */
+TEST_F(ResampledStreamTest, StereoBlocks) {
+  WAVFileDecoder decoder{};
+  ASSERT_TRUE(decoder.open(path));
+  ResampledStream stream(decoder, 44100);
+  const std::vector<double> left = resample(stereo[0]);
+  const std::vector<double> right = resample(stereo[1]);
+
+  std::vector<double> outLeft(left.size());
+  std::vector<double> outRight(right.size());
+  size_t written = 0;
+  while (written < outLeft.size()) {
+    const size_t numRead = stream.readStereo(
+        outLeft.data() + written, outRight.data() + written, 4321);
+    ASSERT_GT(numRead, 0u);
+    written += numRead;
+  }
+  ASSERT_EQ(outLeft, left);
+  ASSERT_EQ(outRight, right);
+}
+
+/** @brief Parallel reads match block reads. */
+TEST_F(ResampledStreamTest, Parallel) {
+  WAVFileDecoder decoder{};
+  ASSERT_TRUE(decoder.open(path));
+  ResampledStream stream(decoder, 44100);
+  const std::vector<double> expected = resample(mono);
+
+  ThreadPool pool(4);
+  std::vector<double> out(stream.getNumSamples());
+  ASSERT_EQ(stream.readAllMonoParallel(out.data(), pool), expected.size());
+  ASSERT_EQ(out, expected);
+}
+
+/** @brief Reads after a seek match the same samples read from the start. */
+TEST_F(ResampledStreamTest, Seek) {
+  WAVFileDecoder decoder{};
+  ASSERT_TRUE(decoder.open(path));
+  ResampledStream stream(decoder, 44100);
+  const std::vector<double> expected = resample(mono);
+
+  for (size_t sample : {size_t{12345}, size_t{3}, size_t{0}}) {
+    ASSERT_TRUE(stream.seek(sample));
+    std::vector<double> out(2000);
+    ASSERT_EQ(stream.readMono(out.data(), out.size()), out.size());
+    ASSERT_EQ(out, std::vector<double>(expected.begin() + sample,
+                                       expected.begin() + sample + 2000));
+  }
+  ASSERT_FALSE(stream.seek(stream.getNumSamples() + 1));
+}
@@ -0,0 +1,246 @@
+/**
+ ******************************************************************************
+ * @file    wav_decoding_test.cpp
+ * @brief   Unit tests for the WAV file decoder.
+ ******************************************************************************
+ */
+
+#include "wav_decoding.h"
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <filesystem>
+#include <vector>
+
+#include "mp3Stream.h"
+#include "test_mp3.h"
+
+namespace fs = std::filesystem;
+
+/** @brief Append a little endian value of numBytes bytes. */
+static void putLE(std::vector<uint8_t>& out, uint64_t value, size_t numBytes) {
+  for (size_t i = 0; i < numBytes; i++) {
+    out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+  }
+}
+
+/** @brief Append a four character code. */
+static void putTag(std::vector<uint8_t>& out, const char* tag) {
+  for (size_t i = 0; i < 4; i++) {
+    out.push_back(static_cast<uint8_t>(tag[i]));
+  }
+}
+
+/**
+ * @brief Build a WAV file around raw sample bytes. A LIST chunk before the
+ * data chunk checks that unknown chunks are skipped.
+ */
+static std::vector<uint8_t> createWav(uint16_t formatTag, uint16_t numChannels,
+                                      uint16_t bitsPerSample,
+                                      const std::vector<uint8_t>& samples,
+                                      bool extensible = false) {
+  const uint16_t blockAlign = numChannels * (bitsPerSample / 8);
+  std::vector<uint8_t> out{};
+  putTag(out, "RIFF");
+  putLE(out, 0, 4);
+  putTag(out, "WAVE");
+
+  putTag(out, "fmt ");
+  putLE(out, extensible ? 40 : 16, 4);
+  putLE(out, extensible ? 0xFFFE : formatTag, 2);
+  putLE(out, numChannels, 2);
+  putLE(out, 44100, 4);
+  putLE(out, 44100 * blockAlign, 4);
+  putLE(out, blockAlign, 2);
+  putLE(out, bitsPerSample, 2);
+  if (extensible) {
+    putLE(out, 22, 2);
+    putLE(out, bitsPerSample, 2);
+    putLE(out, 0, 4);
+    // Sub format GUID: the format tag followed by the fixed suffix.
+    putLE(out, formatTag, 2);
+    const uint8_t suffix[14] = {0x00, 0x00, 0x00, 0x00, 0x10, 0x00, 0x80,
+                                0x00, 0x00, 0xAA, 0x00, 0x38, 0x9B, 0x71};
+    out.insert(out.end(), suffix, suffix + sizeof(suffix));
+  }
+
+  // Odd sized chunk, padded to an even size.
+  putTag(out, "LIST");
+  putLE(out, 3, 4);
+  out.insert(out.end(), {'a', 'b', 'c', 0});
+
+  putTag(out, "data");
+  putLE(out, samples.size(), 4);
+  out.insert(out.end(), samples.begin(), samples.end());
+
+  const uint32_t riffSize = static_cast<uint32_t>(out.size() - 8);
+  std::memcpy(out.data() + 4, &riffSize, 4);
+  return out;
+}
+
+/** @brief Temporary WAV files. */
+class WAVDecodingTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    dir = fs::temp_directory_path() / "swaratone_wav_decoding_test";
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+  }
+
+  void TearDown() override { fs::remove_all(dir); }
+
+  /** @brief Write a file and return its path. */
+  std::string createFile(const std::string& name,
+                         const std::vector<uint8_t>& bytes) {
+    std::string path = (dir / name).string();
+    writeTestFile(path, bytes);
+    return path;
+  }
+
+  /** @brief Read every sample of a file as mono. */
+  std::vector<double> readAll(const std::string& path) {
+    WAVFileDecoder decoder{};
+    EXPECT_TRUE(decoder.open(path));
+    std::vector<double> mono(decoder.getNumSamples());
+    EXPECT_EQ(decoder.readMono(mono.data(), mono.size()), mono.size());
+    return mono;
+  }
+
+  fs::path dir{};
+};
+
+/** @brief 16 bit stereo is read in place and down mixed like MP3 input. */
+TEST_F(WAVDecodingTest, Int16Stereo) {
+  const size_t numSamples = 5000;
+  std::vector<int16_t> pcm(2 * numSamples);
+  std::vector<double> expected(numSamples);
+  for (size_t n = 0; n < numSamples; n++) {
+    const int left = static_cast<int>(n * 37 % 65536) - 32768;
+    pcm[2 * n] = static_cast<int16_t>(left);
+    pcm[2 * n + 1] = static_cast<int16_t>(16000 - static_cast<int>(n));
+    expected[n] = (static_cast<double>(pcm[2 * n]) / INT16_MAX +
+                   static_cast<double>(pcm[2 * n + 1]) / INT16_MAX) /
+                  2.0;
+  }
+  std::vector<uint8_t> bytes{};
+  for (int16_t sample : pcm) {
+    putLE(bytes, static_cast<uint16_t>(sample), 2);
+  }
+  std::string path = createFile("int16.wav", createWav(1, 2, 16, bytes));
+
+  WAVFileDecoder decoder{};
+  ASSERT_TRUE(decoder.open(path));
+  ASSERT_EQ(decoder.getFormat(), WAVSampleFormat::Int16);
+  ASSERT_EQ(decoder.getChannel(), Channel::Stereo);
+  ASSERT_EQ(decoder.getSampleRate(), 44100);
+  ASSERT_EQ(decoder.getNumSamples(), numSamples);
+  ASSERT_NE(decoder.getInt16Samples(), nullptr);
+
+  // Blocks that do not divide the track.
+  std::vector<double> mono(numSamples + 999);
+  size_t total = 0;
+  size_t numRead = 0;
+  do {
+    numRead = decoder.readMono(mono.data() + total, 999);
+    total += numRead;
+  } while (numRead == 999);
+  mono.resize(total);
+  ASSERT_EQ(mono, expected);
+
+  ThreadPool pool{4};
+  WAVFileDecoder parallel{};
+  ASSERT_TRUE(parallel.open(path));
+  std::vector<double> parallelMono(numSamples);
+  ASSERT_EQ(parallel.readAllMonoParallel(parallelMono.data(), pool),
+            numSamples);
+  ASSERT_EQ(parallelMono, expected);
+
+  // Both channels, without down mixing.
+  WAVFileDecoder channels{};
+  ASSERT_TRUE(channels.open(path));
+  std::vector<double> left(numSamples);
+  std::vector<double> right(numSamples);
+  ASSERT_EQ(channels.readStereo(left.data(), right.data(), numSamples),
+            numSamples);
+  for (size_t n = 0; n < numSamples; n++) {
+    ASSERT_EQ(left[n], static_cast<double>(pcm[2 * n]) / INT16_MAX);
+    ASSERT_EQ(right[n], static_cast<double>(pcm[2 * n + 1]) / INT16_MAX);
+  }
+
+  // Seeking moves the read position of both read functions.
+  ASSERT_TRUE(channels.seek(1234));
+  double sample = 0.0;
+  ASSERT_EQ(channels.readMono(&sample, 1), 1u);
+  ASSERT_EQ(sample, expected[1234]);
+  ASSERT_EQ(channels.readStereo(left.data(), right.data(), 1), 1u);
+  ASSERT_EQ(left[0], static_cast<double>(pcm[2 * 1235]) / INT16_MAX);
+  ASSERT_FALSE(channels.seek(numSamples + 1));
+}
+
+/** @brief Every supported integer and float encoding is normalized. */
+TEST_F(WAVDecodingTest, SampleFormats) {
+  std::vector<uint8_t> bytes{};
+
+  putLE(bytes, 0, 1);
+  putLE(bytes, 128, 1);
+  putLE(bytes, 255, 1);
+  ASSERT_EQ(readAll(createFile("u8.wav", createWav(1, 1, 8, bytes))),
+            (std::vector<double>{-128.0 / 127, 0.0, 1.0}));
+
+  bytes.clear();
+  putLE(bytes, 0x800000, 3);
+  putLE(bytes, 0x7FFFFF, 3);
+  putLE(bytes, 0xFFFFFF, 3);
+  ASSERT_EQ(readAll(createFile("i24.wav", createWav(1, 1, 24, bytes))),
+            (std::vector<double>{-8388608.0 / 8388607, 1.0, -1.0 / 8388607}));
+
+  bytes.clear();
+  putLE(bytes, 0x80000000, 4);
+  putLE(bytes, 0x7FFFFFFF, 4);
+  ASSERT_EQ(readAll(createFile("i32.wav", createWav(1, 1, 32, bytes))),
+            (std::vector<double>{-2147483648.0 / INT32_MAX, 1.0}));
+
+  bytes.clear();
+  for (float sample : {0.5f, -0.25f}) {
+    uint32_t bits;
+    std::memcpy(&bits, &sample, 4);
+    putLE(bytes, bits, 4);
+  }
+  ASSERT_EQ(readAll(createFile("f32.wav", createWav(3, 1, 32, bytes, true))),
+            (std::vector<double>{0.5, -0.25}));
+
+  bytes.clear();
+  for (double sample : {0.1, -0.7}) {
+    uint64_t bits;
+    std::memcpy(&bits, &sample, 8);
+    putLE(bytes, bits, 8);
+  }
+  ASSERT_EQ(readAll(createFile("f64.wav", createWav(3, 2, 64, bytes))),
+            (std::vector<double>{(0.1 - 0.7) / 2.0}));
+}
+
+/** @brief The decoder is picked from the header, not the extension. */
+TEST_F(WAVDecodingTest, SelectedByHeader) {
+  std::vector<uint8_t> bytes(8, 0);
+  std::string wavPath = createFile("wav.mp3", createWav(1, 1, 16, bytes));
+  std::unique_ptr<AudioStream> wav = openAudioStream(wavPath);
+  ASSERT_NE(wav, nullptr);
+  ASSERT_NE(dynamic_cast<WAVFileDecoder*>(wav.get()), nullptr);
+  ASSERT_EQ(wav->getNumSamples(), 4u);
+
+  std::string mp3Path = createFile("mp3.wav", createTestMP3(10, true));
+  std::unique_ptr<AudioStream> mp3 = openAudioStream(mp3Path);
+  ASSERT_NE(mp3, nullptr);
+  ASSERT_NE(dynamic_cast<MP3Stream*>(mp3.get()), nullptr);
+}
+
+/** @brief Unsupported layouts fail to open. */
+TEST_F(WAVDecodingTest, Unsupported) {
+  std::vector<uint8_t> bytes(12, 0);
+  WAVFileDecoder decoder{};
+  ASSERT_FALSE(decoder.open(createFile("6ch.wav", createWav(1, 6, 16, bytes))));
+  ASSERT_FALSE(decoder.open(createFile("alaw.wav", createWav(6, 1, 8, bytes))));
+  ASSERT_FALSE(decoder.open(createFile("noise.wav", bytes)));
+  ASSERT_EQ(decoder.getNumSamples(), 0u);
+}
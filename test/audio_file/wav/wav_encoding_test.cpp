@@ -0,0 +1,155 @@
+/**
+ ******************************************************************************
+ * @file    wav_encoding_test.cpp
+ * @brief   Unit tests for the WAV file encoder.
+ ******************************************************************************
+ */
+
+#include "wav_encoding.h"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+#include "wav_decoding.h"
+
+namespace fs = std::filesystem;
+
+/** @brief Read a little endian value of numBytes bytes. */
+static uint64_t getLE(const std::vector<uint8_t>& in, size_t offset,
+                      size_t numBytes) {
+  uint64_t value = 0;
+  for (size_t i = 0; i < numBytes; i++) {
+    value |= static_cast<uint64_t>(in[offset + i]) << (8 * i);
+  }
+  return value;
+}
+
+/** @brief Temporary WAV files. */
+class WAVEncodingTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    dir = fs::temp_directory_path() / "swaratone_wav_encoding_test";
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+  }
+
+  void TearDown() override { fs::remove_all(dir); }
+
+  /** @brief Read a whole file. */
+  std::vector<uint8_t> readFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    return std::vector<uint8_t>(std::istreambuf_iterator<char>(file), {});
+  }
+
+  fs::path dir{};
+};
+
+/** @brief Every format reads back through the decoder within one LSB. */
+TEST_F(WAVEncodingTest, RoundTrip) {
+  const size_t numFrames = 3001;
+  std::vector<double> left(numFrames);
+  std::vector<double> right(numFrames);
+  for (size_t i = 0; i < numFrames; i++) {
+    left[i] = 0.9 * std::sin(0.01 * static_cast<double>(i));
+    right[i] = 0.5 * std::cos(0.03 * static_cast<double>(i));
+  }
+  const double* channels[] = {left.data(), right.data()};
+
+  const std::pair<WAVSampleFormat, double> formats[] = {
+      {WAVSampleFormat::UInt8, 1.0 / 127},
+      {WAVSampleFormat::Int16, 1.0 / 32767},
+      {WAVSampleFormat::Int24, 1.0 / 8388607},
+      {WAVSampleFormat::Int32, 1e-9},
+      {WAVSampleFormat::Float32, 1e-7},
+  };
+
+  WAVFileEncoder encoder{};
+  for (const auto& [format, tolerance] : formats) {
+    for (size_t numChannels : {1, 2}) {
+      std::string path = (dir / "out.wav").string();
+      ASSERT_TRUE(encoder.write(path, channels, numChannels, numFrames, format,
+                                48000));
+
+      WAVFileDecoder decoder{};
+      ASSERT_TRUE(decoder.open(path));
+      ASSERT_EQ(decoder.getFormat(), format);
+      ASSERT_EQ(decoder.getNumSamples(), numFrames);
+      ASSERT_EQ(decoder.getSampleRate(), 48000);
+      ASSERT_EQ(static_cast<size_t>(decoder.getChannel()), numChannels);
+
+      std::vector<double> mono(numFrames);
+      ASSERT_EQ(decoder.readMono(mono.data(), numFrames), numFrames);
+      for (size_t i = 0; i < numFrames; i++) {
+        const double expected =
+            numChannels == 1 ? left[i] : (left[i] + right[i]) / 2.0;
+        ASSERT_NEAR(mono[i], expected, tolerance);
+      }
+    }
+  }
+}
+
+/** @brief 8 bit samples are unsigned with 128 as silence. */
+TEST_F(WAVEncodingTest, UnsignedEightBit) {
+  std::vector<double> pcm{0.0, 1.0, -1.0};
+  std::string path = (dir / "u8").string();
+  WAVFileEncoder encoder{};
+  ASSERT_TRUE(encoder.writeToFile(path, pcm, 8, Channel::Mono, 8000));
+
+  std::vector<uint8_t> bytes = readFile(path + ".wav");
+  ASSERT_EQ(bytes.size(), 44u + 4u);  // Odd data is padded to even.
+  ASSERT_EQ(getLE(bytes, 40, 4), 3u);
+  ASSERT_EQ(bytes[44], 128);
+  ASSERT_EQ(bytes[45], 255);
+  ASSERT_EQ(bytes[46], 1);
+  ASSERT_EQ(bytes[47], 0);
+}
+
+/** @brief Headers hold consistent sizes and pick the right fmt layout. */
+TEST_F(WAVEncodingTest, Header) {
+  std::vector<uint8_t> pcm16 =
+      WAVFileEncoder::createHeader(WAVSampleFormat::Int16, 2, 100, 44100);
+  ASSERT_EQ(pcm16.size(), 44u);
+  ASSERT_EQ(getLE(pcm16, 4, 4), 36u + 400u);
+  ASSERT_EQ(getLE(pcm16, 20, 2), 1u);
+  ASSERT_EQ(getLE(pcm16, 28, 4), 44100u * 4u);
+
+  std::vector<uint8_t> float32 =
+      WAVFileEncoder::createHeader(WAVSampleFormat::Float32, 1, 100, 44100);
+  ASSERT_EQ(float32.size(), 12u + 48u + 12u + 8u);
+  ASSERT_EQ(getLE(float32, 20, 2), 0xFFFEu);
+  ASSERT_EQ(getLE(float32, 44, 2), 3u);  // Sub format.
+  ASSERT_EQ(std::memcmp(float32.data() + 60, "fact", 4), 0);
+  ASSERT_EQ(getLE(float32, 68, 4), 100u);
+}
+
+/** @brief Outputs over 4 GiB are written as RF64 with a ds64 chunk. */
+TEST_F(WAVEncodingTest, RF64) {
+  const uint64_t numFrames = uint64_t{1} << 30;
+  std::vector<uint8_t> header =
+      WAVFileEncoder::createHeader(WAVSampleFormat::Int24, 2, numFrames, 44100);
+  ASSERT_EQ(std::memcmp(header.data(), "RF64", 4), 0);
+  ASSERT_EQ(getLE(header, 4, 4), 0xFFFFFFFFu);
+  ASSERT_EQ(std::memcmp(header.data() + 12, "ds64", 4), 0);
+  ASSERT_EQ(getLE(header, 20, 8), header.size() - 8 + 6 * numFrames);
+  ASSERT_EQ(getLE(header, 28, 8), 6 * numFrames);
+  ASSERT_EQ(getLE(header, 36, 8), numFrames);
+  ASSERT_EQ(getLE(header, header.size() - 4, 4), 0xFFFFFFFFu);
+
+  // The decoder reads the sizes from ds64. Only a few frames are present.
+  std::string path = (dir / "rf64.wav").string();
+  std::ofstream file(path, std::ios::binary);
+  header.resize(header.size() + 6 * 4, 0);
+  file.write(reinterpret_cast<const char*>(header.data()), header.size());
+  file.close();
+
+  WAVFileDecoder decoder{};
+  ASSERT_TRUE(decoder.open(path));
+  ASSERT_EQ(decoder.getFormat(), WAVSampleFormat::Int24);
+  ASSERT_EQ(decoder.getNumSamples(), 4u);
+}
@@ -0,0 +1,93 @@
+/**
+ ******************************************************************************
+ * @file    batch_test.cpp
+ * @brief   Unit tests for batch input collection.
+ ******************************************************************************
+ */
+
+#include "batch.h"
+
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+
+namespace fs = std::filesystem;
+
+/** @brief Wildcards match any run or a single character. */
+TEST(Batch, MatchWildcard) {
+  ASSERT_TRUE(matchWildcard("*.mp3", "song.mp3"));
+  ASSERT_TRUE(matchWildcard("*.mp3", ".mp3"));
+  ASSERT_TRUE(matchWildcard("track??.mp3", "track07.mp3"));
+  ASSERT_TRUE(matchWildcard("*a*b*", "xxaYYbzz"));
+  ASSERT_TRUE(matchWildcard("*", ""));
+  ASSERT_TRUE(matchWildcard("a*a", "aaa"));
+
+  ASSERT_FALSE(matchWildcard("*.mp3", "song.mp3.bak"));
+  ASSERT_FALSE(matchWildcard("track??.mp3", "track7.mp3"));
+  ASSERT_FALSE(matchWildcard("a*b", "acbc"));
+  ASSERT_FALSE(matchWildcard("", "a"));
+}
+
+/** @brief Temporary directory with a few input files. */
+class BatchInputs : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    dir = fs::temp_directory_path() / "swaratone_batch_test";
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+    for (const char* name : {"b.mp3", "a.MP3", "c.wav", "notes.txt"}) {
+      std::ofstream(dir / name) << "x";
+    }
+  }
+
+  void TearDown() override { fs::remove_all(dir); }
+
+  fs::path dir{};
+};
+
+/** @brief A directory gives its MP3 and WAV files in sorted order. */
+TEST_F(BatchInputs, Directory) {
+  std::vector<std::string> files = collectBatchInputs(dir.string());
+  ASSERT_EQ(files, (std::vector<std::string>{(dir / "a.MP3").string(),
+                                             (dir / "b.mp3").string(),
+                                             (dir / "c.wav").string()}));
+}
+
+/** @brief A glob matches file names in its directory. */
+TEST_F(BatchInputs, Glob) {
+  std::vector<std::string> files = collectBatchInputs((dir / "*.wav").string());
+  ASSERT_EQ(files, std::vector<std::string>{(dir / "c.wav").string()});
+}
+
+/** @brief A manifest lists files relative to itself, skipping comments. */
+TEST_F(BatchInputs, Manifest) {
+  std::ofstream(dir / "list.txt") << "# tracks\n"
+                                  << "b.mp3\n"
+                                  << "\n"
+                                  << "  /abs/track.mp3  \r\n";
+
+  std::vector<std::string> files =
+      collectBatchInputs((dir / "list.txt").string());
+  ASSERT_EQ(files, (std::vector<std::string>{(dir / "b.mp3").string(),
+                                             "/abs/track.mp3"}));
+}
+
+/** @brief Quotes in file names are doubled in the summary. */
+TEST_F(BatchInputs, SummaryQuotes) {
+  const std::string file = (dir / "say \"hi\".mp3").string();
+  BatchOptions options{};
+  options.numJobs = 1;
+  options.numThreads = 1;
+  options.summaryPath = (dir / "summary.csv").string();
+  ASSERT_FALSE(runBatch({file}, options));
+
+  std::ifstream summary(options.summaryPath);
+  std::string header;
+  std::string line;
+  std::getline(summary, header);
+  std::getline(summary, line);
+
+  std::string quoted = (dir / "say \"\"hi\"\".mp3").string();
+  ASSERT_EQ(line.rfind("\"" + quoted + "\",failed,", 0), 0U) << line;
+}
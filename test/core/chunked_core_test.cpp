@@ -0,0 +1,67 @@
+/**
+ ******************************************************************************
+ * @file    chunked_core_test.cpp
+ * @brief   Unit tests for chunked stem separation.
+ ******************************************************************************
+ */
+
+#include "chunkedCore.h"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+#include "constants.h"
+#include "coreLogic.h"
+#include "test_helper.h"
+
+/** @brief Number of frames of the test signal. */
+static const size_t NUM_FRAMES = 120;
+
+/** @brief Create a padded random input of NUM_FRAMES frames. */
+static AlignedVector<double> createInput() {
+  const size_t numSamples = (NUM_FRAMES - 1) * HOP_SIZE;
+  AlignedVector<double> input(numSamples + PADDING_SIZE * 2, 0.0);
+  for (size_t n = 0; n < numSamples; n++) {
+    input[PADDING_SIZE + n] = generateRandomFloat(-0.5, 0.5);
+  }
+  return input;
+}
+
+/** @brief Chunked stems match a single chunk covering the whole track. */
+TEST(ChunkedCore, MatchesWholeTrack) {
+  AlignedVector<double> input = createInput();
+  const std::vector<StemBlend> blends{StemBlend{{0.8, 0.2}}};
+
+  std::vector<std::vector<double>> expected{};
+  separateStemsChunked(input, NUM_FRAMES, NUM_FRAMES, blends, expected);
+
+  const size_t chunkFrames = 40;
+  std::vector<std::vector<double>> stems{};
+  separateStemsChunked(input, NUM_FRAMES, chunkFrames, blends, stems);
+
+  ASSERT_EQ(stems.size(), expected.size());
+  for (size_t k = 0; k < stems.size(); k++) {
+    ASSERT_EQ(stems[k].size(), expected[k].size());
+    for (size_t n = 0; n < stems[k].size(); n++) {
+      ASSERT_NEAR(stems[k][n], expected[k][n], 1e-12)
+          << "stem " << k << " sample " << n;
+    }
+  }
+}
+
+/** @brief Planned chunks fit the budget, down to the smallest chunk size. */
+TEST(ChunkedCore, PlanChunkFrames) {
+  const size_t numSamples = 44100 * 120;
+  const size_t budget = size_t(512) << 20;
+
+  size_t frames = planChunkFrames(numSamples, budget);
+  ASSERT_GE(frames, MIN_CHUNK_FRAMES);
+  // Chunk matrices are planned with a quarter extra for size class rounding.
+  const size_t frameBytes = estimateFrameMemory() + HOP_SIZE * sizeof(double);
+  ASSERT_LE(estimateTrackMemory(numSamples) +
+                (frames + 2 * CHUNK_CONTEXT_FRAMES) * frameBytes / 4 * 5,
+            budget);
+
+  ASSERT_EQ(planChunkFrames(numSamples, 1), MIN_CHUNK_FRAMES);
+}
@@ -0,0 +1,149 @@
+/**
+ ******************************************************************************
+ * @file    task_graph_test.cpp
+ * @brief   Unit tests for the pipeline task graph.
+ ******************************************************************************
+ */
+
+#include "taskGraph.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "threadPool.h"
+
+/**
+ * @brief Build a diamond: a -> (b, c) -> d. Records the order stages finish
+ * in and when each buffer is released.
+ */
+class TaskGraphDiamond : public ::testing::Test {
+ protected:
+  void build() {
+    const auto ab = graph.addBuffer("ab", [this]() { record("free ab"); });
+    const auto bd = graph.addBuffer("bd", [this]() { record("free bd"); });
+    const auto cd = graph.addBuffer("cd", [this]() { record("free cd"); });
+    const auto out = graph.addBuffer("out", [this]() { record("free out"); });
+
+    a = graph.addStage("a", {}, {ab}, [this]() { record("a"); });
+    b = graph.addStage("b", {ab}, {bd}, [this]() { record("b"); });
+    c = graph.addStage("c", {ab}, {cd}, [this]() { record("c"); });
+    d = graph.addStage("d", {bd, cd}, {out}, [this]() { record("d"); });
+  }
+
+  void record(const std::string& event) {
+    std::lock_guard<std::mutex> lock(mutex);
+    events.push_back(event);
+  }
+
+  size_t position(const std::string& event) const {
+    for (size_t i = 0; i < events.size(); i++) {
+      if (events[i] == event) return i;
+    }
+    return events.size();
+  }
+
+  TaskGraph graph{};
+  TaskGraph::StageId a{0}, b{0}, c{0}, d{0};
+  std::mutex mutex{};
+  std::vector<std::string> events{};
+};
+
+/** @brief Stages run after their inputs and buffers are freed after use. */
+TEST_F(TaskGraphDiamond, RunsInDependencyOrder) {
+  build();
+
+  for (size_t numThreads : {1, 4}) {
+    events.clear();
+    ThreadPool pool(numThreads);
+    ASSERT_TRUE(graph.run(pool));
+
+    // Every stage runs once. The result buffer is never released.
+    ASSERT_EQ(events.size(), 7U);
+    ASSERT_EQ(position("free out"), events.size());
+
+    ASSERT_LT(position("a"), position("b"));
+    ASSERT_LT(position("a"), position("c"));
+    ASSERT_LT(position("b"), position("d"));
+    ASSERT_LT(position("c"), position("d"));
+
+    // A buffer is freed only after both of its readers finished.
+    ASSERT_LT(position("b"), position("free ab"));
+    ASSERT_LT(position("c"), position("free ab"));
+    ASSERT_LT(position("d"), position("free bd"));
+    ASSERT_LT(position("d"), position("free cd"));
+  }
+}
+
+/** @brief The critical path runs from the first to the last stage. */
+TEST_F(TaskGraphDiamond, CriticalPath) {
+  build();
+  ThreadPool pool(2);
+  ASSERT_TRUE(graph.run(pool));
+
+  std::vector<TaskGraph::StageId> path = graph.getCriticalPath();
+  ASSERT_EQ(path.size(), 3U);
+  ASSERT_EQ(path.front(), a);
+  ASSERT_EQ(path.back(), d);
+
+  double total = 0.0;
+  for (TaskGraph::StageId s : path) {
+    total += graph.getTiming(s).duration_ms;
+  }
+  ASSERT_NEAR(graph.getTiming(d).path_ms, total, 1e-9);
+}
+
+/** @brief A buffer with two producers is rejected. */
+TEST(TaskGraph, RejectsSecondProducer) {
+  TaskGraph graph{};
+  const auto buf = graph.addBuffer("buf");
+  bool ran = false;
+  graph.addStage("x", {}, {buf}, [&]() { ran = true; });
+  graph.addStage("y", {}, {buf}, [&]() { ran = true; });
+
+  ThreadPool pool(1);
+  ASSERT_FALSE(graph.run(pool));
+  ASSERT_FALSE(ran);
+}
+
+/** @brief Stages that depend on each other through a cycle are rejected. */
+TEST(TaskGraph, RejectsCycle) {
+  TaskGraph graph{};
+  const auto xy = graph.addBuffer("xy");
+  const auto yx = graph.addBuffer("yx");
+  graph.addStage("x", {yx}, {xy}, nullptr);
+  graph.addStage("y", {xy}, {yx}, nullptr);
+
+  ThreadPool pool(1);
+  ASSERT_FALSE(graph.run(pool));
+}
+
+/** @brief Independent stages can run at the same time. */
+TEST(TaskGraph, IndependentStagesOverlap) {
+  TaskGraph graph{};
+  std::atomic<int> running{0};
+  std::atomic<int> maxRunning{0};
+
+  auto stage = [&]() {
+    int now = ++running;
+    int seen = maxRunning;
+    while (now > seen && !maxRunning.compare_exchange_weak(seen, now)) {
+    }
+    // Wait a little for the other stage to start.
+    for (int i = 0; i < 1000 && maxRunning < 2; i++) {
+      std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+    running--;
+  };
+  graph.addStage("x", {}, {}, stage);
+  graph.addStage("y", {}, {}, stage);
+
+  ThreadPool pool(2);
+  ASSERT_TRUE(graph.run(pool));
+  ASSERT_EQ(maxRunning, 2);
+}
@@ -0,0 +1,151 @@
+/**
+ ******************************************************************************
+ * @file    signal_reconstruction_test.cpp
+ * @brief   Unit tests for parallel overlap-add signal reconstruction.
+ ******************************************************************************
+ */
+
+#include "signalReconstruction.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <complex>
+
+#include "constants.h"
+#include "fft_helper.hpp"
+#include "test_helper.h"
+#include "threadPool.h"
+#include "windowTable.h"
+
+/** @brief Number of frames. Not a multiple of the overlap-add block. */
+static const size_t NUM_FRAMES = 75;
+
+/** @brief Create a random complex spectrum. */
+static Matrix<std::complex<double>> createSpectrum() {
+  Matrix<std::complex<double>> spectrum{NUM_FRAMES,
+                                        getNyquistSize(WINDOW_SIZE)};
+  for (size_t i = 0; i < spectrum.getNumElements(); i++) {
+    spectrum(i) = {generateRandomFloat(-1.0, 1.0),
+                   generateRandomFloat(-1.0, 1.0)};
+  }
+  return spectrum;
+}
+
+/** @brief Overlap-add on a pool with a given number of threads. */
+static AlignedVector<double> overlapAdd(
+    Matrix<std::complex<double>>& spectrum, size_t numThreads) {
+  AlignedVector<double> signal((NUM_FRAMES - 1) * HOP_SIZE + WINDOW_SIZE,
+                               0.0);
+  ThreadPool pool(numThreads);
+  runSignalReconctructionThread(
+      spectrum, getWindowTable(WindowType::SqrtHann, WINDOW_SIZE), signal,
+      pool);
+  return signal;
+}
+
+/** @brief The result is bit identical for any thread count. */
+TEST(SignalReconstruction, DeterministicAcrossThreadCounts) {
+  Matrix<std::complex<double>> spectrum = createSpectrum();
+  AlignedVector<double> expected = overlapAdd(spectrum, 1);
+
+  for (size_t numThreads : {2, 3, 5, 8, 13}) {
+    AlignedVector<double> signal = overlapAdd(spectrum, numThreads);
+    ASSERT_EQ(signal, expected) << "numThreads = " << numThreads;
+  }
+}
+
+/** @brief The parallel result matches a serial overlap-add. */
+TEST(SignalReconstruction, MatchesSerial) {
+  Matrix<std::complex<double>> spectrum = createSpectrum();
+  AlignedVector<double> signal = overlapAdd(spectrum, 4);
+
+  AlignedVector<double> serial(signal.size(), 0.0);
+  complexSpectrumRowToSignal(spectrum,
+                             getWindowTable(WindowType::SqrtHann, WINDOW_SIZE),
+                             serial, 0, NUM_FRAMES);
+
+  for (size_t i = 0; i < signal.size(); i++) {
+    ASSERT_NEAR(signal[i], serial[i], PRECISION_ERROR);
+  }
+}
+
+/** @brief Stems from masks match reconstructing each masked spectrum. */
+TEST(SignalReconstruction, MultiStem) {
+  Matrix<std::complex<double>> interleaved = createSpectrum();
+  SplitComplexMatrix spectrum;
+  toSplitComplex(interleaved, spectrum);
+
+  Matrix<double> mask1{spectrum.getNumRows(), spectrum.getNumCols()};
+  Matrix<double> mask2{spectrum.getNumRows(), spectrum.getNumCols()};
+  for (size_t i = 0; i < mask1.getNumElements(); i++) {
+    mask1(i) = generateRandomFloat(0.0, 1.0);
+    mask2(i) = 1.0 - mask1(i);
+  }
+
+  std::vector<std::vector<double>> stems;
+  reconstructStems(spectrum, {&mask1, &mask2}, {StemBlend{{0.8, 0.2}}},
+                   stems);
+  ASSERT_EQ(stems.size(), 3U);
+
+  SplitComplexMatrix masked1;
+  SplitComplexMatrix masked2;
+  complexScale(spectrum, mask1, masked1);
+  complexScale(spectrum, mask2, masked2);
+
+  std::vector<double> expected1;
+  std::vector<double> expected2;
+  reconstructSignal(masked1, expected1);
+  reconstructSignal(masked2, expected2);
+
+  SplitComplexMatrix blendSpectrum{spectrum.getNumRows(),
+                                   spectrum.getNumCols()};
+  blendSpectrum.real() = masked1.real() * 0.8 + masked2.real() * 0.2;
+  blendSpectrum.imag() = masked1.imag() * 0.8 + masked2.imag() * 0.2;
+  std::vector<double> expectedBlend;
+  reconstructSignal(blendSpectrum, expectedBlend);
+
+  ASSERT_EQ(stems[0], expected1);
+  ASSERT_EQ(stems[1], expected2);
+  ASSERT_EQ(stems[2].size(), expectedBlend.size());
+  for (size_t i = 0; i < expectedBlend.size(); i++) {
+    ASSERT_NEAR(stems[2][i], expectedBlend[i], PRECISION_ERROR);
+  }
+}
+
+/** @brief Adding frames in ranges matches adding them all at once. */
+TEST(SignalReconstruction, StemSynthesizerRanges) {
+  Matrix<std::complex<double>> interleaved = createSpectrum();
+  SplitComplexMatrix spectrum;
+  toSplitComplex(interleaved, spectrum);
+
+  Matrix<double> mask1{spectrum.getNumRows(), spectrum.getNumCols()};
+  Matrix<double> mask2{spectrum.getNumRows(), spectrum.getNumCols()};
+  for (size_t i = 0; i < mask1.getNumElements(); i++) {
+    mask1(i) = generateRandomFloat(0.0, 1.0);
+    mask2(i) = 1.0 - mask1(i);
+  }
+  const std::vector<StemBlend> blends{StemBlend{{0.8, 0.2}}};
+
+  std::vector<std::vector<double>> expected;
+  reconstructStems(spectrum, {&mask1, &mask2}, blends, expected);
+
+  // Ranges shorter than a window, so samples carry over several ranges.
+  std::vector<std::vector<double>> stems;
+  StemSynthesizer synthesizer(NUM_FRAMES, 2, blends, stems);
+  for (size_t rowStart = 0; rowStart < NUM_FRAMES;) {
+    const size_t rowEnd = std::min(NUM_FRAMES, rowStart + 1 + rowStart % 7);
+    synthesizer.addFrames(spectrum, {&mask1, &mask2}, rowStart, rowEnd);
+    rowStart = rowEnd;
+  }
+  synthesizer.finish();
+
+  ASSERT_EQ(stems.size(), expected.size());
+  for (size_t k = 0; k < stems.size(); k++) {
+    ASSERT_EQ(stems[k].size(), expected[k].size());
+    for (size_t i = 0; i < stems[k].size(); i++) {
+      ASSERT_NEAR(stems[k][i], expected[k][i], PRECISION_ERROR)
+          << "stem " << k << " sample " << i;
+    }
+  }
+}
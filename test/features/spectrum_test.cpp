@@ -0,0 +1,151 @@
+/**
+ ******************************************************************************
+ * @file    spectrum_test.cpp
+ * @brief   Unit tests for spectrum creation.
+ ******************************************************************************
+ */
+
+#include "spectrum.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "constants.h"
+#include "test_helper.h"
+
+/** @brief Number of samples in the test signal. Not a multiple of the hop. */
+static const size_t NUM_SAMPLES = 150 * HOP_SIZE + 321;
+
+/** @brief Create a random test signal. */
+static std::vector<double> createSignal() {
+  std::vector<double> signal(NUM_SAMPLES);
+  for (double& sample : signal) {
+    sample = generateRandomFloat(-1.0, 1.0);
+  }
+  return signal;
+}
+
+/** @brief Compute every spectrum of a signal from the whole padded input. */
+static void createBatchSpectra(const std::vector<double>& signal,
+                               SplitComplexMatrix& complexSpectrum,
+                               Matrix<double>& powerSpectrum,
+                               Matrix<double>& magnitudeSpectrum) {
+  AlignedVector<double> input(signal.size() + PADDING_SIZE * 2, 0.0);
+  std::copy(signal.begin(), signal.end(), input.begin() + PADDING_SIZE);
+
+  createSpectra(input, signal.size() / HOP_SIZE + 1,
+                {&complexSpectrum, &powerSpectrum, &magnitudeSpectrum});
+}
+
+/**
+ * @brief Source handing out a signal in blocks of at most blockSize samples,
+ * ending after numAvailable samples.
+ */
+static SampleSource createSource(const std::vector<double>& signal,
+                                 size_t& position, size_t blockSize,
+                                 size_t numAvailable) {
+  return [&signal, &position, blockSize, numAvailable](double* out,
+                                                       size_t maxSamples) {
+    size_t n = std::min({maxSamples, blockSize, numAvailable - position});
+    std::copy(signal.begin() + position, signal.begin() + position + n, out);
+    position += n;
+    return n;
+  };
+}
+
+/** @brief Streamed spectra match the batch spectra exactly. */
+TEST(Spectrum, StreamedMatchesBatch) {
+  std::vector<double> signal = createSignal();
+
+  SplitComplexMatrix complexSpectrum{};
+  Matrix<double> powerSpectrum{};
+  Matrix<double> magnitudeSpectrum{};
+  createBatchSpectra(signal, complexSpectrum, powerSpectrum,
+                     magnitudeSpectrum);
+
+  SplitComplexMatrix streamedComplex{};
+  Matrix<double> streamedPower{};
+  Matrix<double> streamedMagnitude{};
+  size_t position = 0;
+  createSpectraStreamed(NUM_SAMPLES,
+                        {&streamedComplex, &streamedPower, &streamedMagnitude},
+                        createSource(signal, position, 1000, NUM_SAMPLES));
+
+  ASSERT_EQ(position, NUM_SAMPLES);
+  ASSERT_EQ(streamedComplex.size(), complexSpectrum.size());
+  for (size_t i = 0; i < complexSpectrum.getNumElements(); i++) {
+    ASSERT_EQ(streamedComplex(i), complexSpectrum(i));
+    ASSERT_EQ(streamedPower(i), powerSpectrum(i));
+    ASSERT_EQ(streamedMagnitude(i), magnitudeSpectrum(i));
+  }
+}
+
+/** @brief A source that ends early is padded with zeros. */
+TEST(Spectrum, StreamedSourceEndsEarly) {
+  std::vector<double> signal = createSignal();
+  const size_t numAvailable = NUM_SAMPLES / 2;
+
+  std::vector<double> truncated = signal;
+  std::fill(truncated.begin() + numAvailable, truncated.end(), 0.0);
+
+  SplitComplexMatrix complexSpectrum{};
+  Matrix<double> powerSpectrum{};
+  Matrix<double> magnitudeSpectrum{};
+  createBatchSpectra(truncated, complexSpectrum, powerSpectrum,
+                     magnitudeSpectrum);
+
+  SplitComplexMatrix streamedComplex{};
+  size_t position = 0;
+  createSpectraStreamed(NUM_SAMPLES, {&streamedComplex},
+                        createSource(signal, position, 777, numAvailable));
+
+  ASSERT_EQ(streamedComplex.size(), complexSpectrum.size());
+  for (size_t i = 0; i < complexSpectrum.getNumElements(); i++) {
+    ASSERT_EQ(streamedComplex(i), complexSpectrum(i));
+  }
+}
+
+/** @brief Stereo spectra share the mean power of both channels. */
+TEST(Spectrum, Stereo) {
+  std::vector<double> left = createSignal();
+  std::vector<double> right = createSignal();
+  const size_t numFrames = NUM_SAMPLES / HOP_SIZE + 1;
+
+  SplitComplexMatrix leftComplex{};
+  Matrix<double> leftPower{};
+  Matrix<double> leftMagnitude{};
+  createBatchSpectra(left, leftComplex, leftPower, leftMagnitude);
+  SplitComplexMatrix rightComplex{};
+  Matrix<double> rightPower{};
+  Matrix<double> rightMagnitude{};
+  createBatchSpectra(right, rightComplex, rightPower, rightMagnitude);
+
+  AlignedVector<double> leftInput(NUM_SAMPLES + PADDING_SIZE * 2, 0.0);
+  AlignedVector<double> rightInput(NUM_SAMPLES + PADDING_SIZE * 2, 0.0);
+  std::copy(left.begin(), left.end(), leftInput.begin() + PADDING_SIZE);
+  std::copy(right.begin(), right.end(), rightInput.begin() + PADDING_SIZE);
+
+  SplitComplexMatrix stereoLeft{};
+  SplitComplexMatrix stereoRight{};
+  Matrix<double> power{};
+  createStereoSpectra(leftInput, rightInput, numFrames, stereoLeft,
+                      stereoRight, power);
+
+  ASSERT_EQ(stereoLeft.size(), leftComplex.size());
+  ASSERT_EQ(power.size(), leftPower.size());
+  for (size_t i = 0; i < leftComplex.getNumElements(); i++) {
+    ASSERT_EQ(stereoLeft(i), leftComplex(i));
+    ASSERT_EQ(stereoRight(i), rightComplex(i));
+    ASSERT_DOUBLE_EQ(power(i), (leftPower(i) + rightPower(i)) / 2.0);
+  }
+
+  // Identical channels give the spectra of the mono signal.
+  createStereoSpectra(leftInput, leftInput, numFrames, stereoLeft, stereoRight,
+                      power);
+  for (size_t i = 0; i < leftComplex.getNumElements(); i++) {
+    ASSERT_EQ(power(i), leftPower(i));
+  }
+}
@@ -0,0 +1,40 @@
+/**
+ ******************************************************************************
+ * @file    fft_plan_test.cpp
+ * @brief   Unit tests for precomputed FFT plans.
+ ******************************************************************************
+ */
+#include "fftPlan.h"
+
+#include <gtest/gtest.h>
+
+#include <complex>
+#include <vector>
+
+#include "test_helper.h"
+
+/** @brief Plans are built once per size and direction. */
+TEST(fftPlan, Cached) {
+  ASSERT_EQ(&getFFTPlan(64, false), &getFFTPlan(64, false));
+  ASSERT_NE(&getFFTPlan(64, false), &getFFTPlan(64, true));
+  ASSERT_NE(&getFFTPlan(64, false), &getFFTPlan(128, false));
+  ASSERT_EQ(getFFTPlan(128, true).size(), 128);
+}
+
+/** @brief Forward then inverse recovers the input scaled by N. */
+TEST(fftPlan, RoundTrip) {
+  const uint32_t N = 256;
+  std::vector<std::complex<double>> x(N);
+  for (std::complex<double>& value : x) {
+    value = {generateRandomFloat(-1.0, 1.0), generateRandomFloat(-1.0, 1.0)};
+  }
+
+  std::vector<std::complex<double>> y = x;
+  getFFTPlan(N, false).execute(y.data());
+  getFFTPlan(N, true).execute(y.data());
+
+  for (uint32_t i = 0; i < N; i++) {
+    ASSERT_NEAR(y[i].real() / N, x[i].real(), PRECISION_ERROR);
+    ASSERT_NEAR(y[i].imag() / N, x[i].imag(), PRECISION_ERROR);
+  }
+}
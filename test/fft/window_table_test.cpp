@@ -0,0 +1,99 @@
+/**
+ ******************************************************************************
+ * @file    window_table_test.cpp
+ * @brief   Unit tests for window function tables.
+ ******************************************************************************
+ */
+#include "windowTable.h"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <vector>
+
+#include "fft.h"
+#include "frequencyDomain.h"
+#include "test_helper.h"
+#include "windowingFunctions.hpp"
+
+/** @brief Tables are built once and shared between callers. */
+TEST(windowTable, Cached) {
+  const AlignedVector<double>& a = getWindowTable(WindowType::Hann, 64);
+  const AlignedVector<double>& b = getWindowTable(WindowType::Hann, 64);
+  const AlignedVector<double>& c = getWindowTable(WindowType::Hann, 128);
+  const AlignedVector<double>& d = getWindowTable(WindowType::Hamming, 64);
+
+  ASSERT_EQ(&a, &b);
+  ASSERT_NE(&a, &c);
+  ASSERT_NE(&a, &d);
+  ASSERT_EQ(a.size(), 64);
+  ASSERT_EQ(c.size(), 128);
+}
+
+/** @brief Hann tables match the per-sample window functions exactly. */
+TEST(windowTable, HannMatchesWeights) {
+  const int N = 256;
+  const AlignedVector<double>& hann = getWindowTable(WindowType::Hann, N);
+  const AlignedVector<double>& sqrtHann =
+      getWindowTable(WindowType::SqrtHann, N);
+
+  for (int n = 0; n < N; n++) {
+    ASSERT_EQ(hann[n], getHanningWindowWeight(n, N));
+    ASSERT_EQ(sqrtHann[n], getSqrtHanningWindowWeight(n, N));
+  }
+}
+
+/** @brief Every window is symmetric and peaks at one in the centre. */
+TEST(windowTable, SymmetricWithUnitPeak) {
+  const uint32_t N = 129;
+  for (WindowType type :
+       {WindowType::Hann, WindowType::SqrtHann, WindowType::Hamming,
+        WindowType::BlackmanHarris, WindowType::Kaiser}) {
+    const AlignedVector<double>& w = getWindowTable(type, N);
+    for (uint32_t n = 0; n < N; n++) {
+      ASSERT_NEAR(w[n], w[N - 1 - n], PRECISION_ERROR);
+      ASSERT_LE(w[n], 1.0 + PRECISION_ERROR);
+    }
+    ASSERT_NEAR(w[N / 2], 1.0, PRECISION_ERROR);
+  }
+}
+
+/** @brief Window end points match their textbook values. */
+TEST(windowTable, EndPoints) {
+  const uint32_t N = 64;
+  ASSERT_NEAR(getWindowTable(WindowType::Hann, N)[0], 0.0, PRECISION_ERROR);
+  ASSERT_NEAR(getWindowTable(WindowType::Hamming, N)[0], 0.08,
+              PRECISION_ERROR);
+  ASSERT_NEAR(getWindowTable(WindowType::BlackmanHarris, N)[0], 6e-5,
+              PRECISION_ERROR);
+
+  // Kaiser end points are 1 / I0(beta).
+  double kaiserEdge = getWindowTable(WindowType::Kaiser, N)[0];
+  ASSERT_NEAR(kaiserEdge * std::cyl_bessel_i(0.0, KAISER_BETA), 1.0,
+              PRECISION_ERROR);
+}
+
+/** @brief The windowed FFT matches windowing a copy first. */
+TEST(windowTable, FusedWindowFFT) {
+  const uint32_t N = 64;
+  std::vector<double> x(N);
+  for (uint32_t n = 0; n < N; n++) {
+    x[n] = generateRandomFloat(-1.0, 1.0);
+  }
+
+  std::vector<double> windowed = x;
+  applySqrtHanningWindow(windowed.data(), N);
+
+  frequencyDomain expected;
+  initFrequncyDomain(N, expected);
+  runFFT(windowed.data(), N, expected);
+
+  frequencyDomain fused;
+  initFrequncyDomain(N, fused);
+  runFFT(x.data(), getWindowTable(WindowType::SqrtHann, N).data(), N, fused);
+
+  ASSERT_EQ(fused.frequency.size(), expected.frequency.size());
+  for (size_t i = 0; i < fused.frequency.size(); i++) {
+    ASSERT_EQ(fused.frequency[i], expected.frequency[i]);
+  }
+}
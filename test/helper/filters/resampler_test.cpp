@@ -0,0 +1,131 @@
+/**
+ ******************************************************************************
+ * @file    resampler_test.cpp
+ * @brief   Unit tests for the polyphase resampler.
+ ******************************************************************************
+ */
+
+#include "resampler.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "constants.h"
+
+/** @brief Samples of a sine of frequency_hz at sampleRate. */
+static std::vector<double> createSine(size_t numSamples, double frequency_hz,
+                                      double sampleRate) {
+  std::vector<double> out(numSamples);
+  for (size_t i = 0; i < numSamples; i++) {
+    out[i] = 0.5 * std::sin(2.0 * PI * frequency_hz * i / sampleRate);
+  }
+  return out;
+}
+
+/** @brief Resample a whole signal. */
+static std::vector<double> resampleAll(const Resampler& resampler,
+                                       const std::vector<double>& in) {
+  std::vector<double> out(resampler.getOutputSize(in.size()));
+  resampler.process(in.data(), 0, in.size(), 0, out.size(), out.data());
+  return out;
+}
+
+/**
+ * @brief Largest error against the ideal sine, away from both ends where the
+ * filter sees the zeros outside the signal.
+ */
+static double getSineError(const std::vector<double>& out,
+                           double frequency_hz, double sampleRate,
+                           size_t margin) {
+  double maxError = 0.0;
+  for (size_t i = margin; i + margin < out.size(); i++) {
+    const double expected =
+        0.5 * std::sin(2.0 * PI * frequency_hz * i / sampleRate);
+    maxError = std::max(maxError, std::abs(out[i] - expected));
+  }
+  return maxError;
+}
+
+/** @brief Equal rates copy the input. */
+TEST(Resampler, EqualRatesCopy) {
+  Resampler resampler(44100, 44100);
+  std::vector<double> in = createSine(1000, 440.0, 44100.0);
+  ASSERT_EQ(resampler.getOutputSize(in.size()), in.size());
+  ASSERT_EQ(resampleAll(resampler, in), in);
+}
+
+/** @brief Each preset reconstructs a sine to its expected accuracy. */
+TEST(Resampler, SineAccuracy) {
+  const struct {
+    ResampleQuality quality;
+    double tolerance;
+  } presets[] = {{ResampleQuality::Fast, 2e-3},
+                 {ResampleQuality::Balanced, 1e-4},
+                 {ResampleQuality::Best, 1e-5}};
+
+  for (const auto& preset : presets) {
+    for (auto [inRate, outRate] :
+         {std::pair{44100u, 48000u}, std::pair{48000u, 44100u},
+          std::pair{48000u, 22050u}}) {
+      Resampler resampler(inRate, outRate, preset.quality);
+      std::vector<double> in = createSine(20000, 1000.0, inRate);
+      std::vector<double> out = resampleAll(resampler, in);
+      ASSERT_EQ(out.size(),
+                (in.size() * outRate + inRate - 1) / inRate);
+
+      const double error = getSineError(out, 1000.0, outRate,
+                                        resampler.getNumTaps() * 2);
+      ASSERT_LT(error, preset.tolerance) << inRate << " -> " << outRate;
+    }
+  }
+}
+
+/** @brief Tones above the output Nyquist rate are filtered out. */
+TEST(Resampler, AliasRejection) {
+  for (ResampleQuality quality : {ResampleQuality::Fast,
+                                  ResampleQuality::Balanced,
+                                  ResampleQuality::Best}) {
+    Resampler resampler(48000, 22050, quality);
+    std::vector<double> in = createSine(20000, 15000.0, 48000.0);
+    std::vector<double> out = resampleAll(resampler, in);
+
+    const size_t margin = resampler.getNumTaps() * 2;
+    double peak = 0.0;
+    for (size_t i = margin; i + margin < out.size(); i++) {
+      peak = std::max(peak, std::abs(out[i]));
+    }
+    ASSERT_LT(peak, 1e-3);
+  }
+}
+
+/** @brief Ratios with more phases than the bank holds stay accurate. */
+TEST(Resampler, InterpolatedPhases) {
+  Resampler resampler(44100, 44101);
+  std::vector<double> in = createSine(20000, 1000.0, 44100.0);
+  std::vector<double> out = resampleAll(resampler, in);
+  ASSERT_LT(getSineError(out, 1000.0, 44101.0, resampler.getNumTaps() * 2),
+            1e-4);
+}
+
+/** @brief Blocks with only the input they need match the whole signal. */
+TEST(Resampler, BlocksMatchWhole) {
+  Resampler resampler(44100, 48000, ResampleQuality::Fast);
+  std::vector<double> in = createSine(5000, 3000.0, 44100.0);
+  std::vector<double> expected = resampleAll(resampler, in);
+
+  std::vector<double> out(expected.size());
+  for (size_t first = 0; first < out.size(); first += 777) {
+    const size_t count = std::min<size_t>(777, out.size() - first);
+    const int64_t inFirst =
+        std::max<int64_t>(0, resampler.getFirstInput(first));
+    const int64_t inEnd = std::min<int64_t>(
+        static_cast<int64_t>(in.size()), resampler.getEndInput(first + count));
+    resampler.process(in.data() + inFirst, inFirst,
+                      static_cast<size_t>(inEnd - inFirst), first, count,
+                      out.data() + first);
+  }
+  ASSERT_EQ(out, expected);
+}
@@ -357,3 +357,50 @@ TEST(Matrix, Transpose) {
     }
   }
 }
+
+/** @brief Verify that a chained expression is evaluated element-wise and the
+ * operands are left untouched. */
+TEST(Matrix, ChainedExpression) {
+  // Initialize 2 complex matrices and a real mask.
+  size_t r = 2;
+  size_t c = 2;
+  std::vector<DoubleComplex> data1{
+      {1.0, 2.0}, {3.0, 4.0}, {5.0, 6.0}, {7.0, 8.0}};
+  std::vector<DoubleComplex> data2{
+      {2.0, 0.0}, {0.0, 2.0}, {4.0, 4.0}, {1.0, 1.0}};
+  std::vector<double> data3{1.0, 0.5, 0.0, 2.0};
+  Matrix<DoubleComplex> m1{r, c, data1};
+  Matrix<DoubleComplex> m2{r, c, data2};
+  Matrix<double> mask{r, c, data3};
+
+  // Evaluate a blended and masked expression.
+  Matrix<DoubleComplex> result = (m1 * 0.8 + 0.2 * m2) * mask;
+
+  for (size_t i = 0; i < r * c; i++) {
+    DoubleComplex expected = (data1[i] * 0.8 + 0.2 * data2[i]) * data3[i];
+    ASSERT_NEAR(result(i).real(), expected.real(), PRECISION_ERROR);
+    ASSERT_NEAR(result(i).imag(), expected.imag(), PRECISION_ERROR);
+
+    // Scaling in an expression must not modify the operands.
+    ASSERT_NEAR(m1(i).real(), data1[i].real(), PRECISION_ERROR);
+    ASSERT_NEAR(m2(i).imag(), data2[i].imag(), PRECISION_ERROR);
+  }
+}
+
+/** @brief Verify that a matrix can appear on both sides of an assignment. */
+TEST(Matrix, ExpressionAliasing) {
+  // Initialize 2 matrices with data.
+  size_t r = 2;
+  size_t c = 3;
+  std::vector<double> data1{1.0, 2.0, 3.0, 4.0, 5.0, 6.0};
+  std::vector<double> data2{2.0, 6.0, 7.0, 2.0, 9.0, 6.0};
+  Matrix<double> m1{r, c, data1};
+  Matrix<double> m2{r, c, data2};
+
+  // Assign an expression that reads the destination.
+  m1 = m1 * m2 - m1;
+
+  for (size_t i = 0; i < r * c; i++) {
+    ASSERT_NEAR(m1(i), data1[i] * data2[i] - data1[i], PRECISION_ERROR);
+  }
+}
@@ -0,0 +1,90 @@
+/**
+ ******************************************************************************
+ * @file    matrix_view_test.cpp
+ * @brief   Unit tests for Matrix row, column and block views.
+ ******************************************************************************
+ */
+
+#include "matrix_view.hpp"
+
+#include <gtest/gtest.h>
+
+#include "matrix.hpp"
+#include "test_helper.h"
+
+/** @brief Verify that a row view aliases the matrix row without copying. */
+TEST(MatrixView, RowView) {
+  // Initialize the matrix with data.
+  std::vector<double> data{1.0, 2.0, 3.0, 4.0, 5.0, 6.0};
+  Matrix<double> m{2, 3, data};
+
+  // Assert the view reads the second row.
+  RowView<double> row = m.row(1);
+  ASSERT_EQ(row.size(), 3U);
+  ASSERT_EQ(row.data(), &m(1, 0));
+  ASSERT_NEAR(row[0], 4.0, PRECISION_ERROR);
+  ASSERT_NEAR(row[2], 6.0, PRECISION_ERROR);
+
+  // Assert writes through the view land in the matrix.
+  row[1] = 10.0;
+  ASSERT_NEAR(m(1, 1), 10.0, PRECISION_ERROR);
+}
+
+/** @brief Verify that a column view steps across rows. */
+TEST(MatrixView, ColView) {
+  // Initialize the matrix with data.
+  std::vector<double> data{1.0, 2.0, 3.0, 4.0, 5.0, 6.0, 7.0, 8.0, 9.0};
+  const Matrix<double> m{3, 3, data};
+
+  // Assert the view reads the middle column.
+  ColView<const double> col = m.col(1);
+  ASSERT_EQ(col.size(), 3U);
+  ASSERT_EQ(col.stride(), 3U);
+
+  std::vector<double> expected{2.0, 5.0, 8.0};
+  size_t i = 0;
+  for (double value : col) {
+    ASSERT_NEAR(value, expected[i++], PRECISION_ERROR);
+  }
+}
+
+/** @brief Verify sub ranges and slices of a strided span. */
+TEST(MatrixView, StridedSpanSlice) {
+  std::vector<int> data{0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+  StridedSpan<int> span(data.data(), data.size());
+
+  // Contiguous sub range.
+  StridedSpan<int> sub = span.subspan(2, 3);
+  ASSERT_EQ(sub.size(), 3U);
+  ASSERT_EQ(sub[0], 2);
+  ASSERT_EQ(sub[2], 4);
+
+  // Every third element starting at 1.
+  StridedSpan<int> slice = span.slice(1, 3, 3);
+  ASSERT_EQ(slice.size(), 3U);
+  ASSERT_EQ(slice[0], 1);
+  ASSERT_EQ(slice[1], 4);
+  ASSERT_EQ(slice[2], 7);
+  ASSERT_EQ(slice.end() - slice.begin(), 3);
+}
+
+/** @brief Verify that a block view exposes the requested sub matrix. */
+TEST(MatrixView, BlockView) {
+  // Initialize a 3 x 4 matrix with data.
+  std::vector<double> data{1.0, 2.0, 3.0, 4.0,  5.0,  6.0,
+                           7.0, 8.0, 9.0, 10.0, 11.0, 12.0};
+  Matrix<double> m{3, 4, data};
+
+  // Take the bottom right 2 x 2 block.
+  BlockView<double> block = m.block(1, 2, 2, 2);
+  ASSERT_EQ(block.getNumRows(), 2U);
+  ASSERT_EQ(block.getNumCols(), 2U);
+  ASSERT_NEAR(block(0, 0), 7.0, PRECISION_ERROR);
+  ASSERT_NEAR(block(1, 1), 12.0, PRECISION_ERROR);
+  ASSERT_NEAR(block.row(1)[0], 11.0, PRECISION_ERROR);
+  ASSERT_NEAR(block.col(1)[0], 8.0, PRECISION_ERROR);
+
+  // Assert writes through the block land in the matrix.
+  block(1, 0) = -1.0;
+  ASSERT_NEAR(m(2, 2), -1.0, PRECISION_ERROR);
+}
@@ -0,0 +1,196 @@
+/**
+ ******************************************************************************
+ * @file    pcm_kernels_test.cpp
+ * @brief   Unit tests for PCM conversion kernels.
+ ******************************************************************************
+ */
+
+#include "pcmKernels.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+/** @brief Frame counts around the SIMD widths, with remainders. */
+static const size_t FRAME_COUNTS[] = {0, 1, 3, 4, 7, 8, 19, 64, 1001};
+
+/** @brief Deterministic int16 samples covering both extremes. */
+static std::vector<int16_t> createInt16(size_t n) {
+  std::vector<int16_t> out(n);
+  for (size_t i = 0; i < n; i++) {
+    out[i] = static_cast<int16_t>(static_cast<int>(i * 7919 % 65536) - 32768);
+  }
+  if (n > 1) {
+    out[0] = INT16_MIN;
+    out[1] = INT16_MAX;
+  }
+  return out;
+}
+
+/** @brief Deterministic doubles, partly outside [-1, 1]. */
+static std::vector<double> createDoubles(size_t n, double offset) {
+  std::vector<double> out(n);
+  for (size_t i = 0; i < n; i++) {
+    out[i] = 1.3 * std::sin(0.37 * static_cast<double>(i) + offset);
+  }
+  return out;
+}
+
+/** @brief Decoding splits and down mixes exactly like the scalar formulas. */
+TEST(PCMKernels, DecodeMatchesScalar) {
+  for (size_t numChannels : {1, 2, 3}) {
+    for (size_t numFrames : FRAME_COUNTS) {
+      std::vector<int16_t> in16 = createInt16(numFrames * numChannels);
+      std::vector<int32_t> in32(in16.size());
+      std::vector<float> inFloat(in16.size());
+      for (size_t i = 0; i < in16.size(); i++) {
+        // in16 repeated in both halves, without signed overflow.
+        in32[i] = static_cast<int32_t>(
+            static_cast<uint32_t>(static_cast<uint16_t>(in16[i])) << 16 |
+            static_cast<uint16_t>(in16[i]));
+        inFloat[i] = static_cast<float>(in16[i]) / 1000.0f;
+      }
+
+      std::vector<std::vector<double>> split(numChannels,
+                                             std::vector<double>(numFrames));
+      std::vector<double*> out{};
+      for (std::vector<double>& channel : split) {
+        out.push_back(channel.data());
+      }
+      std::vector<double> mono(numFrames);
+
+      int16ToDouble(in16.data(), numChannels, numFrames, out.data());
+      int16ToMono(in16.data(), numChannels, numFrames, mono.data());
+      for (size_t i = 0; i < numFrames; i++) {
+        double sum = 0.0;
+        for (size_t c = 0; c < numChannels; c++) {
+          const double expected =
+              static_cast<double>(in16[i * numChannels + c]) / INT16_MAX;
+          ASSERT_EQ(split[c][i], expected);
+          sum += expected;
+        }
+        ASSERT_EQ(mono[i], sum / static_cast<double>(numChannels));
+      }
+
+      int32ToDouble(in32.data(), numChannels, numFrames, out.data());
+      int32ToMono(in32.data(), numChannels, numFrames, mono.data());
+      for (size_t i = 0; i < numFrames; i++) {
+        double sum = 0.0;
+        for (size_t c = 0; c < numChannels; c++) {
+          const double expected =
+              static_cast<double>(in32[i * numChannels + c]) / INT32_MAX;
+          ASSERT_EQ(split[c][i], expected);
+          sum += expected;
+        }
+        ASSERT_EQ(mono[i], sum / static_cast<double>(numChannels));
+      }
+
+      floatToDouble(inFloat.data(), numChannels, numFrames, out.data());
+      floatToMono(inFloat.data(), numChannels, numFrames, mono.data());
+      for (size_t i = 0; i < numFrames; i++) {
+        double sum = 0.0;
+        for (size_t c = 0; c < numChannels; c++) {
+          const double expected = inFloat[i * numChannels + c];
+          ASSERT_EQ(split[c][i], expected);
+          sum += expected;
+        }
+        ASSERT_EQ(mono[i], sum / static_cast<double>(numChannels));
+      }
+    }
+  }
+}
+
+/** @brief Encoding clamps, truncates and interleaves without dither. */
+TEST(PCMKernels, EncodeMatchesScalar) {
+  for (size_t numChannels : {1, 2, 3}) {
+    for (size_t numFrames : FRAME_COUNTS) {
+      std::vector<std::vector<double>> channels{};
+      std::vector<const double*> in{};
+      for (size_t c = 0; c < numChannels; c++) {
+        channels.push_back(createDoubles(numFrames, static_cast<double>(c)));
+        in.push_back(channels[c].data());
+      }
+
+      const size_t numSamples = numFrames * numChannels;
+      std::vector<uint8_t> out8(numSamples);
+      std::vector<int16_t> out16(numSamples);
+      std::vector<uint8_t> out24(3 * numSamples);
+      std::vector<int32_t> out32(numSamples);
+      std::vector<float> outFloat(numSamples);
+      doubleToUInt8(in.data(), numChannels, numFrames, out8.data());
+      doubleToInt16(in.data(), numChannels, numFrames, out16.data());
+      doubleToInt24(in.data(), numChannels, numFrames, out24.data());
+      doubleToInt32(in.data(), numChannels, numFrames, out32.data());
+      doubleToFloat(in.data(), numChannels, numFrames, outFloat.data());
+
+      for (size_t i = 0; i < numFrames; i++) {
+        for (size_t c = 0; c < numChannels; c++) {
+          const size_t index = i * numChannels + c;
+          const double x = std::clamp(channels[c][i], -1.0, 1.0);
+          ASSERT_EQ(out8[index], static_cast<int>(x * INT8_MAX) + 128);
+          ASSERT_EQ(out16[index], static_cast<int16_t>(x * INT16_MAX));
+          ASSERT_EQ(out32[index], static_cast<int32_t>(x * INT32_MAX));
+          ASSERT_EQ(outFloat[index], static_cast<float>(channels[c][i]));
+
+          const uint8_t* bytes = out24.data() + 3 * index;
+          const int32_t packed =
+              static_cast<int32_t>(static_cast<uint32_t>(bytes[0]) << 8 |
+                                   static_cast<uint32_t>(bytes[1]) << 16 |
+                                   static_cast<uint32_t>(bytes[2]) << 24) /
+              256;
+          ASSERT_EQ(packed, static_cast<int32_t>(x * 8388607.0));
+        }
+      }
+    }
+  }
+}
+
+/** @brief Full scale maps to the largest sample and beyond is clamped. */
+TEST(PCMKernels, EncodeClamps) {
+  std::vector<double> samples{1.0, -1.0, 2.0, -2.0, 0.0};
+  const double* in[] = {samples.data()};
+  std::vector<int16_t> out(samples.size());
+  doubleToInt16(in, 1, samples.size(), out.data());
+  ASSERT_EQ(out, (std::vector<int16_t>{INT16_MAX, -INT16_MAX, INT16_MAX,
+                                       -INT16_MAX, 0}));
+}
+
+/** @brief Dither stays within one LSB, averages out and is seeded. */
+TEST(PCMKernels, Dither) {
+  const size_t numFrames = 20001;
+  std::vector<double> left(numFrames, 1000.25 / INT16_MAX);
+  std::vector<double> right(numFrames, -1.0);
+  const double* in[] = {left.data(), right.data()};
+
+  std::vector<int16_t> out(2 * numFrames);
+  TPDFDither dither{42};
+  doubleToInt16(in, 2, numFrames, out.data(), &dither);
+
+  double sum = 0.0;
+  for (size_t i = 0; i < numFrames; i++) {
+    ASSERT_GE(out[2 * i], 999);
+    ASSERT_LE(out[2 * i], 1002);
+    ASSERT_GE(out[2 * i + 1], INT16_MIN);
+    ASSERT_LE(out[2 * i + 1], -INT16_MAX + 1);
+    sum += out[2 * i];
+  }
+  ASSERT_NEAR(sum / numFrames, 1000.25, 0.05);
+
+  std::vector<int16_t> again(2 * numFrames);
+  TPDFDither sameSeed{42};
+  doubleToInt16(in, 2, numFrames, again.data(), &sameSeed);
+  ASSERT_EQ(out, again);
+
+  // Mono takes the scalar path for any remainder with the same noise order.
+  TPDFDither noise{7};
+  TPDFDither reference{7};
+  std::vector<int32_t> mono(7);
+  doubleToInt32(in, 1, mono.size(), mono.data(), &noise);
+  for (int32_t sample : mono) {
+    const double x = std::clamp(
+        left[0] * INT32_MAX + reference.next(), -2147483648.0, 2147483647.0);
+    ASSERT_EQ(sample, static_cast<int32_t>(std::nearbyint(x)));
+  }
+}
@@ -7,6 +7,7 @@
 
 #include <gtest/gtest.h>
 
+#include "matrix_view.hpp"
 #include "stats.h"
 
 /** @brief Tests median on a vector of odd size. */
@@ -36,3 +37,21 @@ TEST(StatsMedian, SizeTwo) {
 
   ASSERT_EQ(median(input), 12);
 }
+
+/** @brief Tests median over a strided view using a scratch buffer. */
+TEST(StatsMedian, StridedView) {
+  std::vector<int32_t> input{9, 0, 3, 0, 7, 0, 5, 0, 1, 0};
+  StridedSpan<const int32_t> view(input.data(), 5, 2);
+  std::vector<int32_t> scratch;
+
+  ASSERT_EQ(median(view, scratch), 5);
+}
+
+/** @brief Tests median over an even sized view using a scratch buffer. */
+TEST(StatsMedian, StridedViewEven) {
+  std::vector<int32_t> input{10, 4, 8, 6, 2, 12};
+  StridedSpan<const int32_t> view(input.data(), input.size());
+  std::vector<int32_t> scratch;
+
+  ASSERT_EQ(median(view, scratch), 7);
+}
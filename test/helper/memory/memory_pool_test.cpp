@@ -0,0 +1,93 @@
+/**
+ ******************************************************************************
+ * @file    memory_pool_test.cpp
+ * @brief   Unit tests for the size-class memory pool.
+ ******************************************************************************
+ */
+
+#include "memoryPool.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+
+#include "alignedAllocator.hpp"
+#include "constants.h"
+#include "matrix.hpp"
+
+/** @brief Verify that requests are rounded up to their size class. */
+TEST(MemoryPool, SizeClass) {
+  ASSERT_EQ(MemoryPool::getSizeClass(1), 64U);
+  ASSERT_EQ(MemoryPool::getSizeClass(64), 64U);
+  ASSERT_EQ(MemoryPool::getSizeClass(65), 128U);
+  ASSERT_EQ(MemoryPool::getSizeClass(256), 256U);
+  ASSERT_EQ(MemoryPool::getSizeClass(300), 320U);
+  ASSERT_EQ(MemoryPool::getSizeClass(513), 640U);
+  ASSERT_EQ(MemoryPool::getSizeClass(1000), 1024U);
+
+  // Large requests waste at most a quarter of the power of two below them.
+  const size_t bytes = 517 * 2049 * 16;
+  const size_t sizeClass = MemoryPool::getSizeClass(bytes);
+  ASSERT_GE(sizeClass, bytes);
+  ASSERT_LE(sizeClass, bytes + bytes / 4);
+}
+
+/** @brief Verify that every block is aligned for wide SIMD loads. */
+TEST(MemoryPool, Alignment) {
+  MemoryPool pool;
+
+  for (size_t bytes : {1, 24, 100, 4096, 100000}) {
+    void* ptr = pool.allocate(bytes);
+    ASSERT_EQ(reinterpret_cast<uintptr_t>(ptr) % MEMORY_ALIGNMENT, 0U);
+    pool.deallocate(ptr, bytes);
+  }
+}
+
+/** @brief Verify that a freed block is handed to the next request of the same
+ * size class and that the counters track it. */
+TEST(MemoryPool, Reuse) {
+  MemoryPool pool;
+
+  void* first = pool.allocate(10000);
+  pool.deallocate(first, 10000);
+  void* second = pool.allocate(9990);
+
+  ASSERT_EQ(first, second);
+
+  MemoryStats stats = pool.getStats();
+  ASSERT_EQ(stats.numAllocations, 2U);
+  ASSERT_EQ(stats.numReused, 1U);
+  ASSERT_EQ(stats.numSystemAllocations, 1U);
+  ASSERT_EQ(stats.bytesInUse, MemoryPool::getSizeClass(10000));
+
+  pool.deallocate(second, 9990);
+  stats = pool.getStats();
+  ASSERT_EQ(stats.bytesInUse, 0U);
+  ASSERT_EQ(stats.peakBytesInUse, MemoryPool::getSizeClass(10000));
+  ASSERT_EQ(stats.bytesCached, MemoryPool::getSizeClass(10000));
+}
+
+/** @brief Verify that blocks beyond the cache limit go back to the system. */
+TEST(MemoryPool, CacheLimit) {
+  MemoryPool pool(0);
+
+  void* ptr = pool.allocate(4096);
+  pool.deallocate(ptr, 4096);
+
+  ASSERT_EQ(pool.getStats().bytesCached, 0U);
+}
+
+/** @brief Verify that Matrix storage comes from the shared pool. */
+TEST(MemoryPool, MatrixStorage) {
+  MemoryPool& pool = getMemoryPool();
+  const size_t bytesBefore = pool.getStats().bytesInUse;
+  {
+    Matrix<double> m{4, 4};
+    ASSERT_EQ(m.getAllocator().getResource(), getDefaultMemoryResource());
+    ASSERT_EQ(reinterpret_cast<uintptr_t>(&m(0)) % MEMORY_ALIGNMENT, 0U);
+    ASSERT_EQ(pool.getStats().bytesInUse,
+              bytesBefore + MemoryPool::getSizeClass(128));
+  }
+
+  ASSERT_EQ(pool.getStats().bytesInUse, bytesBefore);
+}
@@ -0,0 +1,93 @@
+/**
+ ******************************************************************************
+ * @file    scratch_arena_test.cpp
+ * @brief   Unit tests for the per-thread scratch arena.
+ ******************************************************************************
+ */
+
+#include "scratchArena.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <thread>
+
+#include "constants.h"
+
+/** @brief Verify that every allocation is aligned for wide SIMD loads. */
+TEST(ScratchArena, Alignment) {
+  ScratchArena arena(4096);
+
+  for (size_t bytes : {1, 24, 100, 64, 3000, 10000}) {
+    void* ptr = arena.allocate(bytes);
+    ASSERT_EQ(reinterpret_cast<uintptr_t>(ptr) % MEMORY_ALIGNMENT, 0U);
+  }
+}
+
+/** @brief Verify that full blocks are followed by new ones. */
+TEST(ScratchArena, Growth) {
+  ScratchArena arena(1024);
+  ASSERT_EQ(arena.getCapacity(), 0U);
+
+  double* first = arena.allocate<double>(64);
+  double* second = arena.allocate<double>(64);
+  ASSERT_EQ(second, first + 64);
+  ASSERT_EQ(arena.getCapacity(), 1024U);
+
+  arena.allocate<double>(1);
+  ASSERT_EQ(arena.getCapacity(), 2048U);
+  ASSERT_EQ(arena.getBytesInUse(), 1024U + MEMORY_ALIGNMENT);
+}
+
+/** @brief Verify that released memory is handed out again. */
+TEST(ScratchArena, Release) {
+  ScratchArena arena(1024);
+  void* kept = arena.allocate(100);
+
+  ScratchArena::Marker marker = arena.mark();
+  void* first = arena.allocate(512);
+  arena.allocate(1000);
+  const size_t capacity = arena.getCapacity();
+  arena.release(marker);
+
+  ASSERT_EQ(arena.allocate(512), first);
+  arena.allocate(1000);
+  ASSERT_EQ(arena.getCapacity(), capacity);
+  ASSERT_NE(kept, first);
+
+  // A scope rolls back what it allocated, even into a new block.
+  const size_t bytesInUse = arena.getBytesInUse();
+  {
+    ScratchScope scope(arena);
+    scope.allocate<double>(100);
+    ASSERT_GT(arena.getBytesInUse(), bytesInUse);
+  }
+  ASSERT_EQ(arena.getBytesInUse(), bytesInUse);
+}
+
+/** @brief Verify that requests larger than a block get a block of their own. */
+TEST(ScratchArena, LargeRequest) {
+  ScratchArena arena(1024);
+  arena.allocate(10);
+
+  double* big = arena.allocate<double>(1000);
+  big[999] = 1.0;
+  ASSERT_EQ(arena.getCapacity(), 1024U + 8000U);
+
+  // The large block is reused once released.
+  arena.release({0, 0});
+  ASSERT_EQ(arena.getBytesInUse(), 0U);
+  arena.allocate<double>(1000);
+  ASSERT_EQ(arena.getCapacity(), 1024U + 8000U);
+}
+
+/** @brief Verify that each thread has its own arena. */
+TEST(ScratchArena, PerThread) {
+  ScratchArena* mainArena = &getScratchArena();
+  ScratchArena* otherArena = nullptr;
+  std::thread thread([&]() { otherArena = &getScratchArena(); });
+  thread.join();
+
+  ASSERT_EQ(&getScratchArena(), mainArena);
+  ASSERT_NE(otherArena, mainArena);
+}
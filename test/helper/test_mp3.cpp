@@ -0,0 +1,183 @@
+/**
+ ******************************************************************************
+ * @file    test_mp3.cpp
+ * @brief   Synthetic MP3 stream generator for testing.
+ ******************************************************************************
+ */
+
+#include "test_mp3.h"
+
+#include <algorithm>
+#include <fstream>
+
+const int TEST_MP3_SAMPLE_RATE_HZ = 48000;
+const size_t TEST_MP3_FRAME_SAMPLES = 1152;
+
+/** @brief Bytes per frame at 128 kbps and 48 kHz, without padding. */
+static const size_t FRAME_BYTES = 384;
+
+/** @brief Largest main_data_begin, in bytes. */
+static const size_t MAX_RESERVOIR_BYTES = 511;
+
+/** @brief Largest number of count1 quadruples in a granule. */
+static const size_t MAX_QUADS = 140;
+
+/** @brief Writes bits most significant first. */
+class BitWriter {
+ public:
+  void put(uint32_t value, int numBits) {
+    for (int i = numBits - 1; i >= 0; i--) {
+      if (numBitsWritten % 8 == 0) {
+        bytes.push_back(0);
+      }
+      if ((value >> i) & 1) {
+        bytes.back() |= static_cast<uint8_t>(0x80 >> (numBitsWritten % 8));
+      }
+      numBitsWritten++;
+    }
+  }
+
+  size_t getNumBits() const { return numBitsWritten; }
+
+  std::vector<uint8_t> bytes{};
+
+ private:
+  size_t numBitsWritten{0};
+};
+
+/** @brief Small deterministic generator so streams do not depend on rand. */
+class Lcg {
+ public:
+  explicit Lcg(uint32_t seed) : state(seed * 2654435761u + 1) {}
+
+  uint32_t next(uint32_t bound) {
+    state = state * 1664525u + 1013904223u;
+    return (state >> 8) % bound;
+  }
+
+ private:
+  uint32_t state;
+};
+
+/** @brief Side information of one granule of one channel. */
+struct GranuleInfo {
+  uint32_t part23Length{0};
+  uint32_t globalGain{0};
+};
+
+/**
+ * @brief Code random values in {-1, 0, 1} with count1 table B, which is a
+ * fixed 4 bit code followed by a sign bit per non zero value.
+ */
+static void writeCount1(BitWriter& bits, Lcg& rng, size_t numQuads) {
+  for (size_t q = 0; q < numQuads; q++) {
+    uint32_t pattern = rng.next(16);
+    bits.put(15 - pattern, 4);
+    for (int i = 3; i >= 0; i--) {
+      if ((pattern >> i) & 1) {
+        bits.put(rng.next(2), 1);
+      }
+    }
+  }
+}
+
+std::vector<uint8_t> createTestMP3(size_t numFrames, bool stereo,
+                                   uint32_t seed) {
+  const size_t numChannels = stereo ? 2 : 1;
+  const size_t sideInfoBytes = stereo ? 32 : 17;
+  const size_t slotBytes = FRAME_BYTES - 4 - sideInfoBytes;
+
+  Lcg rng{seed};
+  std::vector<uint8_t> mainData(numFrames * slotBytes, 0);
+  std::vector<uint8_t> out{};
+  out.reserve(numFrames * FRAME_BYTES);
+
+  // End of the main data of the previous frame in the slot stream.
+  size_t dataEnd = 0;
+
+  for (size_t k = 0; k < numFrames; k++) {
+    const size_t slotStart = k * slotBytes;
+    const size_t dataStart =
+        std::max(dataEnd, slotStart > MAX_RESERVOIR_BYTES
+                              ? slotStart - MAX_RESERVOIR_BYTES
+                              : size_t{0});
+    const size_t maxDataBits = (slotStart + slotBytes - dataStart) * 8;
+
+    // Alternate between sparse and dense frames so the reservoir fills up and
+    // is drawn from again.
+    const size_t maxQuads = (k % 3 == 2) ? MAX_QUADS : MAX_QUADS / 3;
+
+    BitWriter data{};
+    GranuleInfo info[2][2]{};
+    for (size_t gr = 0; gr < 2; gr++) {
+      for (size_t ch = 0; ch < numChannels; ch++) {
+        // Worst case of 8 bits per quadruple for the remaining granules.
+        const size_t granulesLeft = (2 - gr) * numChannels - ch;
+        const size_t budget =
+            (maxDataBits - data.getNumBits()) / granulesLeft / 8;
+        const uint32_t wanted = 1 + rng.next(static_cast<uint32_t>(maxQuads));
+        const size_t numQuads = std::min<size_t>(budget, wanted);
+
+        const size_t before = data.getNumBits();
+        writeCount1(data, rng, numQuads);
+        info[gr][ch].part23Length =
+            static_cast<uint32_t>(data.getNumBits() - before);
+        info[gr][ch].globalGain = 158 + rng.next(24);
+      }
+    }
+    std::copy(data.bytes.begin(), data.bytes.end(),
+              mainData.begin() + dataStart);
+    dataEnd = dataStart + data.bytes.size();
+
+    // Header: MPEG-1 Layer III, no CRC, 128 kbps, 48 kHz.
+    BitWriter frame{};
+    frame.put(0xFFF, 12);
+    frame.put(1, 1);
+    frame.put(1, 2);
+    frame.put(1, 1);
+    frame.put(9, 4);
+    frame.put(1, 2);
+    frame.put(0, 2);
+    frame.put(stereo ? 0 : 3, 2);
+    frame.put(0, 2);
+    frame.put(0, 4);
+
+    // Side information. Only the count1 region is used, with table B.
+    frame.put(static_cast<uint32_t>(slotStart - dataStart), 9);
+    frame.put(0, stereo ? 3 : 5);
+    frame.put(0, 4 * static_cast<int>(numChannels));
+    for (size_t gr = 0; gr < 2; gr++) {
+      for (size_t ch = 0; ch < numChannels; ch++) {
+        frame.put(info[gr][ch].part23Length, 12);
+        frame.put(0, 9);
+        frame.put(info[gr][ch].globalGain, 8);
+        frame.put(0, 4);
+        frame.put(0, 1);
+        frame.put(0, 15);
+        frame.put(0, 4);
+        frame.put(0, 3);
+        frame.put(0, 2);
+        frame.put(1, 1);
+      }
+    }
+
+    out.insert(out.end(), frame.bytes.begin(), frame.bytes.end());
+    out.resize(out.size() + slotBytes);
+  }
+
+  // Main data is only complete once every frame has been placed.
+  for (size_t k = 0; k < numFrames; k++) {
+    std::copy(mainData.begin() + k * slotBytes,
+              mainData.begin() + (k + 1) * slotBytes,
+              out.begin() + k * FRAME_BYTES + 4 + sideInfoBytes);
+  }
+
+  return out;
+}
+
+bool writeTestFile(const std::string& path, const std::vector<uint8_t>& bytes) {
+  std::ofstream file(path, std::ios::binary);
+  file.write(reinterpret_cast<const char*>(bytes.data()),
+             static_cast<std::streamsize>(bytes.size()));
+  return static_cast<bool>(file);
+}
@@ -0,0 +1,44 @@
+/**
+ ******************************************************************************
+ * @file    test_mp3.h
+ * @brief   Synthetic MP3 stream generator for testing.
+ ******************************************************************************
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/** @brief Sample rate of the generated streams. */
+extern const int TEST_MP3_SAMPLE_RATE_HZ;
+
+/** @brief Samples per channel in each generated frame. */
+extern const size_t TEST_MP3_FRAME_SAMPLES;
+
+/**
+ * @brief Generate a valid MPEG-1 Layer III stream of noise-like content.
+ *
+ * Frames are 128 kbps at 48 kHz. Spectral values are coded in the count1
+ * region only, which keeps the generator small while producing frames of
+ * varying size. Frames borrow from the bit reservoir, so main data regularly
+ * starts in earlier frames.
+ *
+ * @param numFrames The number of frames to generate.
+ * @param stereo True for a stereo stream, false for mono.
+ * @param seed Seed of the content.
+ * @return std::vector<uint8_t> MP3 bytes.
+ */
+std::vector<uint8_t> createTestMP3(size_t numFrames, bool stereo,
+                                   uint32_t seed = 1);
+
+/**
+ * @brief Write bytes to a file.
+ *
+ * @param path File path.
+ * @param bytes File contents.
+ * @return true on success.
+ */
+bool writeTestFile(const std::string& path, const std::vector<uint8_t>& bytes);
@@ -0,0 +1,109 @@
+/**
+ ******************************************************************************
+ * @file    thread_pool_test.cpp
+ * @brief   Unit tests for the work-stealing thread pool.
+ ******************************************************************************
+ */
+
+#include "threadPool.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+/** @brief Every index is visited exactly once for any pool size and grain. */
+TEST(ThreadPool, ParallelForCoversRange) {
+  const size_t n = 1037;
+
+  for (size_t numThreads : {1, 2, 4, 7}) {
+    ThreadPool pool(numThreads);
+    ASSERT_EQ(pool.getNumThreads(), numThreads);
+
+    for (size_t grain : {0, 1, 10, 5000}) {
+      std::vector<std::atomic<int>> visits(n);
+      pool.parallelFor(
+          0, n,
+          [&](size_t start, size_t end) {
+            ASSERT_LT(start, end);
+            for (size_t i = start; i < end; i++) {
+              visits[i]++;
+            }
+          },
+          grain);
+
+      for (size_t i = 0; i < n; i++) {
+        ASSERT_EQ(visits[i], 1) << "threads " << numThreads << " grain "
+                                << grain << " index " << i;
+      }
+    }
+  }
+}
+
+/** @brief An empty range never calls the body. */
+TEST(ThreadPool, EmptyRange) {
+  ThreadPool pool(3);
+  bool called = false;
+  pool.parallelFor(5, 5, [&](size_t, size_t) { called = true; });
+  ASSERT_FALSE(called);
+}
+
+/** @brief parallelFor can be nested without deadlocking. */
+TEST(ThreadPool, NestedParallelFor) {
+  ThreadPool pool(4);
+  const size_t outer = 16;
+  const size_t inner = 100;
+  std::atomic<size_t> total{0};
+
+  pool.parallelFor(
+      0, outer,
+      [&](size_t start, size_t end) {
+        for (size_t i = start; i < end; i++) {
+          pool.parallelFor(0, inner, [&](size_t s, size_t e) {
+            total += e - s;
+          });
+        }
+      },
+      1);
+
+  ASSERT_EQ(total, outer * inner);
+}
+
+/** @brief Submitted tasks all run, and the pool drains them on destruction. */
+TEST(ThreadPool, SubmitRunsEveryTask) {
+  std::atomic<size_t> count{0};
+  {
+    ThreadPool pool(3);
+    for (size_t i = 0; i < 200; i++) {
+      pool.submit([&]() { count++; });
+    }
+  }
+  ASSERT_EQ(count, 200U);
+}
+
+/**
+ * @brief A waiter with nothing to take wakes when a running task finishes or
+ * queues more work, including chains of tasks submitted by tasks.
+ */
+TEST(ThreadPool, HelpUntilWakesOnProgress) {
+  ThreadPool pool(3);
+  std::atomic<size_t> count{0};
+
+  pool.submit([&]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    count++;
+  });
+  pool.helpUntil([&]() { return count == 1; });
+
+  std::function<void()> chain = [&]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    if (++count < 50) {
+      pool.submit(chain);
+    }
+  };
+  pool.submit(chain);
+  pool.helpUntil([&]() { return count == 50; });
+  ASSERT_EQ(count, 50U);
+}